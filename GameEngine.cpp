@@ -2,6 +2,7 @@
 //
 
 #include "GameEngine.h"
+#include "glState.h"
 #include "render.h"
 #include "ui.h"
 #include "input.h"
@@ -23,6 +24,7 @@
 #include "Nodes\tube.h"
 #include "Nodes\bin.h"
 #include "surfaceParameterization.h"
+#include "worldStreamer.h"
 
 
 
@@ -68,12 +70,18 @@ bool trackLight = false; // Make camera same as light view
 std::shared_ptr<Node> selectedNode = nullptr; // Initialize selected Node pointer
 
 Scene scene;
+// loads/unloads level cells around the camera
+WorldStreamer worldStreamer;
 //Create importer
 ModelImporter importer;
 
 void setupScene() {
     scene.setup();
 
+    if (std::filesystem::exists(Paths::Scenes::worldManifest)) {
+        worldStreamer.loadManifest(Paths::Scenes::worldManifest);
+    }
+
     
     auto playerModel = importer.importGLB(getProjectRoot() + "/blender/Base Character.glb");
     std::shared_ptr<Player> player = std::make_shared<Player>(playerModel);
@@ -88,7 +96,7 @@ void setupScene() {
 
     // Set up projection matrix for text rendering
     glm::mat4 textProjection = glm::ortho(0.0f, (float)screenWidth, 0.0f, (float)screenHeight);
-    glUseProgram(textShaderProgram);
+    GLStateCache::getInstance().useProgram(textShaderProgram);
     glUniformMatrix4fv(glGetUniformLocation(textShaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(textProjection));
 
 
@@ -100,6 +108,36 @@ void setupScene() {
 // function definitions before main
 
 
+#ifdef ENGINE_HEADLESS
+// simulation server: no window, no GL context, no rendering. the scene is built the same
+// way (uploads are compiled out) and stepped at a fixed rate until the process is killed
+int runHeadless() {
+    std::cout << "Running headless simulation" << std::endl;
+
+    PhysXManager::getInstance().initialize();
+
+    auto groundNode = makePooled<BoxNode, pools::Primitives>(10.0f, 0.5f, 10.0f);
+    groundNode->name = "ground";
+    groundNode->setWorldPosition(glm::vec3(0.0f, -1.5f, 0.0f));
+    scene.addPhysicsBody(makePooled<PhysXBody, pools::Bodies>(groundNode, true));
+
+    scene.buildStaticWorld();
+    scene.capturePhysicsSnapshot();
+    scene.play = true;
+
+    const auto step = std::chrono::microseconds(16667);
+    auto nextStep = std::chrono::steady_clock::now();
+    while (true) {
+        scene.update(1.0f / 60.0f);
+        nextStep += step;
+        std::this_thread::sleep_until(nextStep);
+    }
+}
+
+int main() {
+    return runHeadless();
+}
+#else
 int main() {
 
     std::cout << "Running GameEngine main()" << std::endl;
@@ -114,6 +152,10 @@ int main() {
         return -1;
     }
 
+#ifndef NDEBUG
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);  // so KHR_debug reports everything
+#endif
+
     //
     GLFWwindow* window = glfwCreateWindow(screenWidth, screenHeight, "OpenGL Game Engine", NULL, NULL);
     if (!window) {
@@ -139,6 +181,7 @@ int main() {
     if (glewInit() != GLEW_OK) {
         return -1;
     }
+    installGLDebugOutput();
 
     const char* glVersion = (const char*)glGetString(GL_VERSION);
     const char* glVendor = (const char*)glGetString(GL_VENDOR);
@@ -150,6 +193,7 @@ int main() {
 
     setupScene();
     initializeConsole(); // Initialize console for text input
+    RedrawTracker::getInstance().installCallbacks(window); // before imgui so it chains to them
     initImGui(window);
 
     // Initialize FreeType for font (after glfw and glew)
@@ -165,16 +209,22 @@ int main() {
 
     // Create physics objects
 
-    auto groundNode = std::make_shared<BoxNode>(10.0f, 0.5f, 10.0f);
+    auto groundNode = makePooled<BoxNode, pools::Primitives>(10.0f, 0.5f, 10.0f);
     groundNode->name = "ground";
     std::cout << "node pos before = " << vec3_to_string(groundNode->getWorldPosition()) << std::endl;
     groundNode->setWorldPosition(glm::vec3(0.0f, -1.5f, 0.0f));
     std::cout << "node pos after = " << vec3_to_string(groundNode->getWorldPosition()) << std::endl;
-    auto groundBody = std::make_shared<PhysXBody>(groundNode, true);
+    auto groundBody = makePooled<PhysXBody, pools::Bodies>(groundNode, true);
     std::cout << "body pos = " << vec3_to_string(groundBody->getPosition()) << std::endl;
 
     scene.addPhysicsBody(groundBody);
 
+    // static colliders are merged once everything static has been added
+    scene.buildStaticWorld();
+
+    // starting state for the Reset button
+    scene.capturePhysicsSnapshot();
+
 
     //selectedRB = sphereBody; //maintains live reference
 
@@ -220,7 +270,7 @@ int main() {
     TubeNode::TubeParameters params;
     params.radialSegments = 16;  // Higher resolution around circumference
     params.lengthSegments = 64;  // Higher resolution along length
-    auto tubeFromCurve = std::make_shared<TubeNode>(curve, 0.1f, params);
+    auto tubeFromCurve = makePooled<TubeNode, pools::Primitives>(curve, 0.1f, params);
 
     // Using points
     std::vector<glm::vec3> points = {
@@ -228,7 +278,7 @@ int main() {
         glm::vec3(1.0f, 1.0f, 0.0f),
         glm::vec3(2.0f, 0.0f, 1.0f)
     };
-    auto tubeFromPoints = std::make_shared<TubeNode>(points, 0.1f);
+    auto tubeFromPoints = makePooled<TubeNode, pools::Primitives>(points, 0.1f);
 
     //scene.addNode(tubeFromCurve);
 
@@ -276,12 +326,12 @@ int main() {
     surfaceParams.generateUVs = false;      // For texturing
 
     // Create the node
-    auto wavyGroundNode = std::make_shared<ParametricSurfaceNode>(wavyGroundSurface, surfaceParams);
+    auto wavyGroundNode = makePooled<ParametricSurfaceNode, pools::Primitives>(wavyGroundSurface, surfaceParams);
     wavyGroundNode->mesh->flipNormals();
     wavyGroundNode->setWorldPosition(glm::vec3(0.0f, -5.0f, 0.0f));
 
     // Create a material with a blue-green color
-    auto groundMaterial = std::make_shared<Material>();
+    auto groundMaterial = makePooled<Material, pools::Materials>();
     groundMaterial->baseColor = glm::vec3(0.2f, 0.5f, 0.7f);  // Blue-green color
     groundMaterial->roughness = 0.7f;  // More matte appearance
     groundMaterial->metallic = 0.01f;   // Non-metallic
@@ -294,11 +344,11 @@ int main() {
 
 
     //testing binBody
-    auto binNode = std::make_shared<BinNode>(4.0f, 3.0f, 4.0f);
+    auto binNode = makePooled<BinNode, pools::Primitives>(4.0f, 3.0f, 4.0f);
     binNode->setWorldPosition(glm::vec3(0.0f, 5.0f, 0.0f));
 
     // Create glass material
-    auto glassMaterial = std::make_shared<Material>();
+    auto glassMaterial = makePooled<Material, pools::Materials>();
     glassMaterial->baseColor = glm::vec3(0.2f, 0.3f, 0.4f);  // Light blue tint to make it visible
     glassMaterial->transmission = 0.9f;  // transparent
     glassMaterial->ior = 1.52f;         // Typical glass IOR
@@ -311,7 +361,7 @@ int main() {
     // Apply to all walls
     binNode->setMaterial(glassMaterial);
 
-    auto binBody = std::make_shared<BinBody>(binNode, true);  // true for static
+    auto binBody = makePooled<BinBody, pools::Bodies>(binNode, true);  // true for static
     //scene.addPhysicsBody(binBody, "my_bin");
 
     // Define bounding box for sphere generation
@@ -338,6 +388,8 @@ int main() {
         startTime_sys = currentTime; // Update start time for next frame
 
         processInput(window);  // Process keyboard and mouse input
+
+        worldStreamer.update(scene, scene.activeCamera->cameraPos);
         
         scene.update(deltaTime_sys); // update animations, physics, etc.
 
@@ -351,6 +403,20 @@ int main() {
              timeSinceLastGeneration = 0.0f;
          }
 
+         // idle editor: nothing moved and no input, keep the last frame on screen and sleep
+         RedrawTracker& redraw = RedrawTracker::getInstance();
+         if (scene.play || worldStreamer.getPendingCellCount() > 0 || MeshUploadQueue::getInstance().size() > 0) {
+             redraw.markDirty();
+         }
+         redraw.watchCamera(scene.activeCamera->getProjectionMatrix() * scene.activeCamera->getViewMatrix());
+         if (!redraw.shouldRender()) {
+             redraw.waitForChanges();
+             continue;
+         }
+
+         // one batch of GPU uploads for everything built or changed this frame
+         MeshUploadQueue::getInstance().flush();
+
          //render visible nodes with shadows
          scene.render();
 
@@ -384,10 +450,13 @@ int main() {
         }
 
         glfwSwapBuffers(window);
+        redraw.frameRendered();
+        FrameArena::getInstance().reset(); // this frame's draw lists and uniform names
         glfwPollEvents();
     }
     
     // Clean up PhysX
+    scene.physicsSnapshot.release();
     PhysXManager::getInstance().cleanup();
 
     //clean up imgui
@@ -397,3 +466,4 @@ int main() {
     glfwTerminate();
     return 0;
 }
+#endif
@@ -11,27 +11,27 @@ public:
 
     BinNode(float width, float height, float depth, float wallThickness = 0.1f) {
         // Create the bottom with full width and depth
-        bottom = std::make_shared<BoxNode>(width - 2.0f*wallThickness, wallThickness, depth);
+        bottom = makePooled<BoxNode, pools::Primitives>(width - 2.0f*wallThickness, wallThickness, depth);
         bottom->localTranslation = glm::vec3(0.0f, -height / 2.0f - wallThickness/ 2.0, 0.0f);
         addChild(bottom);
 
         // Create front wall 
-        frontWall = std::make_shared<BoxNode>(width - 2 * wallThickness, height, wallThickness);
+        frontWall = makePooled<BoxNode, pools::Primitives>(width - 2 * wallThickness, height, wallThickness);
         frontWall->localTranslation = glm::vec3(0.0f, 0.0f, depth / 2.0f - wallThickness / 2.0f);
         addChild(frontWall);
 
         // Create back wall 
-        backWall = std::make_shared<BoxNode>(width - 2 * wallThickness, height, wallThickness);
+        backWall = makePooled<BoxNode, pools::Primitives>(width - 2 * wallThickness, height, wallThickness);
         backWall->localTranslation = glm::vec3(0.0f, 0.0f, -depth / 2.0f + wallThickness / 2.0f);
         addChild(backWall);
 
         // Create left wall - longer than front and back
-        leftWall = std::make_shared<BoxNode>(wallThickness, height, depth - 2 * wallThickness);
+        leftWall = makePooled<BoxNode, pools::Primitives>(wallThickness, height, depth - 2 * wallThickness);
         leftWall->localTranslation = glm::vec3(-width / 2.0f + 1.5f*wallThickness, 0.0f, 0.0f);
         addChild(leftWall);
 
         // Create right wall - longer than front and back
-        rightWall = std::make_shared<BoxNode>(wallThickness, height, depth - 2 * wallThickness);
+        rightWall = makePooled<BoxNode, pools::Primitives>(wallThickness, height, depth - 2 * wallThickness);
         rightWall->localTranslation = glm::vec3(width / 2.0f - 1.5f*wallThickness, 0.0f, 0.0f);
         addChild(rightWall);
 
@@ -41,11 +41,11 @@ public:
 
     // Set material for all walls
     void setMaterial(std::shared_ptr<Material> material) {
-        bottom->mesh->materials = { material };
-        frontWall->mesh->materials = { material };
-        backWall->mesh->materials = { material };
-        leftWall->mesh->materials = { material };
-        rightWall->mesh->materials = { material };
+        bottom->material = material;
+        frontWall->material = material;
+        backWall->material = material;
+        leftWall->material = material;
+        rightWall->material = material;
     }
 };
 
@@ -61,8 +61,8 @@ public:
     static std::shared_ptr<BinBody> createBin(float width, float height, float depth,
         float wallThickness = 0.1f,
         bool isStatic = true) {
-        auto bin = std::make_shared<BinNode>(width, height, depth, wallThickness);
-        return std::make_shared<BinBody>(bin, isStatic);
+        auto bin = makePooled<BinNode, pools::Primitives>(width, height, depth, wallThickness);
+        return makePooled<BinBody, pools::Bodies>(bin, isStatic);
     }
 
 private:
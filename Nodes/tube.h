@@ -69,7 +69,7 @@ private:
 
     // Generate the tube mesh using parallel transport frames
     void generateTubeMesh(const std::vector<glm::vec3>& points) {
-        mesh = std::make_shared<Mesh>();
+        mesh = makePooled<Mesh, pools::Meshes>();
 
         if (points.size() < 2) return;
 
@@ -88,7 +88,7 @@ private:
                 mesh->positions.push_back(pos);
                 mesh->normals.push_back(glm::normalize(pos - points[i]));
                 mesh->colors.push_back(glm::vec4(1.0f));
-                mesh->uvSets["map1"].push_back(glm::vec2(
+                mesh->uvSets[Mesh::DEFAULT_UV_SET].push_back(glm::vec2(
                     float(i) / (points.size() - 1),
                     0.0f
                 ));
@@ -98,7 +98,7 @@ private:
                 mesh->positions.push_back(pos);
                 mesh->normals.push_back(glm::normalize(pos - points[i + 1]));
                 mesh->colors.push_back(glm::vec4(1.0f));
-                mesh->uvSets["map1"].push_back(glm::vec2(
+                mesh->uvSets[Mesh::DEFAULT_UV_SET].push_back(glm::vec2(
                     float(i + 1) / (points.size() - 1),
                     1.0f
                 ));
@@ -125,7 +125,7 @@ private:
             generateEndCap(points.back(), frames.back().tangent, frames.back(), false);
         }
 
-        mesh->setupBuffers();
+        mesh->markForUpload();
     }
 
     // Generate end caps using the frame orientation
@@ -137,7 +137,7 @@ private:
         mesh->positions.push_back(center);
         mesh->normals.push_back(normal);
         mesh->colors.push_back(glm::vec4(1.0f));
-        mesh->uvSets["map1"].push_back(glm::vec2(0.5f, 0.5f));
+        mesh->uvSets[Mesh::DEFAULT_UV_SET].push_back(glm::vec2(0.5f, 0.5f));
 
         // Add circle vertices
         size_t startIndex = mesh->positions.size();
@@ -150,7 +150,7 @@ private:
                 0.5f + 0.5f * glm::normalize(pos - center).x,
                 0.5f + 0.5f * glm::normalize(pos - center).y
             );
-            mesh->uvSets["map1"].push_back(uv);
+            mesh->uvSets[Mesh::DEFAULT_UV_SET].push_back(uv);
         }
 
         // Generate triangles
@@ -0,0 +1,257 @@
+// PhysXAllocator.h
+#pragma once
+
+#include <PxPhysicsAPI.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace physx;
+
+// PxAllocatorCallback backed by size-class pools. PhysX asks for lots of small
+// same sized blocks (shapes, contact managers, island nodes...) so after warm up
+// most requests are a free list pop instead of a malloc.
+// also keeps byte counters per PhysX type name so we can see where physics memory goes
+class PhysXPoolAllocator : public PxAllocatorCallback {
+public:
+    struct CategoryStats {
+        std::string name;
+        size_t currentBytes = 0;
+        size_t peakBytes = 0;
+        size_t liveAllocations = 0;
+        size_t totalAllocations = 0;
+    };
+
+    struct PoolStats {
+        size_t slotSize = 0;
+        size_t slotsInUse = 0;
+        size_t slotsTotal = 0;
+    };
+
+    PhysXPoolAllocator() {
+        for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i) {
+            pools[i].slotSize = MIN_SLOT_SIZE << i;
+        }
+        categories[0].name = "other";
+        categoryCount = 1;
+    }
+
+    ~PhysXPoolAllocator() override = default;
+
+    PhysXPoolAllocator(const PhysXPoolAllocator&) = delete;
+    PhysXPoolAllocator& operator=(const PhysXPoolAllocator&) = delete;
+
+    void* allocate(size_t size, const char* typeName, const char* filename, int line) override {
+        PX_UNUSED(filename);
+        PX_UNUSED(line);
+
+        size_t total = size + sizeof(AllocationHeader);
+        int sizeClass = sizeClassFor(total);
+
+        void* block = sizeClass >= 0
+            ? pools[sizeClass].allocate()
+            : ::operator new(total, std::align_val_t(ALIGNMENT), std::nothrow);
+        if (!block) return nullptr;
+
+        uint32_t category = categoryFor(typeName);
+
+        AllocationHeader* header = static_cast<AllocationHeader*>(block);
+        header->sizeClass = sizeClass >= 0 ? static_cast<uint32_t>(sizeClass) : LARGE_ALLOCATION;
+        header->category = category;
+        header->size = size;
+
+        Category& cat = categories[category];
+        size_t current = cat.currentBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        size_t peak = cat.peakBytes.load(std::memory_order_relaxed);
+        while (current > peak && !cat.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+        cat.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+        cat.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        totalBytes.fetch_add(size, std::memory_order_relaxed);
+
+        return header + 1;
+    }
+
+    void deallocate(void* ptr) override {
+        if (!ptr) return;
+
+        AllocationHeader* header = static_cast<AllocationHeader*>(ptr) - 1;
+
+        Category& cat = categories[header->category];
+        cat.currentBytes.fetch_sub(header->size, std::memory_order_relaxed);
+        cat.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+        totalBytes.fetch_sub(header->size, std::memory_order_relaxed);
+
+        if (header->sizeClass == LARGE_ALLOCATION) {
+            ::operator delete(header, std::align_val_t(ALIGNMENT));
+        }
+        else {
+            pools[header->sizeClass].deallocate(header);
+        }
+    }
+
+    // bytes handed to PhysX right now (not counting pool slack)
+    size_t getTotalBytes() const {
+        return totalBytes.load(std::memory_order_relaxed);
+    }
+
+    // bytes reserved by the pools, includes free slots
+    size_t getReservedPoolBytes() const {
+        size_t reserved = 0;
+        for (const auto& pool : pools) {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            reserved += pool.slotsTotal * pool.slotSize;
+        }
+        return reserved;
+    }
+
+    std::vector<CategoryStats> getCategoryStats() const {
+        std::vector<CategoryStats> stats;
+        std::shared_lock<std::shared_mutex> lock(categoryMutex);
+        for (uint32_t i = 0; i < categoryCount; ++i) {
+            const Category& cat = categories[i];
+            CategoryStats s;
+            s.name = cat.name;
+            s.currentBytes = cat.currentBytes.load(std::memory_order_relaxed);
+            s.peakBytes = cat.peakBytes.load(std::memory_order_relaxed);
+            s.liveAllocations = cat.liveAllocations.load(std::memory_order_relaxed);
+            s.totalAllocations = cat.totalAllocations.load(std::memory_order_relaxed);
+            stats.push_back(s);
+        }
+        return stats;
+    }
+
+    std::vector<PoolStats> getPoolStats() const {
+        std::vector<PoolStats> stats;
+        for (const auto& pool : pools) {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            stats.push_back({ pool.slotSize, pool.slotsInUse, pool.slotsTotal });
+        }
+        return stats;
+    }
+
+private:
+    // PhysX wants 16 byte aligned memory, the header keeps the user pointer aligned
+    static constexpr size_t ALIGNMENT = 16;
+    static constexpr size_t MIN_SLOT_SIZE = 32;
+    static constexpr size_t NUM_SIZE_CLASSES = 8;          // 32 .. 4096 bytes
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr uint32_t LARGE_ALLOCATION = 0xffffffffu;
+    static constexpr size_t MAX_CATEGORIES = 256;
+
+    struct alignas(16) AllocationHeader {
+        uint32_t sizeClass;
+        uint32_t category;
+        uint64_t size;
+    };
+    static_assert(sizeof(AllocationHeader) == ALIGNMENT, "header must keep the payload 16 byte aligned");
+
+    struct SizeClassPool {
+        size_t slotSize = 0;
+        mutable std::mutex mutex;
+        void* freeList = nullptr;
+        std::vector<void*> chunks;
+        size_t slotsInUse = 0;
+        size_t slotsTotal = 0;
+
+        ~SizeClassPool() {
+            for (void* chunk : chunks) {
+                ::operator delete(chunk, std::align_val_t(ALIGNMENT));
+            }
+        }
+
+        void* allocate() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!freeList && !grow()) return nullptr;
+            void* slot = freeList;
+            freeList = *static_cast<void**>(slot);
+            ++slotsInUse;
+            return slot;
+        }
+
+        void deallocate(void* slot) {
+            std::lock_guard<std::mutex> lock(mutex);
+            *static_cast<void**>(slot) = freeList;
+            freeList = slot;
+            --slotsInUse;
+        }
+
+        bool grow() {
+            size_t chunkBytes = std::max(CHUNK_SIZE, slotSize * 8);
+            char* chunk = static_cast<char*>(::operator new(chunkBytes, std::align_val_t(ALIGNMENT), std::nothrow));
+            if (!chunk) return false;
+            chunks.push_back(chunk);
+
+            size_t slotCount = chunkBytes / slotSize;
+            for (size_t i = 0; i < slotCount; ++i) {
+                void* slot = chunk + i * slotSize;
+                *static_cast<void**>(slot) = freeList;
+                freeList = slot;
+            }
+            slotsTotal += slotCount;
+            return true;
+        }
+    };
+
+    struct Category {
+        std::string name;
+        std::atomic<size_t> currentBytes{ 0 };
+        std::atomic<size_t> peakBytes{ 0 };
+        std::atomic<size_t> liveAllocations{ 0 };
+        std::atomic<size_t> totalAllocations{ 0 };
+    };
+
+    std::array<SizeClassPool, NUM_SIZE_CLASSES> pools;
+
+    std::array<Category, MAX_CATEGORIES> categories;
+    uint32_t categoryCount = 0;
+    // PhysX passes string literals so the pointer lookup almost always hits,
+    // the name map catches the same literal coming from different modules
+    std::unordered_map<const char*, uint32_t> categoryByPointer;
+    std::unordered_map<std::string, uint32_t> categoryByName;
+    mutable std::shared_mutex categoryMutex;
+
+    std::atomic<size_t> totalBytes{ 0 };
+
+    static int sizeClassFor(size_t bytes) {
+        size_t slot = MIN_SLOT_SIZE;
+        for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i, slot <<= 1) {
+            if (bytes <= slot) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    uint32_t categoryFor(const char* typeName) {
+        if (!typeName) return 0;
+
+        {
+            std::shared_lock<std::shared_mutex> lock(categoryMutex);
+            auto it = categoryByPointer.find(typeName);
+            if (it != categoryByPointer.end()) return it->second;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(categoryMutex);
+        auto it = categoryByPointer.find(typeName);
+        if (it != categoryByPointer.end()) return it->second;
+
+        uint32_t index = 0;
+        auto named = categoryByName.find(typeName);
+        if (named != categoryByName.end()) {
+            index = named->second;
+        }
+        else if (categoryCount < MAX_CATEGORIES) {
+            index = categoryCount++;
+            categories[index].name = typeName;
+            categoryByName[typeName] = index;
+        }
+        categoryByPointer[typeName] = index;
+        return index;
+    }
+};
@@ -43,6 +43,7 @@ public:
     PhysXBody(std::shared_ptr<Node> nodePtr, bool staticBody = false, bool useMesh=true)
         : node(nodePtr), isStatic(staticBody) {
         // node->updateWorldTransform();  
+        if (isStatic) markNodesStatic(node.get());
 
         if (useMesh) {
             createGeometryFromMesh();
@@ -52,10 +53,20 @@ public:
     }
 
     // Constructor for compound bodies
-    PhysXBody(std::shared_ptr<Node> rootNode, const std::vector<std::shared_ptr<Node>>& parts, bool staticBody = false)
+    PhysXBody(std::shared_ptr<Node> rootNode, const std::vector<std::shared_ptr<Node>>& parts, bool staticBody = false,
+        bool addToScene = true)
         : node(rootNode), compoundParts(parts), isStatic(staticBody) {
         node->updateWorldTransform();
-        createCompoundActor();
+        if (isStatic) markNodesStatic(node.get());
+        createCompoundActor(addToScene);
+    }
+
+    // static actors never move, so their meshes can go into the scene's static batches
+    static void markNodesStatic(Node* root) {
+        root->isStatic = true;
+        for (const auto& child : root->children) {
+            markNodesStatic(child.get());
+        }
     }
 
     void createSphereGeometry(float radius) {
@@ -70,7 +81,9 @@ public:
 		geometry = std::make_shared<PxCapsuleGeometry>(radius, halfHeight);
 	}
 
-    void createActor() {
+    // addToScene=false builds the actor without touching the PxScene, so it can run on a
+    // loader thread while the simulation steps. addActorToScene() finishes it on the main thread
+    void createActor(bool addToScene = true) {
 
         PxPhysics* physics = PhysXManager::getInstance().getPhysics();
         
@@ -117,11 +130,29 @@ public:
         PxShape* shape = physics->createShape(*geometry, *material);
            actor->attachShape(*shape);
 
-        PhysXManager::getInstance().getScene()->addActor(*actor);
+        if (addToScene) {
+            addActorToScene();
+        }
 
     }
 
-    void createCompoundActor() {
+    void addActorToScene() {
+        if (actor && !actor->getScene()) {
+            PhysXManager::getInstance().getScene()->addActor(*actor);
+        }
+    }
+
+    // takes the actor out of the simulation and frees it, the body is left without physics
+    void releaseActor() {
+        if (!actor) return;
+        if (PxScene* scene = actor->getScene()) {
+            scene->removeActor(*actor);
+        }
+        actor->release();
+        actor = nullptr;
+    }
+
+    void createCompoundActor(bool addToScene = true) {
         PxPhysics* physics = PhysXManager::getInstance().getPhysics();
 
         // Create transform from root node's world transform
@@ -155,7 +186,9 @@ public:
             PxRigidBodyExt::updateMassAndInertia(*actor->is<PxRigidDynamic>(), 1.0f);
         }
 
-        PhysXManager::getInstance().getScene()->addActor(*actor);
+        if (addToScene) {
+            addActorToScene();
+        }
     }
 
     void updateNode() {
@@ -175,8 +208,8 @@ public:
             node->localTranslation = position;
             node->localRotation = rotation;
 
-            // Let the scene graph update the world transform
-            node->updateWorldTransform();
+            // world matrix gets rebuilt in the scene's transform pass
+            node->markTransformDirty();
 
         }
 
@@ -420,9 +453,10 @@ private:
     }
 
     void updateBoundingSphere() {
-        if (node->mesh->positions.empty()) return;
+        if (!node->mesh || node->mesh->positions.empty()) return;
 
-        glm::vec3 center = computeBoundingSphereCenter(node->mesh.get());
+        // around the mesh's cached box, tighter than the vertex average for lopsided meshes
+        glm::vec3 center = node->mesh->getLocalBounds().getCenter();
 
         float radius = 0.0f;
         for (const auto& pos : node->mesh->positions) {
@@ -430,7 +464,8 @@ private:
             radius = glm::max(radius, dist);
         }
 
-        
+        boundingSphere.boundingSphereCenter = glm::vec3(node->worldTransform * glm::vec4(center, 1.0f));
+        boundingSphere.boundingSphereRadius = radius;
     }
 
     glm::vec3 computeBoundingSphereCenter(Mesh* mesh) {
@@ -485,6 +520,6 @@ public:
         const std::vector<std::shared_ptr<Node>>& parts,
         bool isStatic = false)
     {
-        return std::make_shared<PhysXBody>(rootNode, parts, isStatic);
+        return makePooled<PhysXBody, pools::Bodies>(rootNode, parts, isStatic);
     }
 };
\ No newline at end of file
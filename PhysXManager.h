@@ -3,6 +3,7 @@
 
 #include <PxPhysicsAPI.h>
 #include "GameEngine.h"
+#include "PhysXAllocator.h"
 
 
 using namespace physx;
@@ -10,7 +11,7 @@ using namespace physx;
 class PhysXManager {
 private:
     static PhysXManager* instance;
-    PxDefaultAllocator allocator;
+    PhysXPoolAllocator allocator;
     PxDefaultErrorCallback errorCallback;
     PxFoundation* foundation;
     PxPhysics* physics;
@@ -18,6 +19,14 @@ private:
     PxScene* scene;
     PxPvd* pvd; // Physics visual debugger
 
+    // reusable scratch memory for simulate() so PhysX doesn't heap allocate every step.
+    // PhysX wants it 16 byte aligned and a multiple of 16K
+    void* scratchBlock = nullptr;
+    PxU32 scratchBlockSize = 0;
+    static constexpr PxU32 SCRATCH_GRANULARITY = 16 * 1024;
+    static constexpr PxU32 SCRATCH_BYTES_PER_BODY = 256;
+    static constexpr PxU32 MAX_SCRATCH_SIZE = 16 * 1024 * 1024;
+
 
 public:
     // Singleton method
@@ -34,6 +43,8 @@ public:
         if (!foundation) {
             return false;
         }
+        // lets the allocator bucket its byte counters by PhysX type name
+        foundation->setReportAllocationNames(true);
 
         // Create PVD (PhysX Visual Debugger)
         pvd = PxCreatePvd(*foundation);
@@ -62,6 +73,11 @@ public:
 
     void cleanup() {
         PX_RELEASE(scene);
+        if (scratchBlock) {
+            allocator.deallocate(scratchBlock);
+            scratchBlock = nullptr;
+            scratchBlockSize = 0;
+        }
         PX_RELEASE(dispatcher);
         PX_RELEASE(physics);
         PX_RELEASE(pvd);
@@ -70,14 +86,32 @@ public:
 
     PxPhysics* getPhysics() { return physics; }
     PxScene* getScene() { return scene; }
+    PhysXPoolAllocator& getAllocator() { return allocator; }
+    PxU32 getScratchBlockSize() const { return scratchBlockSize; }
 
     // Simulation step
     void simulate(float deltaTime) {
-        scene->simulate(deltaTime);
+        ensureScratchBlock();
+        scene->simulate(deltaTime, nullptr, scratchBlock, scratchBlockSize);
         scene->fetchResults(true);
     }
 
 private:
+    // sized from the dynamic body count with some headroom, only ever grows
+    void ensureScratchBlock() {
+        PxU32 bodyCount = scene->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC);
+        PxU32 wanted = (bodyCount + bodyCount / 2) * SCRATCH_BYTES_PER_BODY;
+        wanted = ((wanted + SCRATCH_GRANULARITY - 1) / SCRATCH_GRANULARITY) * SCRATCH_GRANULARITY;
+        wanted = PxClamp(wanted, SCRATCH_GRANULARITY, MAX_SCRATCH_SIZE);
+        if (wanted <= scratchBlockSize) return;
+
+        if (scratchBlock) {
+            allocator.deallocate(scratchBlock);
+        }
+        scratchBlock = allocator.allocate(wanted, "PxSimulateScratchBlock", __FILE__, __LINE__);
+        scratchBlockSize = scratchBlock ? wanted : 0;
+    }
+
     PhysXManager() : foundation(nullptr), physics(nullptr), dispatcher(nullptr), scene(nullptr), pvd(nullptr) {}
     ~PhysXManager() { cleanup(); }
 };
@@ -0,0 +1,233 @@
+// PhysXSnapshot.h
+#pragma once
+#include "GameEngine.h"
+#include "PhysXBody.h"
+#include "PhysXManager.h"
+#include <PxPhysicsAPI.h>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace physx;
+
+// binary snapshot of the physics world through PxSerialization so a scenario
+// can be restarted without re-running createActor/createMaterial/updateMassAndInertia.
+// every captured actor gets a stable serial id, restore finds the new actor by that id
+// and points the owning PhysXBody (and so its Node) at it
+class PhysXSnapshot {
+public:
+    struct Entry {
+        PxSerialObjectId id = 0;
+        uint32_t bodyIndex = 0;              // index in PhysXWorld::bodies at capture time
+        std::shared_ptr<PhysXBody> body;     // keeps bodies removed after the capture alive
+    };
+
+    PhysXSnapshot() = default;
+    PhysXSnapshot(const PhysXSnapshot&) = delete;
+    PhysXSnapshot& operator=(const PhysXSnapshot&) = delete;
+
+    bool isValid() const { return !data.empty(); }
+    const std::vector<Entry>& getEntries() const { return entries; }
+    size_t getSizeBytes() const { return data.size(); }
+
+    // serializes every body actor, actors in skipActors (merged statics) stay out of it
+    bool capture(const std::vector<std::shared_ptr<PhysXBody>>& bodies,
+        const std::unordered_set<PxRigidActor*>& skipActors = {}) {
+        PxSerializationRegistry* reg = getRegistry();
+        if (!reg) return false;
+
+        PxCollection* collection = PxCreateCollection();
+        std::unordered_map<PxRigidActor*, PxSerialObjectId> actorIds;
+        std::vector<Entry> captured;
+
+        for (uint32_t i = 0; i < bodies.size(); ++i) {
+            const auto& body = bodies[i];
+            if (!body || !body->actor || skipActors.count(body->actor)) continue;
+
+            auto it = actorIds.find(body->actor);
+            if (it == actorIds.end()) {
+                PxSerialObjectId id = nextId++;
+                collection->add(*body->actor, id);
+                it = actorIds.emplace(body->actor, id).first;
+            }
+            captured.push_back({ it->second, i, body });
+        }
+
+        // pulls in shapes, materials, meshes the actors reference
+        PxSerialization::complete(*collection, *reg);
+
+        PxDefaultMemoryOutputStream stream;
+        bool ok = PxSerialization::serializeCollectionToBinary(stream, *collection, *reg);
+        collection->release();
+
+        if (!ok) {
+            std::cout << "PhysXSnapshot: binary serialization failed" << std::endl;
+            return false;
+        }
+
+        data.assign(stream.getData(), stream.getData() + stream.getSize());
+        entries = std::move(captured);
+        return true;
+    }
+
+    // replaces the current actors of every body in currentBodies (minus skipActors) with
+    // the snapshot's. returns the bodies that exist in the snapshot, the caller drops the rest
+    std::vector<std::shared_ptr<PhysXBody>> restore(const std::vector<std::shared_ptr<PhysXBody>>& currentBodies,
+        const std::unordered_set<PxRigidActor*>& skipActors = {}) {
+        std::vector<std::shared_ptr<PhysXBody>> restored;
+        PxSerializationRegistry* reg = getRegistry();
+        PxScene* pxScene = PhysXManager::getInstance().getScene();
+        if (!reg || !pxScene || data.empty()) return restored;
+
+        releaseCurrentActors(currentBodies, skipActors);
+
+        // binary collections are deserialized in place, the block has to outlive the objects
+        void* memory = ::operator new(data.size(), std::align_val_t(PX_SERIAL_FILE_ALIGN));
+        std::memcpy(memory, data.data(), data.size());
+
+        PxCollection* collection = PxSerialization::createCollectionFromBinary(memory, *reg);
+        if (!collection) {
+            std::cout << "PhysXSnapshot: failed to deserialize snapshot" << std::endl;
+            ::operator delete(memory, std::align_val_t(PX_SERIAL_FILE_ALIGN));
+            return restored;
+        }
+        pxScene->addCollection(*collection);
+
+        for (const Entry& entry : entries) {
+            PxBase* object = collection->find(entry.id);
+            entry.body->actor = object ? object->is<PxRigidActor>() : nullptr;
+            entry.body->updateNode();
+            restored.push_back(entry.body);
+        }
+
+        liveCollection = collection;
+        liveMemory = memory;
+        return restored;
+    }
+
+    bool saveToFile(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file || data.empty()) return false;
+
+        uint32_t header[3] = { FILE_MAGIC, static_cast<uint32_t>(entries.size()), static_cast<uint32_t>(data.size()) };
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (const Entry& entry : entries) {
+            file.write(reinterpret_cast<const char*>(&entry.id), sizeof(entry.id));
+            file.write(reinterpret_cast<const char*>(&entry.bodyIndex), sizeof(entry.bodyIndex));
+        }
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        return file.good();
+    }
+
+    // bodies are matched by index, so this only works for the same scenario setup
+    bool loadFromFile(const std::string& path, const std::vector<std::shared_ptr<PhysXBody>>& bodies) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        uint32_t header[3] = {};
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!file || header[0] != FILE_MAGIC) return false;
+
+        std::vector<Entry> loaded(header[1]);
+        for (Entry& entry : loaded) {
+            file.read(reinterpret_cast<char*>(&entry.id), sizeof(entry.id));
+            file.read(reinterpret_cast<char*>(&entry.bodyIndex), sizeof(entry.bodyIndex));
+            if (entry.bodyIndex >= bodies.size()) {
+                std::cout << "PhysXSnapshot: " << path << " doesn't match the current world" << std::endl;
+                return false;
+            }
+            entry.body = bodies[entry.bodyIndex];
+            nextId = std::max(nextId, entry.id + 1);
+        }
+
+        std::vector<uint8_t> loadedData(header[2]);
+        file.read(reinterpret_cast<char*>(loadedData.data()), loadedData.size());
+        if (!file) return false;
+
+        entries = std::move(loaded);
+        data = std::move(loadedData);
+        return true;
+    }
+
+    // drops the capture along with the actors, isValid() is false afterwards
+    void clear() {
+        release();
+        data.clear();
+        entries.clear();
+    }
+
+    // call before PhysXManager::cleanup
+    void release() {
+        if (liveCollection) {
+            PxCollectionExt::releaseObjects(*liveCollection);
+            liveCollection->release();
+            liveCollection = nullptr;
+        }
+        if (liveMemory) {
+            ::operator delete(liveMemory, std::align_val_t(PX_SERIAL_FILE_ALIGN));
+            liveMemory = nullptr;
+        }
+        if (registry) {
+            registry->release();
+            registry = nullptr;
+        }
+        for (Entry& entry : entries) {
+            entry.body->actor = nullptr;
+        }
+    }
+
+private:
+    static constexpr uint32_t FILE_MAGIC = 0x50414e53; // "SNAP"
+
+    std::vector<uint8_t> data;
+    std::vector<Entry> entries;
+    PxSerialObjectId nextId = 1;
+
+    PxSerializationRegistry* registry = nullptr;
+
+    // objects created by the last restore live inside liveMemory
+    PxCollection* liveCollection = nullptr;
+    void* liveMemory = nullptr;
+
+    PxSerializationRegistry* getRegistry() {
+        if (!registry) {
+            if (PxPhysics* physics = PhysXManager::getInstance().getPhysics()) {
+                registry = PxSerialization::createSerializationRegistry(*physics);
+            }
+        }
+        return registry;
+    }
+
+    void releaseCurrentActors(const std::vector<std::shared_ptr<PhysXBody>>& bodies,
+        const std::unordered_set<PxRigidActor*>& skipActors) {
+        std::unordered_set<PxRigidActor*> released;
+        auto releaseBody = [&](const std::shared_ptr<PhysXBody>& body) {
+            PxRigidActor* actor = body ? body->actor : nullptr;
+            if (!actor || skipActors.count(actor)) return;
+
+            // actors from the previous restore go with their collection below
+            if (!(liveCollection && liveCollection->contains(*actor)) && released.insert(actor).second) {
+                actor->release();
+            }
+            body->actor = nullptr;
+        };
+
+        for (const auto& body : bodies) {
+            releaseBody(body);
+        }
+        // bodies dropped from the world since the capture can still own an actor
+        for (const Entry& entry : entries) {
+            releaseBody(entry.body);
+        }
+
+        if (liveCollection) {
+            PxCollectionExt::releaseObjects(*liveCollection);
+            liveCollection->release();
+            liveCollection = nullptr;
+        }
+        if (liveMemory) {
+            ::operator delete(liveMemory, std::align_val_t(PX_SERIAL_FILE_ALIGN));
+            liveMemory = nullptr;
+        }
+    }
+};
@@ -0,0 +1,341 @@
+// PhysXStaticWorld.h
+#pragma once
+#include "GameEngine.h"
+#include "PhysXBody.h"
+#include "PhysXManager.h"
+#include <PxPhysicsAPI.h>
+#include <cstdint>
+#include <unordered_map>
+
+using namespace physx;
+
+// merges static colliders into a handful of PxRigidStatic actors and inserts them
+// with a prebuilt PxPruningStructure instead of one actor + one broadphase entry
+// per static object. the collider list can be cached next to the level so later
+// loads skip walking the nodes entirely
+class PhysXStaticWorld {
+public:
+    // everything we need to recreate a shape, plain data so it can go straight to disk
+    struct ColliderDesc {
+        uint32_t geometryType = 0;    // PxGeometryType::Enum
+        float params[3] = { 0.0f, 0.0f, 0.0f }; // sphere: r, box: half extents, capsule: r, halfHeight
+        float position[3] = { 0.0f, 0.0f, 0.0f };
+        float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f }; // x y z w
+        float staticFriction = 0.5f;
+        float dynamicFriction = 0.5f;
+        float restitution = 0.6f;
+        int32_t bodyIndex = -1;       // index into mergedBodies, -1 for plain nodes
+    };
+
+    // shapes per merged actor, keeps individual actor bounds from getting huge
+    size_t maxShapesPerActor = 256;
+
+    // pulls the shapes off an existing static body and drops its actor. the body is left
+    // without an actor of its own (the merged ones are shared, nothing may release them
+    // through a body), removeStaticBody() takes its shapes back out
+    void addStaticBody(const std::shared_ptr<PhysXBody>& body) {
+        if (!body || !body->isStatic || !body->actor || contains(body.get())) return;
+
+        PxRigidActor* oldActor = body->actor;
+        PxTransform actorPose = oldActor->getGlobalPose();
+        int32_t bodyIndex = addMergedBody(body);
+
+        PxU32 shapeCount = oldActor->getNbShapes();
+        std::vector<PxShape*> shapes(shapeCount);
+        oldActor->getShapes(shapes.data(), shapeCount);
+
+        for (PxShape* shape : shapes) {
+            ColliderDesc desc;
+            if (!describeGeometry(shape->getGeometry(), desc)) {
+                std::cout << "PhysXStaticWorld: skipping unsupported static shape on " << (body->node ? body->node->name : "") << std::endl;
+                continue;
+            }
+            setPose(desc, actorPose * shape->getLocalPose());
+
+            PxMaterial* material = nullptr;
+            if (shape->getMaterials(&material, 1) == 1 && material) {
+                desc.staticFriction = material->getStaticFriction();
+                desc.dynamicFriction = material->getDynamicFriction();
+                desc.restitution = material->getRestitution();
+            }
+            desc.bodyIndex = bodyIndex;
+            colliders.push_back(desc);
+        }
+
+        body->releaseActor();
+    }
+
+    // like addStaticBody, but the body's colliders already came from loadCache(), so its
+    // shapes aren't walked. bodies have to come in the order they had when the cache was saved
+    void addCachedBody(const std::shared_ptr<PhysXBody>& body) {
+        if (!body || !body->isStatic || !body->actor || contains(body.get())) return;
+        addMergedBody(body);
+        body->releaseActor();
+    }
+
+    bool contains(const PhysXBody* body) const {
+        return bodyIndices.count(body) != 0;
+    }
+
+    // detaches the body's shapes from the merged actors, the rest of the static world
+    // keeps its collision. its colliders don't come back on the next build()
+    void removeStaticBody(const PhysXBody* body) {
+        auto it = bodyIndices.find(body);
+        if (it == bodyIndices.end()) return;
+        int32_t bodyIndex = it->second;
+
+        for (PxShape* shape : bodyShapes[bodyIndex]) {
+            if (PxRigidActor* actor = shape->getActor()) actor->detachShape(*shape);
+        }
+        bodyShapes[bodyIndex].clear();
+        colliders.erase(std::remove_if(colliders.begin(), colliders.end(),
+            [bodyIndex](const ColliderDesc& desc) { return desc.bodyIndex == bodyIndex; }), colliders.end());
+
+        // the slot stays so the indices of the other colliders don't move
+        mergedBodies[bodyIndex] = nullptr;
+        bodyIndices.erase(it);
+    }
+
+    // static geometry straight from nodes, no PhysXBody or actor gets created.
+    // children are added too, each with its own world transform
+    void addStaticNode(const std::shared_ptr<Node>& node) {
+        if (!node) return;
+
+        if (node->mesh && node->type != NodeType::Cylinder) {
+            // reuse PhysXBody's node -> geometry mapping without creating an actor
+            PhysXBody probe(node, true, false);
+            probe.createGeometryFromMesh();
+
+            ColliderDesc desc;
+            if (probe.getGeometry() && describeGeometry(*probe.getGeometry(), desc)) {
+                glm::vec3 position = glm::vec3(node->worldTransform[3]);
+                glm::quat orientation = glm::quat_cast(glm::mat3(node->worldTransform));
+                setPose(desc, PxTransform(
+                    PxVec3(position.x, position.y, position.z),
+                    PxQuat(orientation.x, orientation.y, orientation.z, orientation.w)));
+                colliders.push_back(desc);
+            }
+        }
+
+        for (const auto& child : node->children) {
+            addStaticNode(child);
+        }
+    }
+
+    // creates the merged actors and adds them to the scene in one go. the actors of a
+    // previous build are released first, so calling it again after adding more is fine
+    bool build() {
+        PxPhysics* physics = PhysXManager::getInstance().getPhysics();
+        PxScene* pxScene = PhysXManager::getInstance().getScene();
+        if (!physics || !pxScene) return false;
+
+        releaseActors();
+        if (colliders.empty()) return true;
+
+        // sort so shapes that are close together share an actor (and its bounds)
+        std::sort(colliders.begin(), colliders.end(), [](const ColliderDesc& a, const ColliderDesc& b) {
+            if (a.position[0] != b.position[0]) return a.position[0] < b.position[0];
+            return a.position[2] < b.position[2];
+        });
+
+        std::map<std::array<float, 3>, PxMaterial*> materials;
+        PxRigidStatic* current = nullptr;
+        size_t shapesInCurrent = 0;
+
+        for (const ColliderDesc& desc : colliders) {
+            if (!current || shapesInCurrent >= maxShapesPerActor) {
+                current = physics->createRigidStatic(PxTransform(PxIdentity));
+                actors.push_back(current);
+                shapesInCurrent = 0;
+            }
+
+            std::array<float, 3> materialKey = { desc.staticFriction, desc.dynamicFriction, desc.restitution };
+            PxMaterial*& material = materials[materialKey];
+            if (!material) {
+                material = physics->createMaterial(desc.staticFriction, desc.dynamicFriction, desc.restitution);
+            }
+
+            PxGeometryHolder geometry;
+            if (!makeGeometry(desc, geometry)) continue;
+
+            PxShape* shape = physics->createShape(geometry.any(), *material, true);
+            shape->setLocalPose(PxTransform(
+                PxVec3(desc.position[0], desc.position[1], desc.position[2]),
+                PxQuat(desc.rotation[0], desc.rotation[1], desc.rotation[2], desc.rotation[3])));
+            current->attachShape(*shape);
+            shape->release(); // actor holds the reference now
+            ++shapesInCurrent;
+
+            if (desc.bodyIndex >= 0 && desc.bodyIndex < static_cast<int32_t>(bodyShapes.size())) {
+                bodyShapes[desc.bodyIndex].push_back(shape);
+            }
+        }
+
+        // shapes took their own references
+        for (auto& [key, material] : materials) {
+            material->release();
+        }
+
+        std::vector<PxRigidActor*> rigidActors(actors.begin(), actors.end());
+        PxPruningStructure* pruningStructure = physics->createPruningStructure(
+            rigidActors.data(), static_cast<PxU32>(rigidActors.size()));
+
+        if (pruningStructure) {
+            pxScene->addActors(*pruningStructure);
+            pruningStructure->release();
+        }
+        else {
+            std::cout << "PhysXStaticWorld: failed to build pruning structure, adding actors directly" << std::endl;
+            std::vector<PxActor*> pxActors(actors.begin(), actors.end());
+            pxScene->addActors(pxActors.data(), static_cast<PxU32>(pxActors.size()));
+        }
+
+        std::cout << "PhysXStaticWorld: merged " << colliders.size() << " static shapes into "
+            << actors.size() << " actors" << std::endl;
+        return true;
+    }
+
+    // the cache only stores primitive shapes, so levels with cooked meshes rebuild every time
+    bool saveCache(const std::string& path, uint32_t levelVersion = 0) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cout << "PhysXStaticWorld: could not write cache " << path << std::endl;
+            return false;
+        }
+
+        CacheHeader header;
+        header.levelVersion = levelVersion;
+        header.colliderCount = static_cast<uint32_t>(colliders.size());
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(colliders.data()), colliders.size() * sizeof(ColliderDesc));
+        return file.good();
+    }
+
+    // replaces the collider list with the cached one, returns false if missing or stale.
+    // only for a world nothing has been merged into yet, the cached body indices count from 0
+    bool loadCache(const std::string& path, uint32_t levelVersion = 0) {
+        if (isBuilt()) return false;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        CacheHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+            header.levelVersion != levelVersion) {
+            std::cout << "PhysXStaticWorld: cache " << path << " is stale, rebuilding" << std::endl;
+            return false;
+        }
+
+        std::vector<ColliderDesc> loaded(header.colliderCount);
+        file.read(reinterpret_cast<char*>(loaded.data()), loaded.size() * sizeof(ColliderDesc));
+        if (!file) return false;
+
+        // bodies are added in the same order for the same level version (addCachedBody),
+        // so the cached body indices still match
+        colliders = std::move(loaded);
+        return true;
+    }
+
+    void clear() {
+        releaseActors();
+        colliders.clear();
+        mergedBodies.clear();
+        bodyShapes.clear();
+        bodyIndices.clear();
+    }
+
+    // anything merged or built since construction / clear()
+    bool isBuilt() const { return !mergedBodies.empty() || !actors.empty(); }
+
+    size_t getActorCount() const { return actors.size(); }
+    size_t getColliderCount() const { return colliders.size(); }
+    const std::vector<PxRigidStatic*>& getActors() const { return actors; }
+
+private:
+    static constexpr uint32_t CACHE_MAGIC = 0x57535850; // "PXSW"
+    static constexpr uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader {
+        uint32_t magic = CACHE_MAGIC;
+        uint32_t version = CACHE_VERSION;
+        uint32_t levelVersion = 0;
+        uint32_t colliderCount = 0;
+    };
+
+    std::vector<ColliderDesc> colliders;
+    std::vector<std::shared_ptr<PhysXBody>> mergedBodies;  // null once removed
+    std::vector<std::vector<PxShape*>> bodyShapes;          // per merged body, owned by the actors
+    std::unordered_map<const PhysXBody*, int32_t> bodyIndices;
+    std::vector<PxRigidStatic*> actors;
+
+    int32_t addMergedBody(const std::shared_ptr<PhysXBody>& body) {
+        int32_t bodyIndex = static_cast<int32_t>(mergedBodies.size());
+        mergedBodies.push_back(body);
+        bodyShapes.emplace_back();
+        bodyIndices[body.get()] = bodyIndex;
+        return bodyIndex;
+    }
+
+    void releaseActors() {
+        for (auto& shapes : bodyShapes) {
+            shapes.clear();
+        }
+        for (PxRigidStatic* actor : actors) {
+            actor->release(); // also removes it from the scene
+        }
+        actors.clear();
+    }
+
+    static void setPose(ColliderDesc& desc, const PxTransform& pose) {
+        desc.position[0] = pose.p.x;
+        desc.position[1] = pose.p.y;
+        desc.position[2] = pose.p.z;
+        desc.rotation[0] = pose.q.x;
+        desc.rotation[1] = pose.q.y;
+        desc.rotation[2] = pose.q.z;
+        desc.rotation[3] = pose.q.w;
+    }
+
+    static bool describeGeometry(const PxGeometry& geometry, ColliderDesc& desc) {
+        desc.geometryType = static_cast<uint32_t>(geometry.getType());
+        switch (geometry.getType()) {
+        case PxGeometryType::eSPHERE: {
+            const auto& sphere = static_cast<const PxSphereGeometry&>(geometry);
+            desc.params[0] = sphere.radius;
+            return true;
+        }
+        case PxGeometryType::eBOX: {
+            const auto& box = static_cast<const PxBoxGeometry&>(geometry);
+            desc.params[0] = box.halfExtents.x;
+            desc.params[1] = box.halfExtents.y;
+            desc.params[2] = box.halfExtents.z;
+            return true;
+        }
+        case PxGeometryType::eCAPSULE: {
+            const auto& capsule = static_cast<const PxCapsuleGeometry&>(geometry);
+            desc.params[0] = capsule.radius;
+            desc.params[1] = capsule.halfHeight;
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    static bool makeGeometry(const ColliderDesc& desc, PxGeometryHolder& holder) {
+        switch (static_cast<PxGeometryType::Enum>(desc.geometryType)) {
+        case PxGeometryType::eSPHERE:
+            holder.storeAny(PxSphereGeometry(desc.params[0]));
+            return true;
+        case PxGeometryType::eBOX:
+            holder.storeAny(PxBoxGeometry(desc.params[0], desc.params[1], desc.params[2]));
+            return true;
+        case PxGeometryType::eCAPSULE:
+            holder.storeAny(PxCapsuleGeometry(desc.params[0], desc.params[1]));
+            return true;
+        default:
+            return false;
+        }
+    }
+};
@@ -2,16 +2,56 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <unordered_map>
 #include "PhysXBody.h"
 
 class PhysXWorld {
 public:
+    // read only outside this class, go through add/remove/setBodies so the lookups stay in sync
     std::vector<std::shared_ptr<PhysXBody>> bodies;
 
     void addBody(std::shared_ptr<PhysXBody> body) {
+        if (!body || indexByBody.count(body.get())) return;
+        indexByBody[body.get()] = bodies.size();
+        if (body->node) {
+            bodyByNode[body->node.get()] = body.get();
+        }
         bodies.push_back(body);
     }
 
+    // swap-remove, doesn't touch the actor
+    bool removeBody(const std::shared_ptr<PhysXBody>& body) {
+        auto it = body ? indexByBody.find(body.get()) : indexByBody.end();
+        if (it == indexByBody.end()) return false;
+
+        size_t index = it->second;
+        indexByBody.erase(it);
+        if (body->node) {
+            bodyByNode.erase(body->node.get());
+        }
+
+        if (index != bodies.size() - 1) {
+            bodies[index] = std::move(bodies.back());
+            indexByBody[bodies[index].get()] = index;
+        }
+        bodies.pop_back();
+        return true;
+    }
+
+    std::shared_ptr<PhysXBody> findBody(const Node* node) const {
+        auto it = bodyByNode.find(node);
+        return it != bodyByNode.end() ? bodies[indexByBody.at(it->second)] : nullptr;
+    }
+
+    void setBodies(std::vector<std::shared_ptr<PhysXBody>> newBodies) {
+        bodies.clear();
+        indexByBody.clear();
+        bodyByNode.clear();
+        for (auto& body : newBodies) {
+            addBody(std::move(body));
+        }
+    }
+
     void updateSimulation(float deltaTime) {
         PhysXManager::getInstance().simulate(deltaTime);
 
@@ -24,4 +64,8 @@ public:
     void debug() {
         std::cout << "Physics bodies in world: " << bodies.size() << std::endl;
     }
+
+private:
+    std::unordered_map<const PhysXBody*, size_t> indexByBody;
+    std::unordered_map<const Node*, const PhysXBody*> bodyByNode;
 };
\ No newline at end of file
@@ -49,12 +49,12 @@ public:
     }
 
     void setupMeshUVs(const std::shared_ptr<Mesh>& mesh) {
-        if (!mesh || mesh->uvSets["map1"].empty()) return;
+        if (!mesh || mesh->uvSets[Mesh::DEFAULT_UV_SET].empty()) return;
 
         uvPoints.clear();
         uvIndices.clear();
 
-        const auto& uvs = mesh->uvSets["map1"];
+        const auto& uvs = mesh->uvSets[Mesh::DEFAULT_UV_SET];
         for (const auto& uv : uvs) {
             glm::vec2 screenPos;
             screenPos.x = (uv.x * 2.0f - 1.0f) * 0.8f;
@@ -63,7 +63,7 @@ public:
         }
         uvIndices = mesh->indices;
 
-        glBindVertexArray(vao);
+        GLStateCache::getInstance().bindVertexArray(vao);
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
         glBufferData(GL_ARRAY_BUFFER, uvPoints.size() * sizeof(glm::vec2), uvPoints.data(), GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
@@ -79,8 +79,9 @@ public:
         glGetIntegerv(GL_VIEWPORT, previousViewport);
 
         glViewport(previousViewport[2] - 256, 0, 256, 256);
-        glUseProgram(shaderProgram);
-        glBindVertexArray(vao);
+        GLStateCache& gl = GLStateCache::getInstance();
+        gl.useProgram(shaderProgram);
+        gl.bindVertexArray(vao);
 
         glLineWidth(1.0f);
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -92,7 +93,7 @@ public:
 
     ~UVViewer() {
         glDeleteProgram(shaderProgram);
-        glDeleteVertexArrays(1, &vao);
+        GLStateCache::getInstance().deleteVertexArrays(1, &vao);
         glDeleteBuffers(1, &vbo);
         glDeleteBuffers(1, &ebo);
     }
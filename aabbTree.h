@@ -0,0 +1,303 @@
+// aabbTree.h
+#pragma once
+#include "bounds.h"
+#include <cstdint>
+#include <vector>
+
+// dynamic bounding volume hierarchy. leaves hold a fattened box around the real bounds,
+// so objects that move a little keep their leaf and only the ones that leave it get
+// reinserted. insertion walks down by surface area cost and every branch gets rebalanced
+// on the way back up, so the tree stays shallow without ever doing a full rebuild
+template<typename T>
+class AABBTree {
+public:
+    static constexpr int32_t NULL_NODE = -1;
+
+    float margin = 0.1f;    // world units added around each leaf
+
+    AABBTree() = default;
+
+    int32_t insert(const AABB& bounds, T userData) {
+        int32_t leaf = allocateNode();
+        nodes[leaf].bounds = bounds.fattened(margin);
+        nodes[leaf].userData = userData;
+        nodes[leaf].height = 0;
+        insertLeaf(leaf);
+        ++proxyCount;
+        return leaf;
+    }
+
+    void remove(int32_t proxy) {
+        removeLeaf(proxy);
+        freeNode(proxy);
+        --proxyCount;
+    }
+
+    // true if the proxy had to be reinserted
+    bool move(int32_t proxy, const AABB& bounds) {
+        if (nodes[proxy].bounds.contains(bounds)) {
+            // still fits, but don't keep a box that's way too big after shrinking
+            AABB loose = bounds.fattened(margin * 4.0f);
+            if (loose.contains(nodes[proxy].bounds)) return false;
+        }
+
+        removeLeaf(proxy);
+        nodes[proxy].bounds = bounds.fattened(margin);
+        insertLeaf(proxy);
+        return true;
+    }
+
+    T& getUserData(int32_t proxy) { return nodes[proxy].userData; }
+    const AABB& getFatBounds(int32_t proxy) const { return nodes[proxy].bounds; }
+
+    // fn(T&) for every leaf touching the frustum. subtrees fully inside skip the plane tests
+    template<typename Fn>
+    void query(const Frustum& frustum, Fn&& fn) {
+        if (root == NULL_NODE) return;
+
+        stack.clear();
+        stack.push_back({ root, false });
+        while (!stack.empty()) {
+            auto [index, inside] = stack.back();
+            stack.pop_back();
+            TreeNode& node = nodes[index];
+
+            if (!inside) {
+                Frustum::Result result = frustum.classify(node.bounds);
+                if (result == Frustum::Result::Outside) continue;
+                inside = result == Frustum::Result::Inside;
+            }
+
+            if (node.isLeaf()) {
+                fn(node.userData);
+            }
+            else {
+                stack.push_back({ node.child1, inside });
+                stack.push_back({ node.child2, inside });
+            }
+        }
+    }
+
+    template<typename Fn>
+    void query(const AABB& bounds, Fn&& fn) {
+        if (root == NULL_NODE) return;
+
+        stack.clear();
+        stack.push_back({ root, false });
+        while (!stack.empty()) {
+            TreeNode& node = nodes[stack.back().index];
+            stack.pop_back();
+            if (!node.bounds.overlaps(bounds)) continue;
+
+            if (node.isLeaf()) {
+                fn(node.userData);
+            }
+            else {
+                stack.push_back({ node.child1, false });
+                stack.push_back({ node.child2, false });
+            }
+        }
+    }
+
+    void clear() {
+        nodes.clear();
+        root = NULL_NODE;
+        freeList = NULL_NODE;
+        proxyCount = 0;
+    }
+
+    size_t size() const { return proxyCount; }
+    int32_t getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+private:
+    struct TreeNode {
+        AABB bounds;
+        T userData{};
+        int32_t parent = NULL_NODE;     // next free node while on the free list
+        int32_t child1 = NULL_NODE;
+        int32_t child2 = NULL_NODE;
+        int32_t height = -1;            // leaf = 0, free = -1
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    struct StackEntry {
+        int32_t index;
+        bool inside;
+    };
+
+    std::vector<TreeNode> nodes;
+    std::vector<StackEntry> stack;
+    int32_t root = NULL_NODE;
+    int32_t freeList = NULL_NODE;
+    size_t proxyCount = 0;
+
+    int32_t allocateNode() {
+        if (freeList == NULL_NODE) {
+            nodes.emplace_back();
+            return static_cast<int32_t>(nodes.size() - 1);
+        }
+        int32_t index = freeList;
+        freeList = nodes[index].parent;
+        nodes[index] = TreeNode();
+        return index;
+    }
+
+    void freeNode(int32_t index) {
+        nodes[index] = TreeNode();
+        nodes[index].parent = freeList;
+        freeList = index;
+    }
+
+    void insertLeaf(int32_t leaf) {
+        if (root == NULL_NODE) {
+            root = leaf;
+            nodes[root].parent = NULL_NODE;
+            return;
+        }
+
+        // cheapest sibling by surface area
+        const AABB leafBounds = nodes[leaf].bounds;
+        int32_t index = root;
+        while (!nodes[index].isLeaf()) {
+            const TreeNode& node = nodes[index];
+            float area = node.bounds.getPerimeter();
+            float combinedArea = AABB::merge(node.bounds, leafBounds).getPerimeter();
+
+            // making a new parent here, vs pushing the leaf further down
+            float cost = 2.0f * combinedArea;
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto descendCost = [&](int32_t child) {
+                const AABB merged = AABB::merge(leafBounds, nodes[child].bounds);
+                if (nodes[child].isLeaf()) return merged.getPerimeter() + inheritanceCost;
+                return merged.getPerimeter() - nodes[child].bounds.getPerimeter() + inheritanceCost;
+            };
+            float cost1 = descendCost(node.child1);
+            float cost2 = descendCost(node.child2);
+
+            if (cost < cost1 && cost < cost2) break;
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+
+        int32_t sibling = index;
+        int32_t oldParent = nodes[sibling].parent;
+        int32_t newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].bounds = AABB::merge(leafBounds, nodes[sibling].bounds);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent == NULL_NODE) {
+            root = newParent;
+        }
+        else if (nodes[oldParent].child1 == sibling) {
+            nodes[oldParent].child1 = newParent;
+        }
+        else {
+            nodes[oldParent].child2 = newParent;
+        }
+
+        refitFrom(nodes[leaf].parent);
+    }
+
+    void removeLeaf(int32_t leaf) {
+        if (leaf == root) {
+            root = NULL_NODE;
+            return;
+        }
+
+        int32_t parent = nodes[leaf].parent;
+        int32_t grandParent = nodes[parent].parent;
+        int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        if (grandParent == NULL_NODE) {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+            freeNode(parent);
+            return;
+        }
+
+        if (nodes[grandParent].child1 == parent) {
+            nodes[grandParent].child1 = sibling;
+        }
+        else {
+            nodes[grandParent].child2 = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        refitFrom(grandParent);
+    }
+
+    // fix bounds and heights up to the root, rotating where it's lopsided
+    void refitFrom(int32_t index) {
+        while (index != NULL_NODE) {
+            index = balance(index);
+
+            TreeNode& node = nodes[index];
+            node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+            node.bounds = AABB::merge(nodes[node.child1].bounds, nodes[node.child2].bounds);
+
+            index = node.parent;
+        }
+    }
+
+    // AVL style rotation, returns whichever node now sits where a was
+    int32_t balance(int32_t a) {
+        TreeNode& A = nodes[a];
+        if (A.isLeaf() || A.height < 2) return a;
+
+        int32_t b = A.child1;
+        int32_t c = A.child2;
+        int32_t heightDiff = nodes[c].height - nodes[b].height;
+
+        if (heightDiff > 1) return rotateUp(a, c, b);
+        if (heightDiff < -1) return rotateUp(a, b, c);
+        return a;
+    }
+
+    // high (child of a) takes a's place, a keeps low plus the shorter child of high
+    int32_t rotateUp(int32_t a, int32_t high, int32_t low) {
+        TreeNode& A = nodes[a];
+        TreeNode& H = nodes[high];
+        int32_t f = H.child1;
+        int32_t g = H.child2;
+
+        H.child1 = a;
+        H.parent = A.parent;
+        A.parent = high;
+
+        if (H.parent == NULL_NODE) {
+            root = high;
+        }
+        else if (nodes[H.parent].child1 == a) {
+            nodes[H.parent].child1 = high;
+        }
+        else {
+            nodes[H.parent].child2 = high;
+        }
+
+        // taller grandchild stays with high
+        int32_t keep = nodes[f].height > nodes[g].height ? f : g;
+        int32_t give = keep == f ? g : f;
+
+        H.child2 = keep;
+        if (A.child1 == high) {
+            A.child1 = give;
+        }
+        else {
+            A.child2 = give;
+        }
+        nodes[give].parent = a;
+
+        A.bounds = AABB::merge(nodes[low].bounds, nodes[give].bounds);
+        A.height = 1 + std::max(nodes[low].height, nodes[give].height);
+        H.bounds = AABB::merge(A.bounds, nodes[keep].bounds);
+        H.height = 1 + std::max(A.height, nodes[keep].height);
+        return high;
+    }
+};
@@ -48,6 +48,7 @@ public:
 class AnimationChannel {
 public:
     std::string targetProperty;  // What this channel animates (e.g., "position", "rotation")
+    StringId targetId;           // hashed targetProperty, what bone lookups use
     std::vector<Keyframe> keyframes;
 
     void addKeyframe(const Keyframe& keyframe) {
@@ -133,6 +134,7 @@ public:
             const aiNodeAnim* channel = anim->mChannels[i];
             AnimationChannel newChannel;
             newChannel.targetProperty = channel->mNodeName.data;
+            newChannel.targetId = internString(newChannel.targetProperty);
 
             // Convert position keyframes
             for (unsigned int j = 0; j < channel->mNumPositionKeys; j++) {
@@ -203,7 +205,7 @@ struct VertexBoneData {
 class Armature {
 public:
     std::vector<Bone> bones;
-    std::map<std::string, int> boneNameToIndex;
+    std::unordered_map<StringId, int> boneNameToIndex;
     glm::mat4 globalInverseTransform;
 
     void initialize(const aiNode* rootNode) {
@@ -213,7 +215,7 @@ public:
 
     void addBone(const std::string& name, const glm::mat4& offset, int parent = -1) {
         int index = bones.size();
-        boneNameToIndex[name] = index;
+        boneNameToIndex[internString(name)] = index;
 
         Bone bone;
         bone.name = name;
@@ -291,7 +293,7 @@ public:
         if (!boneData.empty()) {
             GLuint boneVBO;
             glGenBuffers(1, &boneVBO);
-            glBindVertexArray(VAO);
+            GLStateCache::getInstance().bindVertexArray(VAO);
             glBindBuffer(GL_ARRAY_BUFFER, boneVBO);
             glBufferData(GL_ARRAY_BUFFER, boneData.size() * sizeof(VertexBoneData),
                 boneData.data(), GL_STATIC_DRAW);
@@ -374,7 +376,8 @@ private:
 
         // Update bone transforms based on current time
         for (auto& channel : currentAction->channels) {
-            if (auto it = mesh->armature.boneNameToIndex.find(channel.targetProperty);
+            StringId target = channel.targetId.isValid() ? channel.targetId : StringId(channel.targetProperty);
+            if (auto it = mesh->armature.boneNameToIndex.find(target);
                 it != mesh->armature.boneNameToIndex.end()) {
                 int boneIndex = it->second;
                 Bone& bone = mesh->armature.bones[boneIndex];
@@ -480,6 +483,7 @@ public:
                     activeAction.targetNode->localTranslation = position;
                     activeAction.targetNode->localRotation = rotation;
                     activeAction.targetNode->localScale = scale;
+                    activeAction.targetNode->markTransformDirty();
                 }
             }
         }
@@ -496,7 +500,7 @@ public:
         }
     }
 
-    void playAction(const std::string& name, std::shared_ptr<Action> action, std::shared_ptr<Node> target,
+    void playAction(StringId name, std::shared_ptr<Action> action, std::shared_ptr<Node> target,
         PlaybackMode mode = PlaybackMode::LOOP, float weight = 1.0f, float speed = 1.0f) {
         ActiveAction activeAction;
         activeAction.action = action;
@@ -511,7 +515,7 @@ public:
         activeActions[name] = activeAction;
     }
 
-    void stopAction(const std::string& name) {
+    void stopAction(StringId name) {
         auto it = activeActions.find(name);
         if (it != activeActions.end()) {
             it->second.shouldRemove = true;
@@ -524,44 +528,45 @@ public:
         }
     }
 
-    void pauseAction(const std::string& name) {
+    void pauseAction(StringId name) {
         auto it = activeActions.find(name);
         if (it != activeActions.end()) {
             it->second.isPlaying = false;
         }
     }
 
-    void resumeAction(const std::string& name) {
+    void resumeAction(StringId name) {
         auto it = activeActions.find(name);
         if (it != activeActions.end()) {
             it->second.isPlaying = true;
         }
     }
 
-    void setActionWeight(const std::string& name, float weight) {
+    void setActionWeight(StringId name, float weight) {
         auto it = activeActions.find(name);
         if (it != activeActions.end()) {
             it->second.weight = std::clamp(weight, 0.0f, 1.0f);
         }
     }
 
-    void setActionSpeed(const std::string& name, float speed) {
+    void setActionSpeed(StringId name, float speed) {
         auto it = activeActions.find(name);
         if (it != activeActions.end()) {
             it->second.speed = speed;
         }
     }
 
-    bool isActionPlaying(const std::string& name) const {
+    bool isActionPlaying(StringId name) const {
         auto it = activeActions.find(name);
         return it != activeActions.end() && it->second.isPlaying;
     }
 
-    const std::map<std::string, ActiveAction>& getActiveActions() const {
+    const std::unordered_map<StringId, ActiveAction>& getActiveActions() const {
         return activeActions;
     }
 
 private:
     float currentTime = 0.0f;
-    std::map<std::string, ActiveAction> activeActions;
+    // keyed by StringId::combine(node name, action name), see Scene::playAction
+    std::unordered_map<StringId, ActiveAction> activeActions;
 };
\ No newline at end of file
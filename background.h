@@ -1,6 +1,7 @@
 // background.h
 #pragma once
 #include "GameEngine.h"
+#include "glState.h"
 #include "shader.h"
 #include "misc_funcs.h"
 #include "textureManager.h"
@@ -75,7 +76,7 @@ public:
         glGenVertexArrays(1, &skyboxVAO);
         glGenBuffers(1, &skyboxVBO);
 
-        glBindVertexArray(skyboxVAO);
+        GLStateCache::getInstance().bindVertexArray(skyboxVAO);
         glBindBuffer(GL_ARRAY_BUFFER, skyboxVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
 
@@ -86,7 +87,7 @@ public:
     unsigned int loadCubemap(const std::vector<std::string>& faces) {
         unsigned int textureID;
         glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
         int width, height, nrChannels;
         for (unsigned int i = 0; i < faces.size(); i++) {
@@ -115,9 +116,10 @@ public:
     }
 
     void render(const glm::mat4& view, const glm::mat4& projection) {
+        GLStateCache& gl = GLStateCache::getInstance();
         // Change depth function and disable depth writing
-        glDepthFunc(GL_LEQUAL);
-        glDepthMask(GL_FALSE);
+        gl.depthFunc(GL_LEQUAL);
+        gl.depthMask(GL_FALSE);
 
         skyboxShader->use();
 
@@ -128,18 +130,18 @@ public:
         skyboxShader->setMat4("projection", projection);
 
         // Bind cubemap texture
-        glBindVertexArray(skyboxVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+        gl.bindVertexArray(skyboxVAO);
+        gl.activeTexture(GL_TEXTURE0);
+        gl.bindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
         glDrawArrays(GL_TRIANGLES, 0, 36);
 
         // Reset depth settings
-        glDepthMask(GL_TRUE);
-        glDepthFunc(GL_LESS);
+        gl.depthMask(GL_TRUE);
+        gl.depthFunc(GL_LESS);
     }
 
     ~Skybox() {
-        glDeleteVertexArrays(1, &skyboxVAO);
+        GLStateCache::getInstance().deleteVertexArrays(1, &skyboxVAO);
         glDeleteBuffers(1, &skyboxVBO);
     }
 };
@@ -200,7 +202,7 @@ public:
 
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
-        glBindVertexArray(VAO);
+        GLStateCache::getInstance().bindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 
@@ -238,8 +240,9 @@ public:
     virtual void render(const glm::mat4& view, const glm::mat4& projection) {
         std::cout << "\n --- Rendering background --- \n";
 
-        glDepthFunc(GL_LEQUAL);
-        glUseProgram(shaderProgram);
+        GLStateCache& gl = GLStateCache::getInstance();
+        gl.depthFunc(GL_LEQUAL);
+        gl.useProgram(shaderProgram);
 
         // Set common uniforms
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
@@ -251,21 +254,21 @@ public:
             glUniform3fv(glGetUniformLocation(shaderProgram, "backgroundColor"), 1, glm::value_ptr(backgroundColor));
         }
         else {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, textureID);
+            gl.activeTexture(GL_TEXTURE0);
+            gl.bindTexture(GL_TEXTURE_2D, textureID);
             glUniform1i(glGetUniformLocation(shaderProgram, "backgroundTexture"), 0);
         }
 
         // Render background quad
-        glBindVertexArray(VAO);
+        gl.bindVertexArray(VAO);
         glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
+        gl.bindVertexArray(0);
 
-        glDepthFunc(GL_LESS); // Reset depth function
+        gl.depthFunc(GL_LESS); // Reset depth function
     }
 
     ~Background() {
-        glDeleteVertexArrays(1, &VAO);
+        GLStateCache::getInstance().deleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
         glDeleteProgram(shaderProgram);
     }
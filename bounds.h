@@ -0,0 +1,133 @@
+// bounds.h
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// axis aligned box, empty when min > max
+struct AABB {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    AABB() = default;
+    AABB(const glm::vec3& minPoint, const glm::vec3& maxPoint) : min(minPoint), max(maxPoint) {}
+
+    bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+
+    // half the surface area, all the tree cost function needs
+    float getPerimeter() const {
+        glm::vec3 d = max - min;
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    void expand(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void expand(const AABB& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    AABB fattened(float margin) const {
+        return AABB(min - glm::vec3(margin), max + glm::vec3(margin));
+    }
+
+    bool contains(const AABB& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+            other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+    }
+
+    bool overlaps(const AABB& other) const {
+        return min.x <= other.max.x && other.min.x <= max.x &&
+            min.y <= other.max.y && other.min.y <= max.y &&
+            min.z <= other.max.z && other.min.z <= max.z;
+    }
+
+    static AABB merge(const AABB& a, const AABB& b) {
+        return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+    }
+
+    // bounds of the transformed box (center + |M| * extents), cheaper than 8 corners
+    AABB transformed(const glm::mat4& m) const {
+        if (!isValid()) return AABB();
+        glm::vec3 center = glm::vec3(m * glm::vec4(getCenter(), 1.0f));
+        glm::vec3 extents = getExtents();
+        glm::vec3 worldExtents(
+            std::abs(m[0][0]) * extents.x + std::abs(m[1][0]) * extents.y + std::abs(m[2][0]) * extents.z,
+            std::abs(m[0][1]) * extents.x + std::abs(m[1][1]) * extents.y + std::abs(m[2][1]) * extents.z,
+            std::abs(m[0][2]) * extents.x + std::abs(m[1][2]) * extents.y + std::abs(m[2][2]) * extents.z);
+        return AABB(center - worldExtents, center + worldExtents);
+    }
+};
+
+// six planes pulled out of a view projection matrix, normals point inwards
+class Frustum {
+public:
+    enum class Result {
+        Outside,
+        Intersects,
+        Inside
+    };
+
+    glm::vec4 planes[6];
+
+    Frustum() = default;
+
+    explicit Frustum(const glm::mat4& viewProjection) {
+        glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        planes[0] = row3 + row0;    // left
+        planes[1] = row3 - row0;    // right
+        planes[2] = row3 + row1;    // bottom
+        planes[3] = row3 - row1;    // top
+        planes[4] = row3 + row2;    // near
+        planes[5] = row3 - row2;    // far
+
+        for (auto& plane : planes) {
+            float length = glm::length(glm::vec3(plane));
+            if (length > 0.0f) plane /= length;
+        }
+    }
+
+    bool contains(const glm::vec3& point) const {
+        for (const auto& plane : planes) {
+            if (glm::dot(glm::vec3(plane), point) + plane.w < 0.0f) return false;
+        }
+        return true;
+    }
+
+    bool intersectsSphere(const glm::vec3& center, float radius) const {
+        for (const auto& plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+        }
+        return true;
+    }
+
+    // Inside means the tree can skip the plane tests for everything below
+    Result classify(const AABB& box) const {
+        glm::vec3 center = box.getCenter();
+        glm::vec3 extents = box.getExtents();
+        Result result = Result::Inside;
+        for (const auto& plane : planes) {
+            glm::vec3 normal(plane);
+            float distance = glm::dot(normal, center) + plane.w;
+            float radius = glm::dot(glm::abs(normal), extents);
+            if (distance < -radius) return Result::Outside;
+            if (distance < radius) result = Result::Intersects;
+        }
+        return result;
+    }
+
+    bool intersects(const AABB& box) const {
+        return classify(box) != Result::Outside;
+    }
+};
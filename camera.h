@@ -1,6 +1,7 @@
 // camera.h
 #pragma once
 #include "GameEngine.h"
+#include "bounds.h"
 
 // Define initial camera parameters
 class Camera {
@@ -86,6 +87,10 @@ public:
 	glm::mat4 getProjectionMatrix() {
 		return glm::perspective(glm::radians(45.0f), (float)screenWidth / (float)screenHeight, 0.1f, 100.0f);
 	}
+
+	Frustum getFrustum() {
+		return Frustum(getProjectionMatrix() * getViewMatrix());
+	}
 	
 	void toggleCam(GLFWwindow* window) {
 		camstate = !camstate;
@@ -107,4 +112,6 @@ public:
 };
 
 
-bool isInViewFrustum(const glm::vec3& point, const glm::mat4& viewProjection);
\ No newline at end of file
+inline bool isInViewFrustum(const glm::vec3& point, const glm::mat4& viewProjection) {
+	return Frustum(viewProjection).contains(point);
+}
\ No newline at end of file
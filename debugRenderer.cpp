@@ -2,6 +2,7 @@
 
 #pragma once
 #include "GameEngine.h"
+#include "glState.h"
 
 GLuint quadVAO = 0;
 GLuint quadVBO;
@@ -21,7 +22,7 @@ void renderQuad()
         // setup plane VAO
         glGenVertexArrays(1, &quadVAO);
         glGenBuffers(1, &quadVBO);
-        glBindVertexArray(quadVAO);
+        GLStateCache::getInstance().bindVertexArray(quadVAO);
         glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
         glEnableVertexAttribArray(0);
@@ -29,9 +30,9 @@ void renderQuad()
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     }
-    glBindVertexArray(quadVAO);
+    GLStateCache::getInstance().bindVertexArray(quadVAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindVertexArray(0);
+    GLStateCache::getInstance().bindVertexArray(0);
 }
 
 GLuint initDebugDepthShader()
@@ -117,7 +118,8 @@ GLuint initDebugDepthShader()
 
 void renderDepthMapToQuad(GLuint depthMap, const glm::mat4& lightSpaceMatrix, float near_plane, float far_plane)
 {
-    glUseProgram(debugDepthShader);
+    GLStateCache& gl = GLStateCache::getInstance();
+    gl.useProgram(debugDepthShader);
     // Create an orthographic projection matrix for the quad
     glm::mat4 orthoProjection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f);
     //lightProjection =  glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, near_plane, far_plane);
@@ -129,8 +131,8 @@ void renderDepthMapToQuad(GLuint depthMap, const glm::mat4& lightSpaceMatrix, fl
     glUniform1f(glGetUniformLocation(debugDepthShader, "near_plane"), near_plane);
     glUniform1f(glGetUniformLocation(debugDepthShader, "far_plane"), far_plane);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, depthMap);
+    gl.activeTexture(GL_TEXTURE0);
+    gl.bindTexture(GL_TEXTURE_2D, depthMap);
 
     renderQuad();
 }
\ No newline at end of file
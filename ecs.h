@@ -0,0 +1,361 @@
+// ecs.h
+#pragma once
+#include "slotMap.h"
+#include "jobSystem.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// archetype ECS. entities with the same set of components share an archetype, which keeps
+// them in fixed size chunks with one packed array per component (plus the entity ids).
+// systems walk the chunks of every archetype matching their query, so a pass over 100k
+// transforms only touches transforms. components must be trivially copyable, rows are
+// moved around with memcpy
+
+using Entity = SlotHandle;
+using ComponentMask = uint64_t;
+
+namespace ecs {
+
+constexpr size_t MAX_COMPONENT_TYPES = 64;
+constexpr size_t CHUNK_SIZE = 16 * 1024;
+constexpr size_t COLUMN_ALIGNMENT = 16;  // every column can be loaded with _mm_load_ps
+
+struct ComponentInfo {
+    size_t size = 0;
+    size_t alignment = 0;
+};
+
+inline std::array<ComponentInfo, MAX_COMPONENT_TYPES>& componentInfos() {
+    static std::array<ComponentInfo, MAX_COMPONENT_TYPES> infos;
+    return infos;
+}
+
+inline uint32_t registerComponentType(size_t size, size_t alignment) {
+    static std::atomic<uint32_t> nextId{ 0 };
+    uint32_t id = nextId++;
+    if (id >= MAX_COMPONENT_TYPES) {
+        std::cout << "ECS: more than " << MAX_COMPONENT_TYPES << " component types" << std::endl;
+        std::abort();
+    }
+    componentInfos()[id] = { size, alignment };
+    return id;
+}
+
+template<typename T>
+uint32_t componentId() {
+    static_assert(std::is_trivially_copyable_v<T>, "ECS components are moved with memcpy");
+    static_assert(alignof(T) <= COLUMN_ALIGNMENT, "component alignment above the column alignment");
+    static const uint32_t id = registerComponentType(sizeof(T), alignof(T));
+    return id;
+}
+
+template<typename... Ts>
+ComponentMask maskOf() {
+    return (ComponentMask(0) | ... | (ComponentMask(1) << componentId<Ts>()));
+}
+
+} // namespace ecs
+
+// all entities with exactly one component set
+class Archetype {
+public:
+    struct Chunk {
+        std::byte* data = nullptr;
+        uint32_t count = 0;
+    };
+
+    explicit Archetype(ComponentMask componentMask) : mask(componentMask) {
+        columnOffset.fill(NO_COLUMN);
+
+        size_t rowBytes = sizeof(Entity);
+        size_t columnCount = 1;
+        for (uint32_t id = 0; id < ecs::MAX_COMPONENT_TYPES; ++id) {
+            if (mask & (ComponentMask(1) << id)) {
+                typeIds.push_back(id);
+                rowBytes += ecs::componentInfos()[id].size;
+                ++columnCount;
+            }
+        }
+
+        // leave room for padding every column up to the alignment
+        size_t usable = ecs::CHUNK_SIZE - columnCount * ecs::COLUMN_ALIGNMENT;
+        capacity = static_cast<uint32_t>(std::max<size_t>(1, usable / rowBytes));
+
+        size_t offset = alignUp(capacity * sizeof(Entity));
+        for (uint32_t id : typeIds) {
+            columnOffset[id] = offset;
+            offset = alignUp(offset + capacity * ecs::componentInfos()[id].size);
+        }
+        chunkBytes = std::max(offset, ecs::CHUNK_SIZE);
+    }
+
+    ~Archetype() {
+        for (Chunk& chunk : chunks) {
+            ::operator delete(chunk.data, std::align_val_t(ecs::COLUMN_ALIGNMENT));
+        }
+    }
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    ComponentMask getMask() const { return mask; }
+    uint32_t getChunkCapacity() const { return capacity; }
+    const std::vector<uint32_t>& getTypeIds() const { return typeIds; }
+    std::vector<Chunk>& getChunks() { return chunks; }
+    size_t getEntityCount() const { return entityCount; }
+
+    bool hasComponent(uint32_t typeId) const { return columnOffset[typeId] != NO_COLUMN; }
+
+    Entity* entities(Chunk& chunk) const {
+        return reinterpret_cast<Entity*>(chunk.data);
+    }
+
+    void* component(uint32_t typeId, Chunk& chunk, uint32_t row) const {
+        return chunk.data + columnOffset[typeId] + row * ecs::componentInfos()[typeId].size;
+    }
+
+    template<typename T>
+    T* column(Chunk& chunk) const {
+        return reinterpret_cast<T*>(chunk.data + columnOffset[ecs::componentId<T>()]);
+    }
+
+    // appends a row at the end, components are left uninitialized
+    void allocateRow(Entity entity, uint32_t& chunkIndex, uint32_t& row) {
+        if (chunks.empty() || chunks.back().count == capacity) {
+            Chunk chunk;
+            chunk.data = static_cast<std::byte*>(::operator new(chunkBytes, std::align_val_t(ecs::COLUMN_ALIGNMENT)));
+            chunks.push_back(chunk);
+        }
+        chunkIndex = static_cast<uint32_t>(chunks.size() - 1);
+        Chunk& chunk = chunks.back();
+        row = chunk.count++;
+        entities(chunk)[row] = entity;
+        ++entityCount;
+    }
+
+    // fills the hole with the last row so chunks stay packed.
+    // returns the entity that moved into the hole (invalid if nothing moved)
+    Entity removeRow(uint32_t chunkIndex, uint32_t row) {
+        Chunk& lastChunk = chunks.back();
+        uint32_t lastRow = lastChunk.count - 1;
+        Entity moved;
+
+        if (chunkIndex != chunks.size() - 1 || row != lastRow) {
+            Chunk& chunk = chunks[chunkIndex];
+            for (uint32_t id : typeIds) {
+                std::memcpy(component(id, chunk, row), component(id, lastChunk, lastRow), ecs::componentInfos()[id].size);
+            }
+            moved = entities(lastChunk)[lastRow];
+            entities(chunk)[row] = moved;
+        }
+
+        --entityCount;
+        if (--lastChunk.count == 0) {
+            ::operator delete(lastChunk.data, std::align_val_t(ecs::COLUMN_ALIGNMENT));
+            chunks.pop_back();
+        }
+        return moved;
+    }
+
+private:
+    static constexpr size_t NO_COLUMN = ~size_t(0);
+
+    ComponentMask mask;
+    std::vector<uint32_t> typeIds;
+    std::array<size_t, ecs::MAX_COMPONENT_TYPES> columnOffset;
+    uint32_t capacity = 0;
+    size_t chunkBytes = 0;
+    size_t entityCount = 0;
+    std::vector<Chunk> chunks;
+
+    static size_t alignUp(size_t value) {
+        return (value + ecs::COLUMN_ALIGNMENT - 1) & ~(ecs::COLUMN_ALIGNMENT - 1);
+    }
+};
+
+class EntityWorld {
+public:
+    EntityWorld() = default;
+    EntityWorld(const EntityWorld&) = delete;
+    EntityWorld& operator=(const EntityWorld&) = delete;
+
+    template<typename... Ts>
+    Entity create(const Ts&... components) {
+        Entity entity = records.insert({});
+        EntityRecord& record = *records.get(entity);
+        record.archetype = &archetypeFor(ecs::maskOf<Ts...>());
+        record.archetype->allocateRow(entity, record.chunk, record.row);
+        (writeComponent(record, components), ...);
+        return entity;
+    }
+
+    void destroy(Entity entity) {
+        EntityRecord* record = records.get(entity);
+        if (!record) return;
+        detachRow(*record);
+        records.remove(entity);
+    }
+
+    bool isAlive(Entity entity) const { return records.contains(entity); }
+    size_t size() const { return records.size(); }
+
+    template<typename T>
+    T* get(Entity entity) {
+        EntityRecord* record = records.get(entity);
+        uint32_t id = ecs::componentId<T>();
+        if (!record || !record->archetype->hasComponent(id)) return nullptr;
+        return static_cast<T*>(record->archetype->component(id, record->archetype->getChunks()[record->chunk], record->row));
+    }
+
+    template<typename T>
+    bool has(Entity entity) {
+        return get<T>(entity) != nullptr;
+    }
+
+    // adds the component or overwrites the existing one
+    template<typename T>
+    void add(Entity entity, const T& component = T{}) {
+        EntityRecord* record = records.get(entity);
+        if (!record) return;
+        if (!record->archetype->hasComponent(ecs::componentId<T>())) {
+            moveTo(entity, *record, record->archetype->getMask() | ecs::maskOf<T>());
+        }
+        writeComponent(*record, component);
+    }
+
+    template<typename T>
+    void remove(Entity entity) {
+        EntityRecord* record = records.get(entity);
+        if (!record || !record->archetype->hasComponent(ecs::componentId<T>())) return;
+        moveTo(entity, *record, record->archetype->getMask() & ~ecs::maskOf<T>());
+    }
+
+    // fn(count, entities, Ts* arrays...) once per matching chunk
+    template<typename... Ts, typename Fn>
+    void eachChunk(Fn&& fn, ComponentMask exclude = 0) {
+        ComponentMask required = ecs::maskOf<Ts...>();
+        for (Archetype* archetype : archetypeList) {
+            if (!matches(*archetype, required, exclude)) continue;
+            for (Archetype::Chunk& chunk : archetype->getChunks()) {
+                fn(static_cast<size_t>(chunk.count), archetype->entities(chunk), archetype->column<Ts>(chunk)...);
+            }
+        }
+    }
+
+    // same thing with the chunks spread over the job system, fn has to be thread safe
+    template<typename... Ts, typename Fn>
+    void parallelEachChunk(Fn&& fn, ComponentMask exclude = 0) {
+        ComponentMask required = ecs::maskOf<Ts...>();
+        chunkScratch.clear();
+        for (Archetype* archetype : archetypeList) {
+            if (!matches(*archetype, required, exclude)) continue;
+            for (Archetype::Chunk& chunk : archetype->getChunks()) {
+                chunkScratch.push_back({ archetype, &chunk });
+            }
+        }
+
+        JobSystem::getInstance().parallelFor(chunkScratch.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                Archetype* archetype = chunkScratch[i].archetype;
+                Archetype::Chunk& chunk = *chunkScratch[i].chunk;
+                fn(static_cast<size_t>(chunk.count), archetype->entities(chunk), archetype->column<Ts>(chunk)...);
+            }
+        });
+    }
+
+    // fn(entity, Ts&...) for every matching entity
+    template<typename... Ts, typename Fn>
+    void each(Fn&& fn, ComponentMask exclude = 0) {
+        eachChunk<Ts...>([&](size_t count, const Entity* entities, Ts*... columns) {
+            for (size_t i = 0; i < count; ++i) {
+                fn(entities[i], columns[i]...);
+            }
+        }, exclude);
+    }
+
+    void clear() {
+        records.clear();
+        archetypes.clear();
+        archetypeList.clear();
+    }
+
+    size_t getArchetypeCount() const { return archetypeList.size(); }
+
+private:
+    struct EntityRecord {
+        Archetype* archetype = nullptr;
+        uint32_t chunk = 0;
+        uint32_t row = 0;
+    };
+
+    struct ChunkRef {
+        Archetype* archetype;
+        Archetype::Chunk* chunk;
+    };
+
+    SlotMap<EntityRecord> records;
+    std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> archetypes;
+    std::vector<Archetype*> archetypeList;   // creation order, what queries walk
+    std::vector<ChunkRef> chunkScratch;
+
+    static bool matches(const Archetype& archetype, ComponentMask required, ComponentMask exclude) {
+        ComponentMask mask = archetype.getMask();
+        return (mask & required) == required && (mask & exclude) == 0 && archetype.getEntityCount() > 0;
+    }
+
+    Archetype& archetypeFor(ComponentMask mask) {
+        auto& slot = archetypes[mask];
+        if (!slot) {
+            slot = std::make_unique<Archetype>(mask);
+            archetypeList.push_back(slot.get());
+        }
+        return *slot;
+    }
+
+    template<typename T>
+    void writeComponent(EntityRecord& record, const T& component) {
+        Archetype::Chunk& chunk = record.archetype->getChunks()[record.chunk];
+        std::memcpy(record.archetype->component(ecs::componentId<T>(), chunk, record.row), &component, sizeof(T));
+    }
+
+    // takes the row out of its archetype and fixes up whoever got moved into the hole
+    void detachRow(const EntityRecord& record) {
+        Entity moved = record.archetype->removeRow(record.chunk, record.row);
+        if (moved.isValid()) {
+            EntityRecord* movedRecord = records.get(moved);
+            movedRecord->chunk = record.chunk;
+            movedRecord->row = record.row;
+        }
+    }
+
+    void moveTo(Entity entity, EntityRecord& record, ComponentMask newMask) {
+        Archetype& target = archetypeFor(newMask);
+        uint32_t chunkIndex, row;
+        target.allocateRow(entity, chunkIndex, row);
+
+        Archetype::Chunk& from = record.archetype->getChunks()[record.chunk];
+        Archetype::Chunk& to = target.getChunks()[chunkIndex];
+        for (uint32_t id : target.getTypeIds()) {
+            if (record.archetype->hasComponent(id)) {
+                std::memcpy(target.component(id, to, row), record.archetype->component(id, from, record.row),
+                    ecs::componentInfos()[id].size);
+            }
+        }
+
+        EntityRecord old = record;
+        record.archetype = &target;
+        record.chunk = chunkIndex;
+        record.row = row;
+        detachRow(old);
+    }
+};
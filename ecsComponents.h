@@ -0,0 +1,95 @@
+// ecsComponents.h
+#pragma once
+#include "GameEngine.h"
+#include "object3D.h"
+#include "animation.h"
+#include "ecs.h"
+#include <PxPhysicsAPI.h>
+
+// plain data versions of what Node, Light, PhysXBody and the animation system carry.
+// no owning pointers in here, meshes/actions/actors are owned by whoever created them
+
+struct TransformComponent {
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+    glm::mat4 world = glm::mat4(1.0f);
+    uint8_t dirty = 1;   // TRS changed since world was last built
+};
+
+struct RenderableComponent {
+    Mesh* mesh = nullptr;
+    Material* material = nullptr;   // slot 0 override like Node::material, null = the mesh's own
+    glm::vec3 boundsCenter = glm::vec3(0.0f);  // local space bounding sphere
+    float boundsRadius = 0.0f;
+    uint8_t visible = 1;
+    uint8_t castsShadows = 1;
+    uint8_t transparent = 0;
+};
+
+struct LightComponent {
+    NodeType type = NodeType::PointLight;
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+    glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    float radius = 10.0f;
+    float constant = 1.0f;
+    float linear = 0.09f;
+    float quadratic = 0.032f;
+    float innerCutoff = 0.0f;
+    float outerCutoff = 0.0f;
+};
+
+struct RigidBodyComponent {
+    physx::PxRigidActor* actor = nullptr;
+    uint8_t isStatic = 0;
+};
+
+struct AnimationComponent {
+    const Action* action = nullptr;
+    float time = 0.0f;
+    float speed = 1.0f;
+    float weight = 1.0f;
+    uint8_t playing = 1;
+    uint8_t loop = 1;
+};
+
+// entity mirrors this node (see NodeEntityBridge), node code stays the owner
+struct NodeLinkComponent {
+    Node* node = nullptr;
+};
+
+inline TransformComponent makeTransformComponent(const Node& node) {
+    TransformComponent transform;
+    transform.translation = node.localTranslation;
+    transform.rotation = node.localRotation;
+    transform.scale = node.localScale;
+    transform.world = node.worldTransform;
+    transform.dirty = 0;
+    return transform;
+}
+
+inline RenderableComponent makeRenderableComponent(Mesh* mesh) {
+    RenderableComponent renderable;
+    renderable.mesh = mesh;
+    if (!mesh || mesh->positions.empty()) return renderable;
+
+    glm::vec3 minP = mesh->positions[0];
+    glm::vec3 maxP = mesh->positions[0];
+    for (const auto& p : mesh->positions) {
+        minP = glm::min(minP, p);
+        maxP = glm::max(maxP, p);
+    }
+    renderable.boundsCenter = (minP + maxP) * 0.5f;
+    for (const auto& p : mesh->positions) {
+        renderable.boundsRadius = std::max(renderable.boundsRadius, glm::length(p - renderable.boundsCenter));
+    }
+
+    for (const auto& material : mesh->materials) {
+        if (material && material->alpha < 1.0f) {
+            renderable.transparent = 1;
+            break;
+        }
+    }
+    return renderable;
+}
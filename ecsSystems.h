@@ -0,0 +1,155 @@
+// ecsSystems.h
+#pragma once
+#include "ecsComponents.h"
+#include "shadowRenderer.h"
+#include "frameArena.h"
+#include <functional>
+#include <unordered_map>
+
+// per frame passes over the entity chunks. entities linked to a Node are skipped by
+// physics/animation/transform passes, the node side (PhysXWorld, AnimationSystem,
+// TransformHierarchy) already drives those and the bridge copies the result over
+namespace ecs {
+
+// dynamic actor poses -> transforms, call after PhysXManager::simulate
+inline void syncPhysics(EntityWorld& world) {
+    world.eachChunk<RigidBodyComponent, TransformComponent>(
+        [](size_t count, const Entity*, RigidBodyComponent* bodies, TransformComponent* transforms) {
+            for (size_t i = 0; i < count; ++i) {
+                if (!bodies[i].actor || bodies[i].isStatic) continue;
+                physx::PxTransform pose = bodies[i].actor->getGlobalPose();
+                transforms[i].translation = glm::vec3(pose.p.x, pose.p.y, pose.p.z);
+                transforms[i].rotation = glm::quat(pose.q.w, pose.q.x, pose.q.y, pose.q.z);
+                transforms[i].dirty = 1;
+            }
+        }, maskOf<NodeLinkComponent>());
+}
+
+inline void updateAnimations(EntityWorld& world, float deltaTime) {
+    world.eachChunk<AnimationComponent, TransformComponent>(
+        [deltaTime](size_t count, const Entity*, AnimationComponent* animations, TransformComponent* transforms) {
+            for (size_t i = 0; i < count; ++i) {
+                AnimationComponent& anim = animations[i];
+                if (!anim.playing || !anim.action || anim.action->duration <= 0.0f) continue;
+
+                anim.time += deltaTime * anim.speed;
+                if (anim.time > anim.action->duration) {
+                    if (anim.loop) {
+                        anim.time = fmod(anim.time, anim.action->duration);
+                    }
+                    else {
+                        anim.time = anim.action->duration;
+                        anim.playing = 0;
+                    }
+                }
+
+                TransformComponent& transform = transforms[i];
+                for (const auto& channel : anim.action->channels) {
+                    glm::vec3 position = transform.translation;
+                    glm::quat rotation = transform.rotation;
+                    glm::vec3 scale = transform.scale;
+                    channel.evaluate(anim.time, position, rotation, scale);
+
+                    transform.translation = glm::mix(transform.translation, position, anim.weight);
+                    transform.rotation = glm::slerp(transform.rotation, rotation, anim.weight);
+                    transform.scale = glm::mix(transform.scale, scale, anim.weight);
+                }
+                transform.dirty = 1;
+            }
+        }, maskOf<NodeLinkComponent>());
+}
+
+// TRS -> world for free standing entities, chunks go wide over the job system
+inline void updateTransforms(EntityWorld& world) {
+    world.parallelEachChunk<TransformComponent>([](size_t count, const Entity*, TransformComponent* transforms) {
+        for (size_t i = 0; i < count; ++i) {
+            TransformComponent& t = transforms[i];
+            if (!t.dirty) continue;
+            t.world = glm::scale(glm::translate(glm::mat4(1.0f), t.translation) * glm::mat4_cast(t.rotation), t.scale);
+            t.dirty = 0;
+        }
+    }, maskOf<NodeLinkComponent>());
+}
+
+// draw list for entities that aren't nodes (nodes go through Scene::render as before).
+// isVisible gets the world space bounding sphere, leave it empty to skip culling
+inline void gatherRenderables(EntityWorld& world, FrameVector<RenderItem>& opaque, FrameVector<RenderItem>& transparent,
+    const std::function<bool(const glm::vec3&, float)>& isVisible = nullptr) {
+    world.eachChunk<TransformComponent, RenderableComponent>(
+        [&](size_t count, const Entity*, TransformComponent* transforms, RenderableComponent* renderables) {
+            for (size_t i = 0; i < count; ++i) {
+                const RenderableComponent& r = renderables[i];
+                if (!r.mesh || !r.visible) continue;
+
+                const glm::mat4& model = transforms[i].world;
+                if (isVisible) {
+                    glm::vec3 center = glm::vec3(model * glm::vec4(r.boundsCenter, 1.0f));
+                    float maxScale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])),
+                        glm::length(glm::vec3(model[2])) });
+                    if (!isVisible(center, r.boundsRadius * maxScale)) continue;
+                }
+
+                (r.transparent ? transparent : opaque).push_back({ r.mesh, model, r.castsShadows != 0, r.material });
+            }
+        }, maskOf<NodeLinkComponent>());
+}
+
+} // namespace ecs
+
+// compatibility layer: mirrors existing nodes as entities so chunk queries can find
+// them without porting node code. nothing renders, culls or simulates them through the
+// chunks yet, the node stays authoritative and pullTransforms copies moved matrices over
+class NodeEntityBridge {
+public:
+    explicit NodeEntityBridge(EntityWorld& entityWorld) : world(entityWorld) {}
+
+    NodeEntityBridge(const NodeEntityBridge&) = delete;
+    NodeEntityBridge& operator=(const NodeEntityBridge&) = delete;
+
+    // transform + back pointer only. renderable, light and body copies would go stale,
+    // add them once a system actually reads linked entities
+    Entity link(const std::shared_ptr<Node>& node) {
+        if (!node) return Entity();
+        auto it = entityByNode.find(node.get());
+        if (it != entityByNode.end()) return it->second.entity;
+
+        Entity entity = world.create(makeTransformComponent(*node), NodeLinkComponent{ node.get() });
+        entityByNode[node.get()] = { entity, node };
+        return entity;
+    }
+
+    void unlink(const Node* node) {
+        auto it = entityByNode.find(node);
+        if (it == entityByNode.end()) return;
+        world.destroy(it->second.entity);
+        entityByNode.erase(it);
+    }
+
+    Entity entityFor(const Node* node) const {
+        auto it = entityByNode.find(node);
+        return it != entityByNode.end() ? it->second.entity : Entity();
+    }
+
+    // after the transform pass, only nodes whose world matrix changed are copied
+    void pullTransforms(const std::vector<Node*>& changedNodes) {
+        if (entityByNode.empty()) return;
+        for (Node* node : changedNodes) {
+            auto it = entityByNode.find(node);
+            if (it == entityByNode.end()) continue;
+            if (TransformComponent* transform = world.get<TransformComponent>(it->second.entity)) {
+                *transform = makeTransformComponent(*node);
+            }
+        }
+    }
+
+    size_t getLinkedCount() const { return entityByNode.size(); }
+
+private:
+    struct Link {
+        Entity entity;
+        std::shared_ptr<Node> node;  // keeps NodeLinkComponent::node valid
+    };
+
+    EntityWorld& world;
+    std::unordered_map<const Node*, Link> entityByNode;
+};
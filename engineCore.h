@@ -1,6 +1,7 @@
 // EngineCore.h
 #pragma once
 #include "GameEngine.h"
+#include "glState.h"
 #include "scene.h"
 #include "ui.h"
 #include "console.h"
@@ -60,6 +61,10 @@ public:
             return false;
         }
 
+#ifndef NDEBUG
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
+
         // Create window
         window = glfwCreateWindow(screenWidth, screenHeight, "Game Engine", NULL, NULL);
         if (!window) {
@@ -73,6 +78,7 @@ public:
         if (glewInit() != GLEW_OK) {
             return false;
         }
+        installGLDebugOutput();
 
         // Initialize subsystems
         initializeSubsystems();
@@ -41,13 +41,13 @@ public:
     }
 
     void setupRenderingMesh() {
-        fluidMesh = std::make_shared<Mesh>();
+        fluidMesh = makePooled<Mesh, pools::Meshes>();
 
         // Create initial mesh (can be updated based on fluid surface)
         updateMeshGeometry();
 
-        // Setup OpenGL buffers
-        fluidMesh->setupBuffers();
+        // GPU buffers get created at the next upload flush
+        fluidMesh->markForUpload();
     }
 
     void simulate() {
@@ -201,8 +201,8 @@ private:
         fluidMesh->normals = normals;
         fluidMesh->indices = indices;
 
-        // Update GPU buffers
-        fluidMesh->setupBuffers();
+        // re-uploaded at the next flush
+        fluidMesh->markForUpload();
     }
 
     void addCubeToMesh(int i, int j, int k) {
@@ -4,6 +4,7 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include "GameEngine.h"
+#include "glState.h"
 
 
 // Define global variables
@@ -36,7 +37,7 @@ void initFreeType(const char* fontPath) {
         // Generate texture
         unsigned int texture;
         glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, texture);
         glTexImage2D(
             GL_TEXTURE_2D,
             0,
@@ -62,7 +63,7 @@ void initFreeType(const char* fontPath) {
         };
         Characters.insert(std::pair<char, Character>(c, character));
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
     // Destroy FreeType once we're finished
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
@@ -70,21 +71,22 @@ void initFreeType(const char* fontPath) {
     // Configure VAO/VBO for texture quads
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
+    GLStateCache::getInstance().bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLStateCache::getInstance().bindVertexArray(0);
 }
 
 void renderText(unsigned int shaderProgram, std::string text, float x, float y, float scale, glm::vec3 color) {
+    GLStateCache& gl = GLStateCache::getInstance();
     // Activate corresponding render state
-    glUseProgram(shaderProgram);
+    gl.useProgram(shaderProgram);
     glUniform3f(glGetUniformLocation(shaderProgram, "textColor"), color.x, color.y, color.z);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
+    gl.activeTexture(GL_TEXTURE0);
+    gl.bindVertexArray(VAO);
 
     // Iterate through all characters
     std::string::const_iterator c;
@@ -107,7 +109,7 @@ void renderText(unsigned int shaderProgram, std::string text, float x, float y,
             { xpos + w, ypos + h,   1.0f, 0.0f }
         };
         // Render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+        gl.bindTexture(GL_TEXTURE_2D, ch.TextureID);
         // Update content of VBO memory
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
@@ -117,6 +119,6 @@ void renderText(unsigned int shaderProgram, std::string text, float x, float y,
         // Advance cursors for next glyph (advance is number of 1/64 pixels)
         x += (ch.Advance >> 6) * scale; // Bitshift by 6 to get value in pixels (2^6 = 64)
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    gl.bindVertexArray(0);
+    gl.bindTexture(GL_TEXTURE_2D, 0);
 }
\ No newline at end of file
@@ -0,0 +1,204 @@
+// forceField.h
+#pragma once
+#include "GameEngine.h"
+#include "PhysXManager.h"
+#include <PxPhysicsAPI.h>
+#include <glm/gtc/quaternion.hpp>
+
+using namespace physx;
+
+// explosions, wind, attractors. a field gathers the dynamic actors inside its region
+// with a single scene overlap query and pushes all of them in one pass, instead of
+// walking physicsWorld.bodies and distance testing each one.
+// 2D bodies share the PhysX scene, their locked Z axis just gets dropped from the push
+
+enum class ForceFieldShape {
+    Sphere,
+    Box,
+    Unbounded   // every dynamic actor in the scene (global wind)
+};
+
+enum class ForceFieldType {
+    Radial,      // away from the center, negative strength attracts
+    Directional  // along direction (wind, conveyor, updraft)
+};
+
+enum class ForceFieldFalloff {
+    None,
+    Linear,
+    InverseSquare
+};
+
+struct ForceField {
+    ForceFieldShape shape = ForceFieldShape::Sphere;
+    ForceFieldType type = ForceFieldType::Radial;
+    ForceFieldFalloff falloff = ForceFieldFalloff::Linear;
+
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 5.0f;                          // sphere
+    glm::vec3 halfExtents = glm::vec3(5.0f);      // box
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 direction = glm::vec3(1.0f, 0.0f, 0.0f);
+
+    float strength = 10.0f;
+    bool ignoreMass = false;   // true: same velocity change for every body regardless of mass
+
+    // < 0 stays until removed, otherwise seconds left (persistent fields only)
+    float duration = -1.0f;
+};
+
+class ForceFieldSystem {
+public:
+    // upper bound on shapes one query can report, extra touches are dropped
+    size_t maxTouches = 4096;
+
+    // persistent fields push every step as a continuous force
+    uint32_t addField(const ForceField& field) {
+        uint32_t id = nextId++;
+        fields.push_back({ id, field });
+        return id;
+    }
+
+    void removeField(uint32_t id) {
+        fields.erase(std::remove_if(fields.begin(), fields.end(),
+            [id](const ActiveField& f) { return f.id == id; }), fields.end());
+    }
+
+    void clear() {
+        fields.clear();
+    }
+
+    size_t getFieldCount() const { return fields.size(); }
+
+    // one shot impulse, returns how many actors were pushed
+    size_t applyImpulse(const ForceField& field) {
+        gatherActors(field);
+        return applyToGathered(field, field.ignoreMass ? PxForceMode::eVELOCITY_CHANGE : PxForceMode::eIMPULSE);
+    }
+
+    size_t explode(const glm::vec3& center, float radius, float impulse) {
+        ForceField field;
+        field.shape = ForceFieldShape::Sphere;
+        field.type = ForceFieldType::Radial;
+        field.center = center;
+        field.radius = radius;
+        field.strength = impulse;
+        return applyImpulse(field);
+    }
+
+    // call before PxScene::simulate, the forces get integrated over the step
+    void update(float deltaTime) {
+        for (auto& active : fields) {
+            gatherActors(active.field);
+            applyToGathered(active.field, active.field.ignoreMass ? PxForceMode::eACCELERATION : PxForceMode::eFORCE);
+
+            if (active.field.duration > 0.0f) {
+                active.field.duration = std::max(0.0f, active.field.duration - deltaTime);
+            }
+        }
+
+        fields.erase(std::remove_if(fields.begin(), fields.end(),
+            [](const ActiveField& f) { return f.field.duration == 0.0f; }), fields.end());
+    }
+
+private:
+    struct ActiveField {
+        uint32_t id;
+        ForceField field;
+    };
+
+    std::vector<ActiveField> fields;
+    uint32_t nextId = 1;
+
+    // reused between queries so gathering doesn't allocate
+    std::vector<PxOverlapHit> touchBuffer;
+    std::vector<PxRigidDynamic*> gathered;
+    std::vector<PxActor*> actorBuffer;
+
+    void gatherActors(const ForceField& field) {
+        gathered.clear();
+        PxScene* pxScene = PhysXManager::getInstance().getScene();
+        if (!pxScene) return;
+
+        if (field.shape == ForceFieldShape::Unbounded) {
+            PxU32 count = pxScene->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC);
+            actorBuffer.resize(count);
+            pxScene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC, actorBuffer.data(), count);
+            for (PxActor* actor : actorBuffer) {
+                gathered.push_back(static_cast<PxRigidDynamic*>(actor));
+            }
+            return;
+        }
+
+        touchBuffer.resize(maxTouches);
+        PxOverlapBuffer hits(touchBuffer.data(), static_cast<PxU32>(touchBuffer.size()));
+        // touching hits only, we want everything in the region
+        PxQueryFilterData filter(PxQueryFlag::eDYNAMIC | PxQueryFlag::eNO_BLOCK);
+        PxTransform pose(PxVec3(field.center.x, field.center.y, field.center.z),
+            PxQuat(field.rotation.x, field.rotation.y, field.rotation.z, field.rotation.w));
+
+        if (field.shape == ForceFieldShape::Sphere) {
+            pxScene->overlap(PxSphereGeometry(field.radius), pose, hits, filter);
+        }
+        else {
+            pxScene->overlap(PxBoxGeometry(field.halfExtents.x, field.halfExtents.y, field.halfExtents.z), pose, hits, filter);
+        }
+
+        for (PxU32 i = 0; i < hits.getNbTouches(); ++i) {
+            if (PxRigidDynamic* dynamicActor = hits.getTouch(i).actor->is<PxRigidDynamic>()) {
+                gathered.push_back(dynamicActor);
+            }
+        }
+
+        // compound bodies report one touch per shape
+        std::sort(gathered.begin(), gathered.end());
+        gathered.erase(std::unique(gathered.begin(), gathered.end()), gathered.end());
+    }
+
+    size_t applyToGathered(const ForceField& field, PxForceMode::Enum mode) {
+        glm::vec3 direction = glm::length(field.direction) > 0.0f ? glm::normalize(field.direction) : glm::vec3(0.0f);
+        float extent = field.shape == ForceFieldShape::Box ? glm::length(field.halfExtents) : field.radius;
+
+        size_t applied = 0;
+        for (PxRigidDynamic* actor : gathered) {
+            if (actor->getRigidBodyFlags() & PxRigidBodyFlag::eKINEMATIC) continue;
+
+            PxVec3 com = actor->getGlobalPose().transform(actor->getCMassLocalPose().p);
+            glm::vec3 toBody = glm::vec3(com.x, com.y, com.z) - field.center;
+            float distance = glm::length(toBody);
+
+            float scale = 1.0f;
+            if (field.shape != ForceFieldShape::Unbounded) {
+                switch (field.falloff) {
+                case ForceFieldFalloff::Linear:
+                    scale = std::max(0.0f, 1.0f - distance / std::max(extent, 1e-4f));
+                    break;
+                case ForceFieldFalloff::InverseSquare:
+                    scale = 1.0f / std::max(distance * distance, 1.0f);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            glm::vec3 push;
+            if (field.type == ForceFieldType::Radial) {
+                push = distance > 1e-4f ? toBody / distance : glm::vec3(0.0f, 1.0f, 0.0f);
+            }
+            else {
+                push = direction;
+            }
+            push *= field.strength * scale;
+
+            // 2D bodies can't move along Z, don't waste the push on it
+            if (actor->getRigidDynamicLockFlags() & PxRigidDynamicLockFlag::eLOCK_LINEAR_Z) {
+                push.z = 0.0f;
+            }
+
+            if (glm::dot(push, push) <= 0.0f) continue;
+            actor->addForce(PxVec3(push.x, push.y, push.z), mode);
+            ++applied;
+        }
+        return applied;
+    }
+};
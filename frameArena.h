@@ -0,0 +1,154 @@
+// frameArena.h
+#pragma once
+#include <algorithm>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// linear allocator for stuff that only lives for one frame (draw lists, uniform names).
+// allocating is a pointer bump, freeing does nothing, reset() at the end of the frame
+// drops everything at once. when a frame doesn't fit, extra blocks get chained on and
+// the next reset replaces them with one block big enough for the peak.
+// main thread only, nothing from it may be kept past reset()
+class FrameArena {
+private:
+    inline static FrameArena* instance;
+
+    struct Block {
+        std::unique_ptr<uint8_t[]> memory;
+        size_t size = 0;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;     // block being bumped
+    size_t offset = 0;      // into blocks[current]
+    size_t usedBytes = 0;   // this frame, across blocks
+    size_t peakBytes = 0;
+    size_t allocationCount = 0;
+
+    static constexpr size_t DEFAULT_CAPACITY = size_t(1) << 20;
+
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY) {
+        addBlock(capacity);
+    }
+
+    void addBlock(size_t size) {
+        blocks.push_back({ std::make_unique<uint8_t[]>(size), size });
+    }
+
+public:
+    static FrameArena& getInstance() {
+        if (instance == nullptr) {
+            instance = new FrameArena();
+        }
+        return *instance;
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        if (size == 0) size = 1;
+        ++allocationCount;
+
+        while (true) {
+            Block& block = blocks[current];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+            size_t aligned = ((base + offset + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+            if (aligned + size <= block.size) {
+                offset = aligned + size;
+                usedBytes += size;
+                return block.memory.get() + aligned;
+            }
+
+            // overflow, grab the next block (or chain a new one)
+            ++current;
+            offset = 0;
+            if (current == blocks.size()) {
+                addBlock(std::max(block.size * 2, size + alignment));
+            }
+        }
+    }
+
+    template<typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // printf into arena memory, for uniform names and such
+    const char* format(const char* fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        va_list argsCopy;
+        va_copy(argsCopy, args);
+        int length = std::vsnprintf(nullptr, 0, fmt, argsCopy);
+        va_end(argsCopy);
+
+        char* text = allocateArray<char>(length > 0 ? length + 1 : 1);
+        if (length > 0) {
+            std::vsnprintf(text, length + 1, fmt, args);
+        }
+        else {
+            text[0] = '\0';
+        }
+        va_end(args);
+        return text;
+    }
+
+    void reset() {
+        peakBytes = std::max(peakBytes, usedBytes);
+
+        // last frame spilled over, one block that fits it next time
+        if (blocks.size() > 1) {
+            size_t total = 0;
+            for (const auto& block : blocks) total += block.size;
+            blocks.clear();
+            addBlock(total);
+        }
+
+        current = 0;
+        offset = 0;
+        usedBytes = 0;
+        allocationCount = 0;
+    }
+
+    size_t getUsedBytes() const { return usedBytes; }
+    size_t getPeakBytes() const { return std::max(peakBytes, usedBytes); }
+    size_t getCapacity() const {
+        size_t total = 0;
+        for (const auto& block : blocks) total += block.size;
+        return total;
+    }
+    size_t getAllocationCount() const { return allocationCount; }
+};
+
+// std allocator on top of the frame arena, deallocate is a no-op
+template<typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() noexcept = default;
+    template<typename U>
+    FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count) {
+        return FrameArena::getInstance().allocateArray<T>(count);
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    template<typename U>
+    bool operator==(const FrameAllocator<U>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const FrameAllocator<U>&) const noexcept { return false; }
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
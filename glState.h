@@ -0,0 +1,207 @@
+// glState.h
+#pragma once
+#include "GameEngine.h"
+#include <array>
+#include <cstdint>
+
+// shadow copy of the GL state the renderers flip all the time (program, VAO, textures
+// per unit, blend/depth). calls that wouldn't change anything never reach the driver, and
+// code that needs the current value asks here instead of glGet, which syncs the pipeline.
+// only works if everything goes through it: anything that talks to GL behind its back
+// (imgui restores what it touched, but still) calls invalidate(). GL thread only
+class GLStateCache {
+public:
+    static constexpr GLuint MAX_TEXTURE_UNITS = 32;
+
+    // never a valid name or enum, what the getters return after invalidate()
+    static constexpr GLuint UNKNOWN = 0xFFFFFFFFu;
+
+    static GLStateCache& getInstance() {
+        static GLStateCache* cache = new GLStateCache();
+        return *cache;
+    }
+
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+
+    void useProgram(GLuint program) {
+        if (program == this->program) {
+            ++skipped;
+            return;
+        }
+        glUseProgram(program);
+        this->program = program;
+        ++issued;
+    }
+
+    void bindVertexArray(GLuint vao) {
+        if (vao == vertexArray) {
+            ++skipped;
+            return;
+        }
+        glBindVertexArray(vao);
+        vertexArray = vao;
+        ++issued;
+    }
+
+    // GL_TEXTURE0 + unit, like glActiveTexture
+    void activeTexture(GLenum unit) {
+        if (unit == activeUnit) {
+            ++skipped;
+            return;
+        }
+        glActiveTexture(unit);
+        activeUnit = unit;
+        ++issued;
+    }
+
+    // binds to the active unit, like glBindTexture. targets we don't track always go through
+    void bindTexture(GLenum target, GLuint texture) {
+        GLuint* slot = textureSlot(activeUnit, target);
+        if (slot && *slot == texture) {
+            ++skipped;
+            return;
+        }
+        glBindTexture(target, texture);
+        if (slot) *slot = texture;
+        ++issued;
+    }
+
+    // GL_BLEND, GL_DEPTH_TEST and GL_CULL_FACE are tracked, the rest go straight through
+    void enable(GLenum cap) { setCapability(cap, true); }
+    void disable(GLenum cap) { setCapability(cap, false); }
+
+    void blendFunc(GLenum source, GLenum destination) {
+        if (source == blendSource && destination == blendDestination) {
+            ++skipped;
+            return;
+        }
+        glBlendFunc(source, destination);
+        blendSource = source;
+        blendDestination = destination;
+        ++issued;
+    }
+
+    void depthMask(GLboolean flag) {
+        int8_t value = flag ? 1 : 0;
+        if (value == depthWrite) {
+            ++skipped;
+            return;
+        }
+        glDepthMask(flag);
+        depthWrite = value;
+        ++issued;
+    }
+
+    void depthFunc(GLenum func) {
+        if (func == depthCompare) {
+            ++skipped;
+            return;
+        }
+        glDepthFunc(func);
+        depthCompare = func;
+        ++issued;
+    }
+
+    // deleted names get unbound by GL and can come back from glGen*, so they must not
+    // stay in the cache
+    void deleteTextures(GLsizei count, const GLuint* textures) {
+        for (GLsizei i = 0; i < count; ++i) {
+            if (textures[i] == 0) continue;
+            for (auto& unit : units) {
+                for (GLuint& bound : unit) {
+                    if (bound == textures[i]) bound = 0;
+                }
+            }
+        }
+        glDeleteTextures(count, textures);
+    }
+
+    void deleteVertexArrays(GLsizei count, const GLuint* arrays) {
+        for (GLsizei i = 0; i < count; ++i) {
+            if (arrays[i] != 0 && arrays[i] == vertexArray) vertexArray = 0;
+        }
+        glDeleteVertexArrays(count, arrays);
+    }
+
+    // current values, without a glGet
+    GLuint getProgram() const { return program; }
+    GLenum getActiveTexture() const { return activeUnit; }
+
+    // forget everything, the next call of each kind goes to GL
+    void invalidate() {
+        program = UNKNOWN;
+        vertexArray = UNKNOWN;
+        activeUnit = UNKNOWN;
+        for (auto& unit : units) unit.fill(UNKNOWN);
+        blend = depthTest = cullFace = depthWrite = -1;
+        blendSource = blendDestination = depthCompare = UNKNOWN;
+    }
+
+    // calls that reached the driver / were dropped, since the last reset
+    size_t getIssuedCount() const { return issued; }
+    size_t getSkippedCount() const { return skipped; }
+    void resetStats() { issued = skipped = 0; }
+
+private:
+    enum TextureTarget { TARGET_2D, TARGET_2D_ARRAY, TARGET_CUBE_MAP, TARGET_COUNT };
+
+    GLuint program = UNKNOWN;
+    GLuint vertexArray = UNKNOWN;
+    GLenum activeUnit = UNKNOWN;
+    std::array<std::array<GLuint, TARGET_COUNT>, MAX_TEXTURE_UNITS> units;
+    int8_t blend = -1, depthTest = -1, cullFace = -1, depthWrite = -1;    // -1 unknown
+    GLenum blendSource = UNKNOWN, blendDestination = UNKNOWN;
+    GLenum depthCompare = UNKNOWN;
+
+    size_t issued = 0;
+    size_t skipped = 0;
+
+    GLStateCache() { invalidate(); }
+
+    GLuint* textureSlot(GLenum unit, GLenum target) {
+        if (unit < GL_TEXTURE0 || unit >= GL_TEXTURE0 + MAX_TEXTURE_UNITS) return nullptr;
+        auto& slots = units[unit - GL_TEXTURE0];
+        switch (target) {
+        case GL_TEXTURE_2D: return &slots[TARGET_2D];
+        case GL_TEXTURE_2D_ARRAY: return &slots[TARGET_2D_ARRAY];
+        case GL_TEXTURE_CUBE_MAP: return &slots[TARGET_CUBE_MAP];
+        default: return nullptr;
+        }
+    }
+
+    void setCapability(GLenum cap, bool on) {
+        int8_t* state = cap == GL_BLEND ? &blend : cap == GL_DEPTH_TEST ? &depthTest :
+            cap == GL_CULL_FACE ? &cullFace : nullptr;
+        if (state && *state == (on ? 1 : 0)) {
+            ++skipped;
+            return;
+        }
+        if (on) glEnable(cap);
+        else glDisable(cap);
+        if (state) *state = on ? 1 : 0;
+        ++issued;
+    }
+};
+
+#ifndef NDEBUG
+inline void GLAPIENTRY glDebugOutput(GLenum, GLenum, GLuint id, GLenum severity,
+    GLsizei, const GLchar* message, const void*) {
+    std::cout << "GL debug (" << id << ", severity " << severity << "): " << message << std::endl;
+}
+#endif
+
+// debug builds report GL errors through KHR_debug as they happen, instead of every draw
+// draining glGetError. call right after glewInit, the window needs GLFW_OPENGL_DEBUG_CONTEXT
+inline void installGLDebugOutput() {
+#ifndef NDEBUG
+    if (!GLEW_KHR_debug && !GLEW_VERSION_4_3) {
+        std::cout << "KHR_debug not available, no GL debug output" << std::endl;
+        return;
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);  // message arrives inside the call that caused it
+    glDebugMessageCallback(glDebugOutput, nullptr);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+#endif
+}
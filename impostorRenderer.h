@@ -0,0 +1,414 @@
+// impostorRenderer.h
+#pragma once
+#include "GameEngine.h"
+#include "object3D.h"
+#include "light.h"
+#include "shader.h"
+#include "paths.h"
+#include "frameArena.h"
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <map>
+#include <span>
+
+// far away models drawn as one camera facing quad each. every (mesh, material) gets an
+// octahedral atlas baked once: GRID x GRID orthographic views spread over the whole sphere,
+// albedo in one texture and mesh space normals in another, and the quad shows the view
+// closest to the camera direction. atlases are layers of two texture arrays so all the
+// impostors on screen go out in a single instanced draw
+class ImpostorRenderer {
+public:
+    static constexpr int GRID = 8;                      // views per atlas side
+    static constexpr int FRAME_SIZE = 64;               // pixels per view
+    static constexpr int ATLAS_SIZE = GRID * FRAME_SIZE;
+    static constexpr int MAX_LAYERS = 32;               // 2 x 32 MB of atlases
+
+    bool enabled = true;
+
+    // projected radius as a fraction of the screen height, below it a node goes flat
+    float screenSizeThreshold = 0.03f;
+
+    // bakes per frame, a freshly loaded forest spreads over a few frames instead of one hitch
+    int maxBakesPerFrame = 2;
+
+    ImpostorRenderer() = default;
+    ImpostorRenderer(const ImpostorRenderer&) = delete;
+    ImpostorRenderer& operator=(const ImpostorRenderer&) = delete;
+
+    ~ImpostorRenderer() {
+        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+        if (depthBuffer) glDeleteRenderbuffers(1, &depthBuffer);
+        GLStateCache& gl = GLStateCache::getInstance();
+        if (colorArray) gl.deleteTextures(1, &colorArray);
+        if (normalArray) gl.deleteTextures(1, &normalArray);
+        if (quadVAO) gl.deleteVertexArrays(1, &quadVAO);
+        if (quadVBO) glDeleteBuffers(1, &quadVBO);
+        if (instanceBuffer) glDeleteBuffers(1, &instanceBuffer);
+    }
+
+    static bool isEligible(const Node* node) {
+        return node->impostor && node->mesh && !node->mesh->isAnimated && !node->mesh->positions.empty();
+    }
+
+    // queues the atlas ahead of time (addNode), so it's ready by the time the node is far away
+    void prepare(Node* node) {
+        if (isEligible(node)) findOrQueue(node);
+    }
+
+    // start of the frame's list, also gives back the layers of meshes that are gone
+    void begin() {
+        instances.clear();
+        for (auto it = atlases.begin(); it != atlases.end();) {
+            if (it->second.mesh.expired()) {
+                releaseLayer(it->second.layer);
+                it = atlases.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    // true when node is small enough on screen and its atlas is baked, the caller then skips
+    // the real draw. projectionScale is projection[1][1] * 0.5
+    bool tryAdd(Node* node, const glm::vec3& cameraPos, float projectionScale) {
+        if (!isEligible(node)) return false;
+
+        AABB bounds = node->getWorldBounds();
+        float distance = glm::length(bounds.getCenter() - cameraPos);
+        if (distance <= 0.0f) return false;
+        if (glm::length(bounds.getExtents()) / distance * projectionScale > screenSizeThreshold) return false;
+
+        Atlas* atlas = findOrQueue(node);
+        if (!atlas || atlas->layer < 0) return false;
+
+        // quad spans the atlas sphere, scaled by the largest axis
+        const glm::mat4& world = node->worldTransform;
+        glm::vec3 axes[3] = { glm::vec3(world[0]), glm::vec3(world[1]), glm::vec3(world[2]) };
+        float scale = std::max({ glm::length(axes[0]), glm::length(axes[1]), glm::length(axes[2]) });
+        if (scale <= 0.0f) return false;
+        glm::quat rotation = glm::quat_cast(glm::mat3(
+            glm::normalize(axes[0]), glm::normalize(axes[1]), glm::normalize(axes[2])));
+
+        Instance instance;
+        instance.centerRadius = glm::vec4(glm::vec3(world * glm::vec4(atlas->center, 1.0f)), atlas->radius * scale);
+        instance.rotation = glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+        instance.layer = glm::vec4(static_cast<float>(atlas->layer), 0.0f, 0.0f, 0.0f);
+        instances.push_back(instance);
+        return true;
+    }
+
+    // GL thread, outside any pass. leaves the default framebuffer bound, the caller resets the viewport
+    void bakePending() {
+        if (pending.empty()) return;
+
+        size_t baked = 0;
+        while (!pending.empty() && baked < static_cast<size_t>(maxBakesPerFrame)) {
+            AtlasKey key = pending.back();
+            pending.pop_back();
+
+            // gone, or queued twice and already baked
+            auto it = atlases.find(key);
+            if (it == atlases.end() || it->second.layer >= 0) continue;
+            auto mesh = it->second.mesh.lock();
+            if (!mesh) continue;
+            if (!bake(*mesh, it->second)) {
+                // out of layers, the node keeps drawing itself. the entry goes so the next
+                // tryAdd queues it again, a layer may be free by then
+                atlases.erase(it);
+            }
+            ++baked;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // after the opaque pass, the quads write depth like regular geometry
+    void render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos,
+        std::span<const std::shared_ptr<SpotLight>> lights) {
+        if (instances.empty() || !colorArray) return;
+        setupDrawResources();
+
+        GLStateCache& gl = GLStateCache::getInstance();
+        gl.useProgram(drawProgram);
+        glUniformMatrix4fv(glGetUniformLocation(drawProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(glGetUniformLocation(drawProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        glUniform3fv(glGetUniformLocation(drawProgram, "viewPos"), 1, glm::value_ptr(cameraPos));
+        glUniform1f(glGetUniformLocation(drawProgram, "gridSize"), static_cast<float>(GRID));
+
+        // same spot lights as the main pass, without the shadow maps
+        int lightCount = static_cast<int>(std::min<size_t>(lights.size(), MAX_SPOT_LIGHTS));
+        glUniform1i(glGetUniformLocation(drawProgram, "numActiveSpotLights"), lightCount);
+        FrameArena& arena = FrameArena::getInstance();
+        auto lightUniform = [&](int i, const char* field) {
+            return glGetUniformLocation(drawProgram, arena.format("spotLights[%d].%s", i, field));
+        };
+        for (int i = 0; i < lightCount; ++i) {
+            const auto& light = lights[i];
+            glUniform3fv(lightUniform(i, "position"), 1, glm::value_ptr(light->getWorldPosition()));
+            glUniform3fv(lightUniform(i, "direction"), 1, glm::value_ptr(light->direction));
+            glUniform3fv(lightUniform(i, "color"), 1, glm::value_ptr(light->color));
+            glUniform1f(lightUniform(i, "intensity"), light->intensity);
+            glUniform1f(lightUniform(i, "constant"), light->constant);
+            glUniform1f(lightUniform(i, "linear"), light->linear);
+            glUniform1f(lightUniform(i, "quadratic"), light->quadratic);
+            glUniform1f(lightUniform(i, "innerCutoff"), light->innerCutoff);
+            glUniform1f(lightUniform(i, "outerCutoff"), light->outerCutoff);
+        }
+
+        gl.activeTexture(GL_TEXTURE0);
+        gl.bindTexture(GL_TEXTURE_2D_ARRAY, colorArray);
+        glUniform1i(glGetUniformLocation(drawProgram, "colorAtlas"), 0);
+        gl.activeTexture(GL_TEXTURE1);
+        gl.bindTexture(GL_TEXTURE_2D_ARRAY, normalArray);
+        glUniform1i(glGetUniformLocation(drawProgram, "normalAtlas"), 1);
+
+        // orphaned every frame like the instanced renderer's matrices
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        instanceCapacity = std::max(instanceCapacity, instances.size());
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Instance), instances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        gl.bindVertexArray(quadVAO);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(instances.size()));
+
+        // the atlases can stay bound, nothing else samples 2D arrays
+        gl.activeTexture(GL_TEXTURE0);
+    }
+
+    // materials or geometry were edited, every atlas gets baked again as it's needed
+    void invalidateAll() {
+        for (auto& [key, atlas] : atlases) {
+            releaseLayer(atlas.layer);
+        }
+        atlases.clear();
+        pending.clear();
+    }
+
+    size_t getImpostorCount() const { return instances.size(); }
+    size_t getAtlasCount() const { return static_cast<size_t>(nextLayer) - freeLayers.size(); }
+    size_t getPendingCount() const { return pending.size(); }
+
+private:
+    static constexpr int MAX_SPOT_LIGHTS = 4;
+
+    // per node material on shared meshes bakes separately
+    using AtlasKey = std::pair<const Mesh*, const Material*>;
+
+    struct Atlas {
+        std::weak_ptr<Mesh> mesh;               // the key pointer is only trusted while this is alive
+        std::shared_ptr<Material> material;
+        uint32_t boundsVersion = 0;             // geometry edits rebake
+        int layer = -1;                         // -1 until baked
+        glm::vec3 center = glm::vec3(0.0f);     // mesh space bounding sphere
+        float radius = 0.0f;
+    };
+
+    struct Instance {
+        glm::vec4 centerRadius;     // world space
+        glm::vec4 rotation;         // mesh to world quaternion, xyzw
+        glm::vec4 layer;            // x = atlas layer
+    };
+
+    std::map<AtlasKey, Atlas> atlases;
+    std::vector<AtlasKey> pending;
+    std::vector<Instance> instances;
+
+    std::vector<int> freeLayers;
+    int nextLayer = 0;
+    bool reportedFull = false;  // failed bakes retry every frame, say it once
+
+    GLuint colorArray = 0;
+    GLuint normalArray = 0;
+    GLuint framebuffer = 0;
+    GLuint depthBuffer = 0;
+    GLuint bakeProgram = 0;
+    GLuint drawProgram = 0;
+    GLuint quadVAO = 0;
+    GLuint quadVBO = 0;
+    GLuint instanceBuffer = 0;
+    size_t instanceCapacity = 0;
+
+    Atlas* findOrQueue(Node* node) {
+        auto material = node->getMaterial();
+        AtlasKey key{ node->mesh.get(), material.get() };
+
+        auto it = atlases.find(key);
+        if (it != atlases.end()) {
+            Atlas& atlas = it->second;
+            // same address but a different mesh, or the geometry changed since the bake
+            bool stale = atlas.mesh.lock() != node->mesh ||
+                (atlas.layer >= 0 && atlas.boundsVersion != node->mesh->getBoundsVersion());
+            if (!stale) return &atlas;
+            releaseLayer(atlas.layer);
+            atlases.erase(it);
+        }
+
+        Atlas atlas;
+        atlas.mesh = node->mesh;
+        atlas.material = material;
+        auto result = atlases.emplace(key, std::move(atlas));
+        pending.push_back(key);
+        return &result.first->second;
+    }
+
+    int allocateLayer() {
+        if (!freeLayers.empty()) {
+            int layer = freeLayers.back();
+            freeLayers.pop_back();
+            return layer;
+        }
+        return nextLayer < MAX_LAYERS ? nextLayer++ : -1;
+    }
+
+    void releaseLayer(int layer) {
+        if (layer < 0) return;
+        freeLayers.push_back(layer);
+        reportedFull = false;
+    }
+
+    // octahedral mapping, uv in [0, 1] to a unit direction (y up). same as the shader's
+    static glm::vec3 octDecode(glm::vec2 uv) {
+        glm::vec2 e = uv * 2.0f - 1.0f;
+        glm::vec3 n(e.x, 1.0f - std::abs(e.x) - std::abs(e.y), e.y);
+        if (n.y < 0.0f) {
+            float x = n.x;
+            n.x = (1.0f - std::abs(n.z)) * (x >= 0.0f ? 1.0f : -1.0f);
+            n.z = (1.0f - std::abs(x)) * (n.z >= 0.0f ? 1.0f : -1.0f);
+        }
+        return glm::normalize(n);
+    }
+
+    // up vector of the bake camera for view direction d, the shader picks the same one
+    static glm::vec3 frameUp(const glm::vec3& d) {
+        return std::abs(d.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+
+    static GLuint createArray() {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, texture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, ATLAS_SIZE, ATLAS_SIZE, MAX_LAYERS, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        // a few levels only, past 8 pixels per view neighbouring views bleed into each other
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 3);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return texture;
+    }
+
+    void setupBakeResources() {
+        if (framebuffer) return;
+
+        Shader bakeShader(Paths::Shaders::impostorBakeVertexShader.c_str(), Paths::Shaders::impostorBakeFragmentShader.c_str());
+        bakeProgram = bakeShader.getShaderProgram();
+        GLStateCache::getInstance().useProgram(bakeProgram);
+        MaterialTable::getInstance().setupProgram(bakeProgram);
+
+        colorArray = createArray();
+        normalArray = createArray();
+
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, ATLAS_SIZE, ATLAS_SIZE);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, drawBuffers);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void setupDrawResources() {
+        if (drawProgram) return;
+
+        Shader drawShader(Paths::Shaders::impostorVertexShader.c_str(), Paths::Shaders::impostorFragmentShader.c_str());
+        drawProgram = drawShader.getShaderProgram();
+
+        // unit quad corners, strip order
+        const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+
+        glGenVertexArrays(1, &quadVAO);
+        glGenBuffers(1, &quadVBO);
+        glGenBuffers(1, &instanceBuffer);
+
+        GLStateCache::getInstance().bindVertexArray(quadVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        for (GLuint i = 0; i < 3; ++i) {
+            glVertexAttribPointer(1 + i, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(1 + i, 1);
+            glEnableVertexAttribArray(1 + i);
+        }
+        GLStateCache::getInstance().bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    bool bake(Mesh& mesh, Atlas& atlas) {
+        setupBakeResources();
+        atlas.layer = allocateLayer();
+        if (atlas.layer < 0) {
+            if (!reportedFull) std::cout << "ImpostorRenderer: all " << MAX_LAYERS << " atlas layers in use" << std::endl;
+            reportedFull = true;
+            return false;
+        }
+
+        AABB bounds = mesh.getLocalBounds();
+        atlas.center = bounds.getCenter();
+        atlas.radius = std::max(glm::length(bounds.getExtents()), 1e-4f);
+        atlas.boundsVersion = mesh.getBoundsVersion();
+        float r = atlas.radius;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, colorArray, 0, atlas.layer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, normalArray, 0, atlas.layer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ImpostorRenderer: bake framebuffer incomplete" << std::endl;
+            releaseLayer(atlas.layer);
+            return false;
+        }
+
+        // cleared to zero alpha, that's the coverage the impostor shader cuts out with.
+        // per attachment so the scene's clear color doesn't have to be read back and restored
+        const GLfloat transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glClearBufferfv(GL_COLOR, 0, transparent);
+        glClearBufferfv(GL_COLOR, 1, transparent);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        GLStateCache& gl = GLStateCache::getInstance();
+        gl.enable(GL_DEPTH_TEST);
+        gl.disable(GL_BLEND);
+
+        gl.useProgram(bakeProgram);
+        glUniformMatrix4fv(glGetUniformLocation(bakeProgram, "model"), 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+        GLint viewLocation = glGetUniformLocation(bakeProgram, "view");
+        glm::mat4 projection = glm::ortho(-r, r, -r, r, r, 3.0f * r);
+        glUniformMatrix4fv(glGetUniformLocation(bakeProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+        for (int j = 0; j < GRID; ++j) {
+            for (int i = 0; i < GRID; ++i) {
+                glm::vec3 d = octDecode((glm::vec2(i, j) + 0.5f) / static_cast<float>(GRID));
+                glm::mat4 view = glm::lookAt(atlas.center + d * (2.0f * r), atlas.center, frameUp(d));
+                glUniformMatrix4fv(viewLocation, 1, GL_FALSE, glm::value_ptr(view));
+                glViewport(i * FRAME_SIZE, j * FRAME_SIZE, FRAME_SIZE, FRAME_SIZE);
+                mesh.draw(bakeProgram, atlas.material.get());
+            }
+        }
+
+        // the whole array's mips, only a few levels and only when something got baked
+        gl.bindTexture(GL_TEXTURE_2D_ARRAY, colorArray);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        gl.bindTexture(GL_TEXTURE_2D_ARRAY, normalArray);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        gl.bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        return true;
+    }
+};
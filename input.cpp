@@ -73,6 +73,7 @@ void mouse_press_once(GLFWwindow* window, int button, void(*func)(GLFWwindow* wi
 
 // Mouse callback function
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
+    RedrawTracker::getInstance().markDirty();  // hover state in the UI
     if (!scene.activeCamera) return;
 
     static double lastX = 400.0;
@@ -261,6 +262,7 @@ void processInput(GLFWwindow* window) {
 
 // After the processInput function, add:
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    RedrawTracker::getInstance().markDirty();
     if (Console::getInstance().isVisible()) {
         handleConsoleInput(window, key, scancode, action, mods);
     }
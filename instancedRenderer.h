@@ -0,0 +1,185 @@
+// instancedRenderer.h
+#pragma once
+#include "GameEngine.h"
+#include "object3D.h"
+#include "frameArena.h"
+#include <algorithm>
+#include <span>
+#include <unordered_map>
+
+// draws a pass worth of meshes, grouping everything that shares a mesh into one
+// glDrawElementsInstanced. materials only split a group when they sit in different
+// material table pages or bind different textures, the rest comes from a per instance
+// table index. model matrices and indices for all groups go into one stream buffer per
+// pass, the vertex shaders read them from attributes 7-11 when `instanced` is set.
+// groups too small to be worth it draw one by one like before
+class InstancedRenderer {
+public:
+    struct Entry {
+        Mesh* mesh;
+        const glm::mat4* model;
+        Material* material;     // slot 0, the node's override or the mesh's own
+        uint32_t tableIndex = 0;    // filled in by the main pass
+        uint64_t textureKey = 0;
+    };
+
+    size_t minInstances = 4;
+
+    InstancedRenderer() = default;
+    InstancedRenderer(const InstancedRenderer&) = delete;
+    InstancedRenderer& operator=(const InstancedRenderer&) = delete;
+
+    ~InstancedRenderer() {
+        if (instanceBuffer) glDeleteBuffers(1, &instanceBuffer);
+    }
+
+    // main pass, binds each group's material once. instancing = false keeps the given
+    // order (sorted transparent objects)
+    void drawMain(std::span<Entry> entries, GLuint program, bool instancing = true) {
+        draw(entries, program, true, instancing);
+    }
+
+    // depth only
+    void drawShadow(std::span<Entry> entries, GLuint program) {
+        draw(entries, program, false, true);
+    }
+
+    size_t getInstancedDraws() const { return instancedDraws; }
+    size_t getInstanceCount() const { return instanceCount; }
+    size_t getSingleDraws() const { return singleDraws; }
+
+    // per frame counters, reset before the first pass
+    void resetStats() {
+        instancedDraws = instanceCount = singleDraws = 0;
+    }
+
+private:
+    // looked up once per program
+    struct Locations {
+        GLint model;
+        GLint instanced;
+    };
+
+    GLuint instanceBuffer = 0;
+    size_t instanceCapacity = 0;    // instances
+    std::unordered_map<GLuint, Locations> locations;
+
+    size_t instancedDraws = 0;
+    size_t instanceCount = 0;
+    size_t singleDraws = 0;
+
+    // multi material meshes switch materials mid draw, those stay single
+    static bool canInstance(const Mesh* mesh) {
+        return mesh->materialIds.empty() && !mesh->positions.empty();
+    }
+
+    const Locations& locationsFor(GLuint program) {
+        auto it = locations.find(program);
+        if (it == locations.end()) {
+            it = locations.emplace(program, Locations{ glGetUniformLocation(program, "model"),
+                glGetUniformLocation(program, "instanced") }).first;
+        }
+        return it->second;
+    }
+
+    void drawSingle(const Entry& entry, const Locations& uniforms, GLuint program, bool withMaterials) {
+        glUniformMatrix4fv(uniforms.model, 1, GL_FALSE, glm::value_ptr(*entry.model));
+        if (withMaterials) {
+            entry.mesh->draw(program, entry.material);  // binds the material itself
+        }
+        else {
+            entry.mesh->drawShadow(program);
+        }
+        ++singleDraws;
+    }
+
+    void draw(std::span<Entry> entries, GLuint program, bool withMaterials, bool instancing) {
+        if (entries.empty()) return;
+        const Locations& uniforms = locationsFor(program);
+
+        if (!instancing) {
+            glUniform1i(uniforms.instanced, 0);
+            for (const Entry& entry : entries) drawSingle(entry, uniforms, program, withMaterials);
+            return;
+        }
+
+        // bare meshes share the table's default material, so they can group too
+        MaterialTable& table = MaterialTable::getInstance();
+        if (withMaterials) {
+            for (Entry& entry : entries) {
+                Material& material = entry.material ? *entry.material : table.getDefaultMaterial();
+                entry.tableIndex = table.prepare(material);
+                entry.textureKey = material.tableSlot.textureKey;
+            }
+        }
+        auto page = [](const Entry& entry) { return MaterialTable::pageOf(entry.tableIndex); };
+
+        // depth only doesn't care about materials at all
+        std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+            if (a.mesh != b.mesh) return a.mesh < b.mesh;
+            if (!withMaterials) return false;
+            if (page(a) != page(b)) return page(a) < page(b);
+            if (a.textureKey != b.textureKey) return a.textureKey < b.textureKey;
+            return a.tableIndex < b.tableIndex;
+        });
+        auto sameGroup = [&](const Entry& a, const Entry& b) {
+            return a.mesh == b.mesh && (!withMaterials || (page(a) == page(b) && a.textureKey == b.textureKey));
+        };
+
+        // runs that can share a draw, big enough ones get their instance data packed
+        struct Group {
+            size_t begin, end;
+            size_t firstInstance;
+        };
+        FrameVector<Group> groups;
+        FrameVector<Mesh::InstanceData> instances;
+        FrameVector<const Entry*> singles;
+
+        for (size_t begin = 0; begin < entries.size();) {
+            size_t end = begin + 1;
+            while (end < entries.size() && sameGroup(entries[end], entries[begin])) ++end;
+
+            if (end - begin >= minInstances && canInstance(entries[begin].mesh)) {
+                groups.push_back({ begin, end, instances.size() });
+                for (size_t i = begin; i < end; ++i) {
+                    GLint local = static_cast<GLint>(entries[i].tableIndex % MaterialTable::PAGE_SIZE);
+                    instances.push_back({ *entries[i].model, local, {} });
+                }
+            }
+            else {
+                for (size_t i = begin; i < end; ++i) singles.push_back(&entries[i]);
+            }
+            begin = end;
+        }
+
+        if (!groups.empty()) {
+            upload(instances);
+            glUniform1i(uniforms.instanced, 1);
+            for (const Group& group : groups) {
+                const Entry& first = entries[group.begin];
+                if (withMaterials) {
+                    // the group's page and textures, every instance brings its own index
+                    table.bind(program, first.material ? *first.material : table.getDefaultMaterial());
+                }
+                GLsizei count = static_cast<GLsizei>(group.end - group.begin);
+                first.mesh->drawInstanced(instanceBuffer, group.firstInstance * sizeof(Mesh::InstanceData), count);
+                ++instancedDraws;
+                instanceCount += count;
+            }
+        }
+
+        glUniform1i(uniforms.instanced, 0);
+        for (const Entry* entry : singles) drawSingle(*entry, uniforms, program, withMaterials);
+    }
+
+    void upload(const FrameVector<Mesh::InstanceData>& instances) {
+        if (instanceBuffer == 0) glGenBuffers(1, &instanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+
+        // orphan the old storage so we don't stall on the previous pass still reading it
+        instanceCapacity = std::max(instanceCapacity, instances.size());
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(Mesh::InstanceData), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Mesh::InstanceData), instances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
@@ -0,0 +1,131 @@
+// jobSystem.h
+#pragma once
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+
+// small worker pool for splitting big per-frame loops across cores
+// (particles, transforms, culling) and for background jobs (streaming, LODs)
+class JobSystem {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    bool stopping = false;
+
+    JobSystem() {
+        unsigned int hw = std::thread::hardware_concurrency();
+        // keep one core for the main (GL) thread
+        unsigned int workerCount = hw > 1 ? hw - 1 : 1;
+        for (unsigned int i = 0; i < workerCount; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCv.notify_all();
+        for (auto& worker : workers) {
+            if (worker.joinable()) worker.join();
+        }
+    }
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCv.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    void enqueue(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            jobs.push_back(std::move(job));
+        }
+        queueCv.notify_one();
+    }
+
+public:
+    // destroyed at exit, which joins the workers
+    static JobSystem& getInstance() {
+        static JobSystem instance;
+        return instance;
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    size_t getWorkerCount() const { return workers.size(); }
+
+    // fire and forget / background job, future lets the caller poll for completion
+    std::future<void> submit(std::function<void()> fn) {
+        auto task = std::make_shared<std::packaged_task<void()>>(std::move(fn));
+        std::future<void> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+
+    // splits [0, count) into batches of at least minBatch and blocks until all are done.
+    // the calling thread works through the batches too, and only ever these batches: it
+    // never picks up unrelated queued jobs (streaming, LODs) that would stall the frame,
+    // and a nested parallelFor inside a job finishes even when every worker is busy
+    void parallelFor(size_t count, size_t minBatch, const std::function<void(size_t, size_t)>& fn) {
+        if (count == 0) return;
+        minBatch = std::max<size_t>(minBatch, 1);
+
+        size_t batchCount = std::min(workers.size() + 1, (count + minBatch - 1) / minBatch);
+        if (batchCount <= 1) {
+            fn(0, count);
+            return;
+        }
+        size_t batchSize = (count + batchCount - 1) / batchCount;
+
+        struct ForState {
+            std::atomic<size_t> next{ 0 };
+            std::mutex mutex;
+            std::condition_variable cv;
+            size_t remaining = 0;
+        };
+        auto state = std::make_shared<ForState>();
+        state->remaining = batchCount;
+
+        // claims batches until none are left. helpers that start after the last one was
+        // claimed return without touching fn, which may be gone by then
+        auto runBatches = [state, &fn, count, batchCount, batchSize]() {
+            size_t b;
+            while ((b = state->next.fetch_add(1)) < batchCount) {
+                size_t begin = b * batchSize;
+                size_t end = std::min(count, begin + batchSize);
+                if (begin < end) fn(begin, end);
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (--state->remaining == 0) state->cv.notify_all();
+            }
+        };
+
+        for (size_t b = 1; b < batchCount; ++b) {
+            enqueue(runBatches);
+        }
+        runBatches();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait(lock, [&]() { return state->remaining == 0; });
+    }
+};
@@ -0,0 +1,198 @@
+// meshLod.h
+#pragma once
+#include "object3D.h"
+#include "meshSimplifier.h"
+#include "jobSystem.h"
+#include <chrono>
+#include <future>
+#include <unordered_map>
+
+// builds a chain of simplified meshes for every dense mesh that gets drawn, on worker
+// threads, and picks a level per node from how big it is on screen. the chain is stored on
+// the Mesh (Mesh::lods), so nodes sharing a mesh share its levels and instancing still
+// groups them. GL thread only, apart from the simplification jobs
+class MeshLodManager {
+public:
+    bool enabled = true;
+
+    // triangle budget of each level as a fraction of the full mesh
+    std::vector<float> levelRatios = { 0.5f, 0.25f, 0.1f };
+
+    // projected radius (fraction of screen height) below which level i + 1 is used,
+    // one per level, descending
+    std::vector<float> screenSizes = { 0.25f, 0.12f, 0.05f };
+
+    // a node only changes level once it's this far (relative) past the threshold,
+    // so it doesn't flicker between two levels at the boundary
+    float hysteresis = 0.15f;
+
+    // smaller meshes aren't worth simplifying
+    size_t minTriangles = 512;
+
+    // big meshes take a while, don't let them fill every worker
+    int maxConcurrentJobs = 2;
+
+    MeshLodManager() = default;
+    MeshLodManager(const MeshLodManager&) = delete;
+    MeshLodManager& operator=(const MeshLodManager&) = delete;
+
+    // waits for running jobs, they reference nothing of ours but the results would be lost anyway
+    ~MeshLodManager() {
+        for (auto& job : jobs) {
+            if (job.future.valid()) job.future.wait();
+        }
+    }
+
+    static bool isEligible(const Mesh* mesh) {
+        return mesh && !mesh->isAnimated && !mesh->indices.empty();
+    }
+
+    // start of the frame: installs finished chains and starts queued jobs
+    void update() {
+        using namespace std::chrono_literals;
+
+        for (auto it = jobs.begin(); it != jobs.end();) {
+            if (it->future.wait_for(0s) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+            it->future.get();
+            if (auto mesh = it->mesh.lock()) {
+                // edited while it was being simplified, the next request starts over
+                if (mesh->getBoundsVersion() == it->version) install(*mesh, std::move(it->result->levels));
+                requested.erase(mesh.get());
+            }
+            it = jobs.erase(it);
+        }
+
+        while (!queue.empty() && static_cast<int>(jobs.size()) < maxConcurrentJobs) {
+            auto mesh = queue.front().lock();
+            queue.erase(queue.begin());
+            if (mesh) start(mesh);
+        }
+
+        // entries of meshes that died while waiting
+        for (auto it = requested.begin(); it != requested.end();) {
+            it = it->second.expired() ? requested.erase(it) : std::next(it);
+        }
+    }
+
+    // sets node->lodLevel for this frame and queues the chain if the mesh doesn't have an
+    // up to date one yet. projectionScale is projection[1][1] * 0.5
+    void select(Node* node, const glm::vec3& cameraPos, float projectionScale) {
+        Mesh* mesh = node->mesh.get();
+        if (!enabled || !isEligible(mesh)) {
+            node->lodLevel = 0;
+            return;
+        }
+        // no levels yet, or they were built from geometry that has changed since
+        if (mesh->lodSourceVersion != mesh->getBoundsVersion()) {
+            request(node->mesh);
+            node->lodLevel = 0;
+            return;
+        }
+        int available = static_cast<int>(std::min(mesh->lods.size(), screenSizes.size()));
+        if (available == 0) {
+            node->lodLevel = 0;
+            return;
+        }
+
+        AABB bounds = node->getWorldBounds();
+        float distance = glm::length(bounds.getCenter() - cameraPos);
+        float size = distance > 0.0f ? glm::length(bounds.getExtents()) / distance * projectionScale : 1.0f;
+
+        int level = std::min<int>(node->lodLevel, available);
+        while (level < available && size < screenSizes[level] * (1.0f - hysteresis)) ++level;
+        while (level > 0 && size > screenSizes[level - 1] * (1.0f + hysteresis)) --level;
+        node->lodLevel = static_cast<uint8_t>(level);
+
+        // slot edits on the full mesh carry over
+        Mesh* lod = node->getLodMesh();
+        if (lod != mesh && lod->materials != mesh->materials) lod->materials = mesh->materials;
+    }
+
+    size_t getPendingCount() const { return queue.size() + jobs.size(); }
+    size_t getGeneratedCount() const { return generated; }
+
+private:
+    struct Result {
+        std::vector<MeshSimplifier::Geometry> levels;
+    };
+
+    struct Job {
+        std::weak_ptr<Mesh> mesh;
+        uint32_t version = 0;
+        std::shared_ptr<Result> result;
+        std::future<void> future;
+    };
+
+    std::vector<Job> jobs;
+    std::vector<std::weak_ptr<Mesh>> queue;
+    std::unordered_map<const Mesh*, std::weak_ptr<Mesh>> requested;   // queued or running
+    size_t generated = 0;
+
+    void request(const std::shared_ptr<Mesh>& mesh) {
+        // not uploaded yet, setupBuffers bumps the version anyway
+        if (mesh->uploadPending || mesh->VAO == 0) return;
+
+        auto it = requested.find(mesh.get());
+        if (it != requested.end() && !it->second.expired()) return;
+
+        if (mesh->indices.size() / 3 < minTriangles) {
+            install(*mesh, {});
+            return;
+        }
+        requested[mesh.get()] = mesh;
+        queue.push_back(mesh);
+    }
+
+    void start(const std::shared_ptr<Mesh>& mesh) {
+        // plain copy of the arrays, the job never touches the Mesh
+        auto source = std::make_shared<MeshSimplifier::Geometry>();
+        source->positions = mesh->positions;
+        source->normals = mesh->normals;
+        source->tangents = mesh->tangents;
+        source->colors = mesh->colors;
+        auto uvs = mesh->uvSets.find(Mesh::DEFAULT_UV_SET);
+        if (uvs != mesh->uvSets.end()) source->uvs = uvs->second;
+        source->indices = mesh->indices;
+        source->materialIds = mesh->materialIds;
+
+        std::vector<size_t> targets;
+        for (float ratio : levelRatios) {
+            targets.push_back(static_cast<size_t>(source->triangleCount() * ratio));
+        }
+
+        Job job;
+        job.mesh = mesh;
+        job.version = mesh->getBoundsVersion();
+        job.result = std::make_shared<Result>();
+        job.future = JobSystem::getInstance().submit([source, targets, result = job.result]() {
+            result->levels = MeshSimplifier::simplify(*source, targets);
+        });
+        jobs.push_back(std::move(job));
+    }
+
+    // GL thread, the levels get their buffers right away
+    void install(Mesh& mesh, std::vector<MeshSimplifier::Geometry> levels) {
+        for (auto& lod : mesh.lods) {
+            lod->releaseBuffers();
+        }
+        mesh.lods.clear();
+
+        for (auto& level : levels) {
+            auto lod = makePooled<Mesh, pools::Meshes>(mesh.materials);
+            lod->positions = std::move(level.positions);
+            lod->normals = std::move(level.normals);
+            lod->tangents = std::move(level.tangents);
+            lod->colors = std::move(level.colors);
+            lod->uvSets[Mesh::DEFAULT_UV_SET] = std::move(level.uvs);
+            lod->indices = std::move(level.indices);
+            lod->materialIds = std::move(level.materialIds);
+            lod->setupBuffers();
+            mesh.lods.push_back(lod);
+        }
+        mesh.lodSourceVersion = mesh.getBoundsVersion();
+        if (!levels.empty()) ++generated;
+    }
+};
@@ -0,0 +1,273 @@
+// meshSimplifier.h
+#pragma once
+#include "GameEngine.h"
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+// quadric error edge collapse (Garland & Heckbert). works on a plain copy of the mesh
+// arrays so it can run on a worker while the Mesh itself keeps being drawn.
+// collapses are half edge (a vertex moves onto a neighbour), so every surviving vertex
+// keeps its own normal/uv/color and nothing has to be interpolated. open edges, which
+// includes uv and normal seams since those vertices are split, are pinned with extra
+// planes so borders and seams don't pull apart
+class MeshSimplifier {
+public:
+    struct Geometry {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<glm::vec3> tangents;
+        std::vector<glm::vec4> colors;
+        std::vector<glm::vec2> uvs;         // default uv set
+        std::vector<unsigned int> indices;
+        std::vector<int> materialIds;       // per triangle, empty for single material meshes
+
+        size_t triangleCount() const { return indices.size() / 3; }
+    };
+
+    // error weight of the border planes, relative to the surface planes
+    static constexpr double BOUNDARY_WEIGHT = 1000.0;
+
+    // one result per target triangle count (descending), all from a single collapse run so
+    // each level keeps the error accumulated by the ones before it. stops early (fewer
+    // results) once no valid collapse is left
+    static std::vector<Geometry> simplify(const Geometry& source, const std::vector<size_t>& targets) {
+        std::vector<Geometry> results;
+        if (source.indices.empty() || targets.empty()) return results;
+
+        State state(source);
+        for (size_t target : targets) {
+            if (!state.collapseTo(target)) break;
+            results.push_back(state.extract());
+        }
+        return results;
+    }
+
+private:
+    // symmetric 4x4, upper triangle
+    struct Quadric {
+        double a[10] = {};
+
+        static Quadric plane(double x, double y, double z, double d, double weight) {
+            Quadric q;
+            q.a[0] = x * x; q.a[1] = x * y; q.a[2] = x * z; q.a[3] = x * d;
+            q.a[4] = y * y; q.a[5] = y * z; q.a[6] = y * d;
+            q.a[7] = z * z; q.a[8] = z * d;
+            q.a[9] = d * d;
+            for (double& value : q.a) value *= weight;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& other) {
+            for (int i = 0; i < 10; ++i) a[i] += other.a[i];
+            return *this;
+        }
+
+        double error(const glm::vec3& p) const {
+            double x = p.x, y = p.y, z = p.z;
+            return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x +
+                a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y +
+                a[7] * z * z + 2.0 * a[8] * z + a[9];
+        }
+    };
+
+    struct Candidate {
+        double cost;
+        uint32_t from, to;
+        uint32_t fromStamp, toStamp;
+
+        bool operator>(const Candidate& other) const { return cost > other.cost; }
+    };
+
+    struct State {
+        const Geometry& source;
+        std::vector<uint32_t> triangles;                // 3 per triangle, rewritten as vertices collapse
+        std::vector<uint8_t> triangleAlive;
+        std::vector<std::vector<uint32_t>> vertexTriangles;
+        std::vector<Quadric> quadrics;
+        std::vector<uint8_t> vertexAlive;
+        std::vector<uint32_t> stamps;                   // bumped when a vertex changes, stale heap entries get skipped
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+        size_t liveTriangles = 0;
+
+        explicit State(const Geometry& geometry) : source(geometry) {
+            size_t vertexCount = geometry.positions.size();
+            size_t triangleCount = geometry.triangleCount();
+            triangles.assign(geometry.indices.begin(), geometry.indices.begin() + triangleCount * 3);
+            triangleAlive.assign(triangleCount, 1);
+            vertexTriangles.resize(vertexCount);
+            quadrics.resize(vertexCount);
+            vertexAlive.assign(vertexCount, 1);
+            stamps.assign(vertexCount, 0);
+
+            std::unordered_map<uint64_t, uint32_t> edgeUse;
+            edgeUse.reserve(triangleCount * 3);
+            auto edgeKey = [](uint32_t a, uint32_t b) {
+                return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+            };
+
+            for (uint32_t t = 0; t < triangleCount; ++t) {
+                uint32_t* v = &triangles[t * 3];
+                if (v[0] >= vertexCount || v[1] >= vertexCount || v[2] >= vertexCount) {
+                    triangleAlive[t] = 0;
+                    continue;
+                }
+                ++liveTriangles;
+                for (int i = 0; i < 3; ++i) {
+                    vertexTriangles[v[i]].push_back(t);
+                    ++edgeUse[edgeKey(v[i], v[(i + 1) % 3])];
+                }
+
+                // area weighted plane, degenerate triangles add nothing
+                glm::dvec3 p0(geometry.positions[v[0]]), p1(geometry.positions[v[1]]), p2(geometry.positions[v[2]]);
+                glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+                double area = glm::length(n);
+                if (area <= 1e-20) continue;
+                n /= area;
+                Quadric q = Quadric::plane(n.x, n.y, n.z, -glm::dot(n, p0), area * 0.5);
+                for (int i = 0; i < 3; ++i) quadrics[v[i]] += q;
+            }
+
+            // open edges get a plane through the edge, perpendicular to its triangle
+            for (uint32_t t = 0; t < triangleCount; ++t) {
+                if (!triangleAlive[t]) continue;
+                const uint32_t* v = &triangles[t * 3];
+                glm::dvec3 p0(geometry.positions[v[0]]), p1(geometry.positions[v[1]]), p2(geometry.positions[v[2]]);
+                glm::dvec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+                if (glm::length(faceNormal) <= 1e-20) continue;
+                faceNormal = glm::normalize(faceNormal);
+
+                for (int i = 0; i < 3; ++i) {
+                    uint32_t a = v[i], b = v[(i + 1) % 3];
+                    if (edgeUse[edgeKey(a, b)] != 1) continue;
+                    glm::dvec3 pa(geometry.positions[a]), pb(geometry.positions[b]);
+                    glm::dvec3 edge = pb - pa;
+                    double length = glm::length(edge);
+                    if (length <= 1e-12) continue;
+                    glm::dvec3 n = glm::normalize(glm::cross(edge, faceNormal));
+                    Quadric q = Quadric::plane(n.x, n.y, n.z, -glm::dot(n, pa), length * length * BOUNDARY_WEIGHT);
+                    quadrics[a] += q;
+                    quadrics[b] += q;
+                }
+            }
+
+            for (uint32_t t = 0; t < triangleCount; ++t) {
+                if (!triangleAlive[t]) continue;
+                const uint32_t* v = &triangles[t * 3];
+                for (int i = 0; i < 3; ++i) pushEdge(v[i], v[(i + 1) % 3]);
+            }
+        }
+
+        // cheaper direction of the edge goes on the heap
+        void pushEdge(uint32_t a, uint32_t b) {
+            if (a == b) return;
+            Quadric q = quadrics[a];
+            q += quadrics[b];
+            double costAB = q.error(source.positions[b]);   // a moves onto b
+            double costBA = q.error(source.positions[a]);
+            if (costAB <= costBA) heap.push({ costAB, a, b, stamps[a], stamps[b] });
+            else heap.push({ costBA, b, a, stamps[b], stamps[a] });
+        }
+
+        // moving `from` onto `to` must not flip any triangle that survives
+        bool canCollapse(uint32_t from, uint32_t to) const {
+            const glm::vec3& target = source.positions[to];
+            for (uint32_t t : vertexTriangles[from]) {
+                if (!triangleAlive[t]) continue;
+                const uint32_t* v = &triangles[t * 3];
+                if (v[0] == to || v[1] == to || v[2] == to) continue;
+
+                glm::vec3 before[3], after[3];
+                for (int i = 0; i < 3; ++i) {
+                    before[i] = source.positions[v[i]];
+                    after[i] = v[i] == from ? target : before[i];
+                }
+                glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+                glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+                float l0 = glm::length(n0), l1 = glm::length(n1);
+                if (l1 <= 1e-12f) return false;
+                if (l0 > 1e-12f && glm::dot(n0, n1) < 0.2f * l0 * l1) return false;
+            }
+            return true;
+        }
+
+        void collapse(uint32_t from, uint32_t to) {
+            for (uint32_t t : vertexTriangles[from]) {
+                if (!triangleAlive[t]) continue;
+                uint32_t* v = &triangles[t * 3];
+                if (v[0] == to || v[1] == to || v[2] == to) {
+                    triangleAlive[t] = 0;
+                    --liveTriangles;
+                    continue;
+                }
+                for (int i = 0; i < 3; ++i) {
+                    if (v[i] == from) v[i] = to;
+                }
+                vertexTriangles[to].push_back(t);
+            }
+            vertexTriangles[from].clear();
+            vertexTriangles[from].shrink_to_fit();
+            vertexAlive[from] = 0;
+            quadrics[to] += quadrics[from];
+            ++stamps[to];
+
+            auto& list = vertexTriangles[to];
+            list.erase(std::remove_if(list.begin(), list.end(), [&](uint32_t t) { return !triangleAlive[t]; }), list.end());
+
+            // every edge around `to` has a new cost
+            for (uint32_t t : list) {
+                const uint32_t* v = &triangles[t * 3];
+                for (int i = 0; i < 3; ++i) {
+                    if (v[i] != to) pushEdge(to, v[i]);
+                }
+            }
+        }
+
+        // false when it ran out of collapses before getting anywhere near the target
+        bool collapseTo(size_t target) {
+            size_t start = liveTriangles;
+            while (liveTriangles > target && !heap.empty()) {
+                Candidate candidate = heap.top();
+                heap.pop();
+                if (!vertexAlive[candidate.from] || !vertexAlive[candidate.to]) continue;
+                if (stamps[candidate.from] != candidate.fromStamp || stamps[candidate.to] != candidate.toStamp) continue;
+                if (!canCollapse(candidate.from, candidate.to)) continue;
+                collapse(candidate.from, candidate.to);
+            }
+            // a level that barely shrank isn't worth the memory
+            return liveTriangles < start && liveTriangles <= target + target / 4;
+        }
+
+        // surviving triangles in their original order, so material runs stay contiguous
+        Geometry extract() const {
+            Geometry result;
+            std::vector<uint32_t> remap(source.positions.size(), UINT32_MAX);
+            bool hasNormals = source.normals.size() == source.positions.size();
+            bool hasTangents = source.tangents.size() == source.positions.size();
+            bool hasColors = source.colors.size() == source.positions.size();
+            bool hasUVs = source.uvs.size() == source.positions.size();
+
+            for (size_t t = 0; t < triangleAlive.size(); ++t) {
+                if (!triangleAlive[t]) continue;
+                for (int i = 0; i < 3; ++i) {
+                    uint32_t index = triangles[t * 3 + i];
+                    if (remap[index] == UINT32_MAX) {
+                        remap[index] = static_cast<uint32_t>(result.positions.size());
+                        result.positions.push_back(source.positions[index]);
+                        if (hasNormals) result.normals.push_back(source.normals[index]);
+                        if (hasTangents) result.tangents.push_back(source.tangents[index]);
+                        if (hasColors) result.colors.push_back(source.colors[index]);
+                        if (hasUVs) result.uvs.push_back(source.uvs[index]);
+                    }
+                    result.indices.push_back(remap[index]);
+                }
+                if (!source.materialIds.empty()) {
+                    result.materialIds.push_back(t < source.materialIds.size() ? source.materialIds[t] : 0);
+                }
+            }
+            return result;
+        }
+    };
+};
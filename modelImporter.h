@@ -62,7 +62,7 @@ private:
 
                 // Processed data
                 const glm::vec3& procPos = processedMesh->positions[i];
-                const glm::vec2& procUV = processedMesh->uvSets["map1"][i];
+                const glm::vec2& procUV = processedMesh->uvSets[Mesh::DEFAULT_UV_SET][i];
                 std::cout << "Processed:" << std::endl;
                 std::cout << "  Position: (" << procPos.x << ", " << procPos.y << ", " << procPos.z << ")" << std::endl;
                 std::cout << "  UV: (" << procUV.x << ", " << procUV.y << ")" << std::endl;
@@ -102,7 +102,7 @@ private:
                 std::cout << "UV coordinates for this triangle:" << std::endl;
                 for (unsigned int j = 0; j < 3; j++) {
                     unsigned int vertexIndex = processedMesh->indices[i * 3 + j];
-                    const glm::vec2& uv = processedMesh->uvSets["map1"][vertexIndex];
+                    const glm::vec2& uv = processedMesh->uvSets[Mesh::DEFAULT_UV_SET][vertexIndex];
                     std::cout << "  v" << j << ": (" << uv.x << ", " << uv.y << ")" << std::endl;
                 }
             }
@@ -139,7 +139,7 @@ private:
     std::shared_ptr<Material> processMaterial(aiMaterial* material, const aiScene* scene) {
         if (!material) {
             std::cout << "Warning: Null material provided" << std::endl;
-            return std::make_shared<Material>();
+            return makePooled<Material, pools::Materials>();
         }
 
         std::cout << "\n=== Processing Material ===" << std::endl;
@@ -156,7 +156,7 @@ private:
         }
 
 
-        auto newMaterial = std::make_shared<Material>();
+        auto newMaterial = makePooled<Material, pools::Materials>();
 
         // Process base color
         aiColor4D baseColor(1.0f);
@@ -347,7 +347,7 @@ private:
                 }
 
                 // Store the texture map
-                newMaterial->textureMaps[mapping.engineType] = texMap;
+                newMaterial->textureMaps[internString(mapping.engineType)] = texMap;
             }
         }
 
@@ -377,7 +377,7 @@ private:
 
             // Verify texture parameters in OpenGL
             GLint wrap_s, wrap_t, min_filter, mag_filter;
-            glBindTexture(GL_TEXTURE_2D, texMap.textureId);
+            GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, texMap.textureId);
             glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, &wrap_s);
             glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, &wrap_t);
             glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &min_filter);
@@ -399,12 +399,12 @@ private:
     std::shared_ptr<Mesh> processMesh(aiMesh* mesh, const aiScene* scene) {
         std::cout << "\n --- Calling processMesh --- \n";
 
-        auto newMesh = std::make_shared<Mesh>(false);
+        auto newMesh = makePooled<Mesh, pools::Meshes>(false);
 
         // Check if the scene has animations
         if (scene->HasAnimations()) {
             std::cout << "\n --- Scene hasAnimations = true \n";
-            auto animatedMesh = std::make_shared<AnimatedMesh>();
+            auto animatedMesh = makePooled<AnimatedMesh, pools::Meshes>();
 
             // Process bone data if present
             if (mesh->HasBones()) {
@@ -437,7 +437,7 @@ private:
             newMesh = animatedMesh;
         }
         else {
-            newMesh = std::make_shared<Mesh>(false);
+            newMesh = makePooled<Mesh, pools::Meshes>(false);
         }
 
         // Track unique vertex-UV combinations
@@ -496,12 +496,12 @@ private:
         // Now populate the mesh data
         newMesh->positions.reserve(vertices.size());
         newMesh->normals.reserve(vertices.size());
-        newMesh->uvSets["map1"].reserve(vertices.size());
+        newMesh->uvSets[Mesh::DEFAULT_UV_SET].reserve(vertices.size());
 
         for (const auto& vertex : vertices) {
             newMesh->positions.push_back(vertex.position);
             newMesh->normals.push_back(vertex.normal);
-            newMesh->uvSets["map1"].push_back(vertex.uv);
+            newMesh->uvSets[Mesh::DEFAULT_UV_SET].push_back(vertex.uv);
             newMesh->colors.push_back(glm::vec4(1.0f)); // Default white color
         }
 
@@ -512,7 +512,7 @@ private:
             newMesh->materials.push_back(processMaterial(scene->mMaterials[mesh->mMaterialIndex], scene));
         }
 
-        newMesh->setupBuffers();
+        newMesh->markForUpload();
         //debugMesh(mesh, scene, newMesh);
 
         return newMesh;
@@ -529,6 +529,8 @@ private:
         // Process meshes
         if (node->mNumMeshes > 0) {
             engineNode->mesh = processMesh(scene->mMeshes[node->mMeshes[0]], scene);
+            // props are what gets scattered by the hundred, far ones become billboards
+            engineNode->impostor = true;
         }
 
         // If this node has animations, process them
@@ -596,7 +598,7 @@ private:
 
         // Process children
         for (unsigned int i = 0; i < node->mNumChildren; i++) {
-            auto childNode = std::make_shared<Node>();
+            auto childNode = makePooled<Node, pools::Nodes>();
             childNode->name = node->mChildren[i]->mName.C_Str();
             engineNode->addChild(childNode);
             processNode(node->mChildren[i], scene, childNode);
@@ -621,7 +623,7 @@ public:
             return nullptr;
         }
 
-        auto rootNode = std::make_shared<Node>();
+        auto rootNode = makePooled<Node, pools::Nodes>();
         rootNode->name = "GLB_Root: " + std::string(scene->mRootNode->mName.C_Str());
         processNode(scene->mRootNode, scene, rootNode);
         rootNode->updateWorldTransform();
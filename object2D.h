@@ -1,6 +1,7 @@
 // Node2D.h
 #pragma once
 #include "GameEngine.h"
+#include "glState.h"
 
 
 class Sprite {
@@ -41,8 +42,9 @@ public:
 
     void draw(GLuint shaderProgram) {
         // Bind texture and draw the quad
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        GLStateCache& gl = GLStateCache::getInstance();
+        gl.activeTexture(GL_TEXTURE0);
+        gl.bindTexture(GL_TEXTURE_2D, texture);
 
         // Draw using the shader program...
     }
@@ -1,6 +1,15 @@
 #pragma once
 #include "GameEngine.h"
 #include "misc_funcs.h"
+#include "slotMap.h"
+#include "stringId.h"
+#include "objectPool.h"
+#include "bounds.h"
+#include "glState.h"
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
 
 // Forward declarations
 class Node;
@@ -8,6 +17,22 @@ class Mesh;
 class Material;
 
 
+// a Material's entry in the GPU material table (MaterialTable below). copies start without
+// one, the index goes back to the table when the material dies
+struct MaterialTableSlot {
+    int32_t index = -1;
+    uint64_t checkedFrame = 0;  // last frame the entry was compared with the material
+    uint64_t textureKey = 0;    // hash of the bound texture ids, 0 without textures
+
+    MaterialTableSlot() = default;
+    MaterialTableSlot(const MaterialTableSlot&) {}
+    MaterialTableSlot& operator=(const MaterialTableSlot&) {
+        checkedFrame = 0;   // new values, compare again
+        return *this;
+    }
+    ~MaterialTableSlot();
+};
+
 // Material definition (matches FBX material)
 class Material {
 public:
@@ -77,7 +102,7 @@ public:
         } alphaMode = AlphaMode::Straight;
     };
 
-    std::map<std::string, TextureMap> textureMaps; // "baseColor", "normal", "metallic", etc.
+    std::unordered_map<StringId, TextureMap> textureMaps; // "baseColor"_sid, "normal"_sid, "metallic"_sid, etc.
 
     // Extended properties (matches FBX material properties)
     std::map<std::string, float> numericalProperties;
@@ -107,137 +132,27 @@ public:
         emissionStrength(0.0f),
         alpha(1.0f) {}
 
-    void bind(GLuint shaderProgram) {
-        // Bind PBR base properties
-        glUniform3fv(glGetUniformLocation(shaderProgram, "material.baseColor"), 1, glm::value_ptr(baseColor));
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.subsurface"), subsurface);
-        glUniform3fv(glGetUniformLocation(shaderProgram, "material.subsurfaceRadius"), 1, glm::value_ptr(subsurfaceRadius));
-        glUniform3fv(glGetUniformLocation(shaderProgram, "material.subsurfaceColor"), 1, glm::value_ptr(subsurfaceColor));
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.subsurfaceIOR"), subsurfaceIOR);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.subsurfaceAnisotropy"), subsurfaceAnisotropy);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.metallic"), metallic);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.specular"), specular);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.specularTint"), specularTint);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.roughness"), roughness);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.anisotropic"), anisotropic);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.anisotropicRotation"), anisotropicRotation);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.sheen"), sheen);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.sheenTint"), sheenTint);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.clearcoat"), clearcoat);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.clearcoatRoughness"), clearcoatRoughness);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.ior"), ior);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.transmission"), transmission);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.transmissionRoughness"), transmissionRoughness);
-        glUniform3fv(glGetUniformLocation(shaderProgram, "material.emission"), 1, glm::value_ptr(emission));
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.emissionStrength"), emissionStrength);
-        glUniform1f(glGetUniformLocation(shaderProgram, "material.alpha"), alpha);
-
-        // Define explicit texture units and their properties
-        const struct TextureUnitMapping {
-            std::string name;
-            int unit;
-            std::string uniformName;
-            std::string projectionUniform;
-            std::string offsetUniform;
-            std::string tilingUniform;
-        } textureUnits[] = {
-            {"baseColor", 0, "material.baseColorMap", "material.baseColorProjection", "material.baseColorOffset", "material.baseColorTiling"},
-            {"normal", 1, "material.normalMap", "material.normalProjection", "material.normalOffset", "material.normalTiling"},
-            {"metallic", 2, "material.metallicMap", "material.metallicProjection", "material.metallicOffset", "material.metallicTiling"},
-            {"roughness", 3, "material.roughnessMap", "material.roughnessProjection", "material.roughnessOffset", "material.roughnessTiling"},
-            {"emission", 4, "material.emissionMap", "material.emissionProjection", "material.emissionOffset", "material.emissionTiling"},
-            {"occlusion", 5, "material.occlusionMap", "material.occlusionProjection", "material.occlusionOffset", "material.occlusionTiling"},
-            {"specular", 6, "material.specularMap", "material.specularProjection", "material.specularOffset", "material.specularTiling"},
-            {"transmission", 7, "material.transmissionMap", "material.transmissionProjection", "material.transmissionOffset", "material.transmissionTiling"}
-        };
-
-        // Track bound textures for presence flags
-        std::unordered_map<std::string, bool> boundTextures;
-
-        // Save current OpenGL state
-        GLint lastActiveTexture;
-        glGetIntegerv(GL_ACTIVE_TEXTURE, &lastActiveTexture);
-
-        // Bind textures and their properties
-        for (const auto& mapping : textureUnits) {
-            auto it = textureMaps.find(mapping.name);
-            if (it != textureMaps.end()) {
-                // Activate texture unit and bind texture
-                glActiveTexture(GL_TEXTURE0 + mapping.unit);
-                glBindTexture(GL_TEXTURE_2D, it->second.textureId);
-                // Set texture uniform
-                glUniform1i(glGetUniformLocation(shaderProgram, mapping.uniformName.c_str()), mapping.unit);
-
-                // Set projection mode
-                glUniform1i(glGetUniformLocation(shaderProgram, mapping.projectionUniform.c_str()),
-                    static_cast<int>(it->second.projection));
-
-                // Set UV transform uniforms
-                glUniform2fv(glGetUniformLocation(shaderProgram, mapping.offsetUniform.c_str()), 1,
-                    glm::value_ptr(it->second.offset));
-                glUniform2fv(glGetUniformLocation(shaderProgram, mapping.tilingUniform.c_str()), 1,
-                    glm::value_ptr(it->second.tiling));
-
-                // Track that we bound this texture
-                boundTextures[mapping.name] = true;
-
-#ifdef _DEBUG
-                // Verify texture binding
-                GLint currentTexture;
-                glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTexture);
-                if (currentTexture != it->second.textureId) {
-                    std::cout << "Warning: Texture binding mismatch for " << mapping.name << std::endl;
-                    std::cout << "Expected: " << it->second.textureId << ", Got: " << currentTexture << std::endl;
-                }
-
-                // Check for OpenGL errors
-                GLenum err = glGetError();
-                if (err != GL_NO_ERROR) {
-                    std::cout << "GL Error binding " << mapping.name << " texture: " << err << std::endl;
-                }
-#endif
-            }
-            else {
-                boundTextures[mapping.name] = false;
-            }
-        }
-
-        // Set texture presence flags
-        glUniform1i(glGetUniformLocation(shaderProgram, "material.hasBaseColorMap"), boundTextures["baseColor"]);
-        glUniform1i(glGetUniformLocation(shaderProgram, "material.hasNormalMap"), boundTextures["normal"]);
-        glUniform1i(glGetUniformLocation(shaderProgram, "material.hasMetallicMap"), boundTextures["metallic"]);
-        glUniform1i(glGetUniformLocation(shaderProgram, "material.hasRoughnessMap"), boundTextures["roughness"]);
-        glUniform1i(glGetUniformLocation(shaderProgram, "material.hasEmissionMap"), boundTextures["emission"]);
-        glUniform1i(glGetUniformLocation(shaderProgram, "material.hasOcclusionMap"), boundTextures["occlusion"]);
-        glUniform1i(glGetUniformLocation(shaderProgram, "material.hasSpecularMap"), boundTextures["specular"]);
-        glUniform1i(glGetUniformLocation(shaderProgram, "material.hasTransmissionMap"), boundTextures["transmission"]);
-
-        // Restore previous active texture
-        glActiveTexture(lastActiveTexture);
-
-#ifdef _DEBUG
-        // Debug verification of final state
-        for (const auto& mapping : textureUnits) {
-            if (boundTextures[mapping.name]) {
-                glActiveTexture(GL_TEXTURE0 + mapping.unit);
-                GLint currentTexture;
-                glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTexture);
-                if (currentTexture != textureMaps[mapping.name].textureId) {
-                    std::cout << "Final state mismatch for " << mapping.name << std::endl;
-                }
+    // which map goes on which texture unit, the same in every shader that samples them
+    static constexpr int TEXTURE_UNIT_COUNT = 8;
+    static constexpr struct TextureUnit {
+        StringId name;
+        int unit;
+        const char* samplerName;
+    } textureUnits[TEXTURE_UNIT_COUNT] = {
+        {"baseColor"_sid, 0, "baseColorMap"},
+        {"normal"_sid, 1, "normalMap"},
+        {"metallic"_sid, 2, "metallicMap"},
+        {"roughness"_sid, 3, "roughnessMap"},
+        {"emission"_sid, 4, "emissionMap"},
+        {"occlusion"_sid, 5, "occlusionMap"},
+        {"specular"_sid, 6, "specularMap"},
+        {"transmission"_sid, 7, "transmissionMap"}
+    };
 
-                // Verify uniform values
-                GLint location = glGetUniformLocation(shaderProgram, mapping.uniformName.c_str());
-                GLint value;
-                glGetUniformiv(shaderProgram, location, &value);
-                if (value != mapping.unit) {
-                    std::cout << "Uniform value mismatch for " << mapping.name << std::endl;
-                }
-            }
-        }
-#endif
+    MaterialTableSlot tableSlot;
 
-    }
+    // selects this material's table entry and binds its textures (MaterialTable::bind)
+    void bind(GLuint shaderProgram);
 
     void debug() {
         std::cout << "-- Material Debug --" << std::endl;
@@ -267,8 +182,241 @@ public:
     }
 };
 
+// every material's parameters in one std140 uniform buffer, so a draw selects an entry
+// (materialIndex) and binds textures instead of setting 25 uniforms by name. entries are
+// compared with their material once per frame and only changed ones get uploaded. the
+// buffer is split in pages of PAGE_SIZE entries and the Materials block sees one page at
+// a time. uniform locations and sampler units are looked up once per program.
+// GL thread only, apart from release() which any thread hits by dropping a material
+class MaterialTable {
+public:
+    // vec4s only, so this is also the std140 layout. mirrors MaterialData in the shaders
+    struct Entry {
+        glm::vec4 baseColor;            // a = alpha
+        glm::vec4 subsurfaceColor;      // a = subsurface
+        glm::vec4 subsurfaceRadius;     // a = subsurfaceIOR
+        glm::vec4 surface;              // metallic, specular, specularTint, roughness
+        glm::vec4 sheen;                // anisotropic, anisotropicRotation, sheen, sheenTint
+        glm::vec4 coat;                 // clearcoat, clearcoatRoughness, transmission, transmissionRoughness
+        glm::vec4 emission;             // a = emissionStrength
+        glm::vec4 ior;                  // ior, subsurfaceAnisotropy
+        glm::ivec4 maps;                // x = one bit per texture unit that has a map
+        glm::ivec4 projections[2];      // per texture unit
+        glm::vec4 uvTransforms[Material::TEXTURE_UNIT_COUNT];  // xy offset, zw tiling
+    };
+    static_assert(sizeof(Entry) == 19 * sizeof(glm::vec4), "MaterialTable::Entry must stay std140");
+
+    // 48 entries (14.6 KB) fit the 16 KB block every GL 3.3 driver has to support.
+    // MATERIALS_PER_PAGE in the shaders
+    static constexpr uint32_t PAGE_SIZE = 48;
+    static constexpr GLuint BLOCK_BINDING = 0;
+
+    static MaterialTable& getInstance() {
+        static MaterialTable* table = new MaterialTable();
+        return *table;
+    }
+
+    MaterialTable(const MaterialTable&) = delete;
+    MaterialTable& operator=(const MaterialTable&) = delete;
+
+    // start of the frame, before anything draws
+    void beginFrame() {
+        ++frame;
+        uploads = 0;
+        boundPage = UINT32_MAX;
+        std::lock_guard<std::mutex> lock(releaseMutex);
+        freeSlots.insert(freeSlots.end(), released.begin(), released.end());
+        released.clear();
+    }
+
+    // gives the material an entry if it has none and uploads it if it changed since the
+    // last check, returns the entry's index across all pages
+    uint32_t prepare(Material& material) {
+        MaterialTableSlot& slot = material.tableSlot;
+        if (slot.index < 0) {
+            slot.index = static_cast<int32_t>(allocate());
+            slot.checkedFrame = 0;
+        }
+        if (slot.checkedFrame != frame) {
+            slot.checkedFrame = frame;
+            Entry entry = pack(material, slot.textureKey);
+            Entry& stored = entries[slot.index];
+            if (std::memcmp(&entry, &stored, sizeof(Entry)) != 0) {
+                stored = entry;
+                upload(slot.index);
+            }
+        }
+        return static_cast<uint32_t>(slot.index);
+    }
+
+    static uint32_t pageOf(uint32_t index) { return index / PAGE_SIZE; }
+
+    // for draws without a material of their own (instanced groups of bare meshes)
+    Material& getDefaultMaterial() { return defaultMaterial; }
+
+    // program must be the current one
+    void bind(GLuint program, Material& material) {
+        uint32_t index = prepare(material);
+        bindPage(pageOf(index));
+
+        Program& info = programFor(program);
+        GLint local = static_cast<GLint>(index % PAGE_SIZE);
+        if (info.materialIndex >= 0 && info.lastIndex != local) {
+            glUniform1i(info.materialIndex, local);
+            info.lastIndex = local;
+        }
+        bindTextures(material);
+    }
+
+    // binds the page holding `index`, for instanced groups that carry their own indices
+    void bindPage(uint32_t page) {
+        if (page == boundPage) return;
+        glBindBufferRange(GL_UNIFORM_BUFFER, BLOCK_BINDING, buffer, page * pageStride, PAGE_SIZE * sizeof(Entry));
+        boundPage = page;
+    }
+
+    // any thread, the slot is reused from the next frame on
+    void release(int32_t index) {
+        std::lock_guard<std::mutex> lock(releaseMutex);
+        released.push_back(static_cast<uint32_t>(index));
+    }
+
+    size_t getEntryCount() const { return slotCount - freeSlots.size(); }
+    size_t getPageCount() const { return entries.size() / PAGE_SIZE; }
+    size_t getUploadCount() const { return uploads; }
+
+    // resolves the block binding, materialIndex location and sampler units, call right after
+    // linking with the program current (samplers are plain uniforms on 3.3). bind() still
+    // sets up a program it hasn't seen, for shaders linked somewhere else
+    void setupProgram(GLuint program) { programFor(program); }
+
+private:
+    struct Program {
+        GLint materialIndex = -1;
+        GLint lastIndex = -1;   // uniform values stay with the program, skip repeats
+    };
+
+    std::vector<Entry> entries;     // cpu copy, what the buffer holds
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> released;
+    std::mutex releaseMutex;
+    uint32_t slotCount = 0;
+    std::unordered_map<GLuint, Program> programs;
+    Material defaultMaterial;
+
+    GLuint buffer = 0;
+    GLsizeiptr pageStride = 0;      // page size rounded up to the offset alignment
+    uint32_t boundPage = UINT32_MAX;
+    uint64_t frame = 1;
+    size_t uploads = 0;
+
+    MaterialTable() = default;
+
+    uint32_t allocate() {
+        if (!freeSlots.empty()) {
+            uint32_t index = freeSlots.back();
+            freeSlots.pop_back();
+            return index;
+        }
+        uint32_t index = slotCount++;
+        if (index >= entries.size()) grow(std::max<size_t>(4, getPageCount() * 2));
+        return index;
+    }
+
+    void grow(size_t pages) {
+        if (buffer == 0) {
+            glGenBuffers(1, &buffer);
+            GLint alignment = 256;  // once, not per draw
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+            GLsizeiptr pageBytes = PAGE_SIZE * sizeof(Entry);
+            pageStride = (pageBytes + alignment - 1) / alignment * alignment;
+        }
+        entries.resize(pages * PAGE_SIZE, Entry{});
+
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, pages * pageStride, nullptr, GL_DYNAMIC_DRAW);
+        for (size_t page = 0; page < pages; ++page) {
+            glBufferSubData(GL_UNIFORM_BUFFER, page * pageStride, PAGE_SIZE * sizeof(Entry), &entries[page * PAGE_SIZE]);
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        boundPage = UINT32_MAX;
+    }
+
+    void upload(uint32_t index) {
+        GLintptr offset = pageOf(index) * pageStride + (index % PAGE_SIZE) * sizeof(Entry);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(Entry), &entries[index]);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        ++uploads;
+    }
+
+    static Entry pack(const Material& material, uint64_t& textureKey) {
+        Entry entry{};
+        entry.baseColor = glm::vec4(material.baseColor, material.alpha);
+        entry.subsurfaceColor = glm::vec4(material.subsurfaceColor, material.subsurface);
+        entry.subsurfaceRadius = glm::vec4(material.subsurfaceRadius, material.subsurfaceIOR);
+        entry.surface = glm::vec4(material.metallic, material.specular, material.specularTint, material.roughness);
+        entry.sheen = glm::vec4(material.anisotropic, material.anisotropicRotation, material.sheen, material.sheenTint);
+        entry.coat = glm::vec4(material.clearcoat, material.clearcoatRoughness, material.transmission, material.transmissionRoughness);
+        entry.emission = glm::vec4(material.emission, material.emissionStrength);
+        entry.ior = glm::vec4(material.ior, material.subsurfaceAnisotropy, 0.0f, 0.0f);
+
+        // fnv-1a over (unit, texture), materials with the same textures can share a draw
+        uint64_t key = 14695981039346656037ull;
+        for (const auto& unit : Material::textureUnits) {
+            glm::vec4 transform(0.0f, 0.0f, 1.0f, 1.0f);
+            auto it = material.textureMaps.find(unit.name);
+            if (it != material.textureMaps.end()) {
+                entry.maps.x |= 1 << unit.unit;
+                entry.projections[unit.unit / 4][unit.unit % 4] = static_cast<int>(it->second.projection);
+                transform = glm::vec4(it->second.offset, it->second.tiling);
+                key = (key ^ ((uint64_t(unit.unit) << 32) | it->second.textureId)) * 1099511628211ull;
+            }
+            entry.uvTransforms[unit.unit] = transform;
+        }
+        textureKey = entry.maps.x ? key : 0;
+        return entry;
+    }
+
+    Program& programFor(GLuint program) {
+        auto it = programs.find(program);
+        if (it != programs.end()) return it->second;
+
+        Program info;
+        GLuint block = glGetUniformBlockIndex(program, "Materials");
+        if (block != GL_INVALID_INDEX) glUniformBlockBinding(program, block, BLOCK_BINDING);
+        info.materialIndex = glGetUniformLocation(program, "materialIndex");
+        for (const auto& unit : Material::textureUnits) {
+            GLint location = glGetUniformLocation(program, unit.samplerName);
+            if (location >= 0) glUniform1i(location, unit.unit);
+        }
+        return programs.emplace(program, info).first->second;
+    }
+
+    // the active unit goes back to what it was, callers bind their own textures after this
+    static void bindTextures(const Material& material) {
+        GLStateCache& gl = GLStateCache::getInstance();
+        GLenum lastActiveTexture = gl.getActiveTexture();
+        for (const auto& unit : Material::textureUnits) {
+            auto it = material.textureMaps.find(unit.name);
+            if (it == material.textureMaps.end()) continue;
+            gl.activeTexture(GL_TEXTURE0 + unit.unit);
+            gl.bindTexture(GL_TEXTURE_2D, it->second.textureId);
+        }
+        if (lastActiveTexture != GLStateCache::UNKNOWN) gl.activeTexture(lastActiveTexture);
+    }
+};
+
+inline MaterialTableSlot::~MaterialTableSlot() {
+    if (index >= 0) MaterialTable::getInstance().release(index);
+}
+
+inline void Material::bind(GLuint shaderProgram) {
+    MaterialTable::getInstance().bind(shaderProgram, *this);
+}
+
 // Geometry data (matches FBX mesh attribute)
-class Mesh {
+class Mesh : public std::enable_shared_from_this<Mesh> {
 public:
     // Vertex data
     std::vector<glm::vec3> positions;
@@ -276,7 +424,8 @@ public:
     std::vector<glm::vec3> tangents;
 
     std::vector<glm::vec4> colors;  // Vertex colors (RGBA)
-    std::map<std::string, std::vector<glm::vec2>> uvSets;  // Named UV sets
+    std::unordered_map<StringId, std::vector<glm::vec2>> uvSets;  // Named UV sets
+    static constexpr StringId DEFAULT_UV_SET = "map1"_sid;
     std::vector<unsigned int> indices;
 
     // Material assignments
@@ -286,40 +435,87 @@ public:
     //animation 
     bool isAnimated = false;
 
+    // owned by PrimitiveMeshCache and drawn by many nodes, don't edit it in place
+    bool shared = false;
+
+    // simplified copies, lods[0] is the first level below full detail (meshLod.h).
+    // only valid while lodSourceVersion matches getBoundsVersion()
+    std::vector<std::shared_ptr<Mesh>> lods;
+    uint32_t lodSourceVersion = UINT32_MAX;
+
     // OpenGL buffers
     GLuint VAO, VBO, EBO;
 
+    // set by markForUpload, cleared once setupBuffers has run
+    std::atomic<bool> uploadPending{ false };
+
+    // local space bounds, recomputed on first use after the geometry changed
+    const AABB& getLocalBounds() {
+        if (boundsDirty.exchange(false)) {
+            AABB bounds;
+            for (const auto& p : positions) {
+                bounds.expand(p);
+            }
+            // skinning moves vertices away from the bind pose, give it some room
+            if (isAnimated && bounds.isValid()) {
+                glm::vec3 pad = bounds.getExtents() * 0.5f;
+                bounds = AABB(bounds.min - pad, bounds.max + pad);
+            }
+            localBounds = bounds;
+        }
+        return localBounds;
+    }
+
+    // call after editing positions in place (markForUpload and setupBuffers already do)
+    void invalidateBounds() {
+        boundsDirty = true;
+        boundsVersion.fetch_add(1, std::memory_order_relaxed);
+        boundsEpoch.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t getBoundsVersion() const { return boundsVersion.load(std::memory_order_relaxed); }
+
+    // bumped when any mesh's bounds change, lets the scene skip looking when none did
+    static uint32_t getBoundsEpoch() { return boundsEpoch.load(std::memory_order_relaxed); }
+
     Mesh(bool useDefaultMaterial=true) : VAO(0), VBO(0), EBO(0) {
         // Default UV set
-        uvSets["map1"] = std::vector<glm::vec2>();
+        uvSets[DEFAULT_UV_SET] = std::vector<glm::vec2>();
 
         // use default material
         if (useDefaultMaterial) {
-            materials.push_back(std::make_shared<Material>());
+            materials.push_back(makePooled<Material, pools::Materials>());
         }
     }
 
     Mesh(std::shared_ptr<Material> material) : VAO(0), VBO(0), EBO(0) {
         // Default UV set
-        uvSets["map1"] = std::vector<glm::vec2>();
+        uvSets[DEFAULT_UV_SET] = std::vector<glm::vec2>();
         materials.push_back(material);
     }
 
     Mesh(std::vector<std::shared_ptr<Material>> vecMaterials) : VAO(0), VBO(0), EBO(0) {
         // Default UV set
-        uvSets["map1"] = std::vector<glm::vec2>();
+        uvSets[DEFAULT_UV_SET] = std::vector<glm::vec2>();
         materials = vecMaterials;
     }
 
+    // queues setupBuffers for the next MeshUploadQueue::flush on the GL thread. safe to call
+    // without a GL context (worker threads, ENGINE_HEADLESS), use it instead of setupBuffers
+    // whenever the geometry was just built or changed
+    void markForUpload();
+
     virtual void setupBuffers() {
+        uploadPending = false;
+        invalidateBounds();
         std::cout << "Setting up mesh buffers..." << std::endl;
         std::cout << "Positions: " << positions.size() << std::endl;
         std::cout << "Normals: " << normals.size() << std::endl;
-        std::cout << "UV coords: " << uvSets["map1"].size() << std::endl;
+        std::cout << "UV coords: " << uvSets[DEFAULT_UV_SET].size() << std::endl;
         std::cout << "Indices: " << indices.size() << std::endl;
 
         // Calculate tangents if we have UV coordinates
-        if (!uvSets["map1"].empty()) {
+        if (!uvSets[DEFAULT_UV_SET].empty()) {
             calculateTangents();
         }
 
@@ -328,40 +524,47 @@ public:
         if (VBO == 0) glGenBuffers(1, &VBO);
         if (EBO == 0) glGenBuffers(1, &EBO);
 
-        glBindVertexArray(VAO);
+        GLStateCache& gl = GLStateCache::getInstance();
+        gl.bindVertexArray(VAO);
 
         // Calculate stride and offsets
         size_t stride = sizeof(glm::vec3);  // Position
         if (!normals.empty()) stride += sizeof(glm::vec3);
         if (!colors.empty()) stride += sizeof(glm::vec4);
-        if (!uvSets["map1"].empty()) stride += sizeof(glm::vec2);
+        if (!uvSets[DEFAULT_UV_SET].empty()) stride += sizeof(glm::vec2);
         if (!tangents.empty()) stride += sizeof(glm::vec3);
 
-        // Allocate buffer
-        size_t totalSize = positions.size() * stride;
+        // Interleave on the cpu and upload in one call, a glBufferSubData per attribute
+        // per vertex stalls for seconds on merged static batches
+        const auto& uvs = uvSets[DEFAULT_UV_SET];
+        std::vector<float> interleaved;
+        interleaved.reserve(positions.size() * stride / sizeof(float));
+        auto append = [&](const auto& values, size_t i, size_t components) {
+            const float* data = i < values.size() ? &values[i].x : nullptr;
+            for (size_t c = 0; c < components; c++) {
+                interleaved.push_back(data ? data[c] : 0.0f);
+            }
+        };
+        for (size_t i = 0; i < positions.size(); i++) {
+            append(positions, i, 3);
+            if (!normals.empty()) append(normals, i, 3);
+            if (!colors.empty()) append(colors, i, 4);
+            if (!uvs.empty()) append(uvs, i, 2);
+            if (!tangents.empty()) append(tangents, i, 3);
+        }
+
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, totalSize, nullptr, GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, interleaved.size() * sizeof(float), interleaved.data(), GL_STATIC_DRAW);
 
-        // Upload interleaved data
         size_t offset = 0;
-        size_t currentOffset = 0;
 
         // Positions
-        for (size_t i = 0; i < positions.size(); i++) {
-            glBufferSubData(GL_ARRAY_BUFFER, currentOffset, sizeof(glm::vec3), &positions[i]);
-            currentOffset += stride;
-        }
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
         glEnableVertexAttribArray(0);
         offset += sizeof(glm::vec3);
 
         // Normals
         if (!normals.empty()) {
-            currentOffset = offset;
-            for (size_t i = 0; i < normals.size(); i++) {
-                glBufferSubData(GL_ARRAY_BUFFER, currentOffset, sizeof(glm::vec3), &normals[i]);
-                currentOffset += stride;
-            }
             glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
             glEnableVertexAttribArray(1);
             offset += sizeof(glm::vec3);
@@ -369,23 +572,13 @@ public:
 
         // Colors
         if (!colors.empty()) {
-            currentOffset = offset;
-            for (size_t i = 0; i < colors.size(); i++) {
-                glBufferSubData(GL_ARRAY_BUFFER, currentOffset, sizeof(glm::vec4), &colors[i]);
-                currentOffset += stride;
-            }
             glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offset);
             glEnableVertexAttribArray(2);
             offset += sizeof(glm::vec4);
         }
 
         // UVs
-        if (!uvSets["map1"].empty()) {
-            currentOffset = offset;
-            for (size_t i = 0; i < uvSets["map1"].size(); i++) {
-                glBufferSubData(GL_ARRAY_BUFFER, currentOffset, sizeof(glm::vec2), &uvSets["map1"][i]);
-                currentOffset += stride;
-            }
+        if (!uvs.empty()) {
             glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride, (void*)offset);
             glEnableVertexAttribArray(3);
             offset += sizeof(glm::vec2);
@@ -393,11 +586,6 @@ public:
 
         // Tangents
         if (!tangents.empty()) {
-            currentOffset = offset;
-            for (size_t i = 0; i < tangents.size(); i++) {
-                glBufferSubData(GL_ARRAY_BUFFER, currentOffset, sizeof(glm::vec3), &tangents[i]);
-                currentOffset += stride;
-            }
             glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void*)offset);
             glEnableVertexAttribArray(4);
         }
@@ -409,7 +597,7 @@ public:
                 indices.data(), GL_STATIC_DRAW);
         }
 
-        glBindVertexArray(0);
+        gl.bindVertexArray(0);
     }
 
     void calculateTangents() {
@@ -426,9 +614,9 @@ public:
             const glm::vec3& v1 = positions[i1];
             const glm::vec3& v2 = positions[i2];
 
-            const glm::vec2& uv0 = uvSets["map1"][i0];
-            const glm::vec2& uv1 = uvSets["map1"][i1];
-            const glm::vec2& uv2 = uvSets["map1"][i2];
+            const glm::vec2& uv0 = uvSets[DEFAULT_UV_SET][i0];
+            const glm::vec2& uv1 = uvSets[DEFAULT_UV_SET][i1];
+            const glm::vec2& uv2 = uvSets[DEFAULT_UV_SET][i2];
 
             glm::vec3 edge1 = v1 - v0;
             glm::vec3 edge2 = v2 - v0;
@@ -460,13 +648,14 @@ public:
         }
     }
 
-    void draw(GLuint shaderProgram) {
+    // slot0 replaces materials[0] (Node::material on shared meshes)
+    void draw(GLuint shaderProgram, Material* slot0 = nullptr) {
         // Debug vertex buffer state before drawing
         // std::cout << "Drawing mesh with:" << std::endl;
         // std::cout << "Positions: " << positions.size() << std::endl;
         // std::cout << "Normals: " << normals.size() << std::endl;
         // std::cout << "Colors: " << colors.size() << std::endl;
-        // std::cout << "UVs: " << uvSets["map1"].size() << std::endl;
+        // std::cout << "UVs: " << uvSets[DEFAULT_UV_SET].size() << std::endl;
         // std::cout << "Indices: " << indices.size() << std::endl;
         // std::cout << "VAO: " << VAO << std::endl;
 
@@ -475,46 +664,18 @@ public:
             setupBuffers();
         }
 
-        glBindVertexArray(VAO);
-
-        // Check VAO binding
-        GLint currentVAO;
-        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &currentVAO);
-        //std::cout << "Current VAO binding: " << currentVAO << std::endl;
-
-        // Enable vertex attributes
-        if (!positions.empty()) {
-            glEnableVertexAttribArray(0);
-            // Verify attribute state
-            GLint enabled;
-            glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
-            //std::cout << "Position attribute enabled: " << enabled << std::endl;
-        }
+        // the VAO already has every attribute it uses enabled (setupBuffers), and stays
+        // bound for the next draw, consecutive draws of one mesh skip the bind
+        GLStateCache::getInstance().bindVertexArray(VAO);
 
-        if (!normals.empty()) {
-            glEnableVertexAttribArray(1);
-            GLint enabled;
-            glGetVertexAttribiv(1, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
-            //std::cout << "Normal attribute enabled: " << enabled << std::endl;
-        }
-
-        if (!colors.empty()) {
-            glEnableVertexAttribArray(2);
-            GLint enabled;
-            glGetVertexAttribiv(2, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
-            //std::cout << "Color attribute enabled: " << enabled << std::endl;
-        }
-
-        if (!uvSets["map1"].empty()) {
-            glEnableVertexAttribArray(3);
-            GLint enabled;
-            glGetVertexAttribiv(3, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
-            //std::cout << "UV attribute enabled: " << enabled << std::endl;
-        }
+        auto materialFor = [&](size_t slot) -> Material* {
+            if (slot == 0 && slot0) return slot0;
+            return slot < materials.size() ? materials[slot].get() : nullptr;
+        };
 
         // Bind materials if available
-        if (!materials.empty() && materials[0]) {
-            materials[0]->bind(shaderProgram);
+        if (Material* material = materialFor(0)) {
+            material->bind(shaderProgram);
         }
 
         // Draw with material assignments if available
@@ -535,8 +696,8 @@ public:
                     // Start new group
                     currentMaterial = materialIds[i];
                     startIndex = i * 3;  // Assuming triangles
-                    if (currentMaterial < materials.size()) {
-                        materials[currentMaterial]->bind(shaderProgram);
+                    if (Material* material = currentMaterial >= 0 ? materialFor(currentMaterial) : nullptr) {
+                        material->bind(shaderProgram);
                     }
                 }
             }
@@ -558,26 +719,12 @@ public:
             }
         }
 
-        // Check for OpenGL errors
-        GLenum err;
-        while ((err = glGetError()) != GL_NO_ERROR) {
-            std::cout << "OpenGL error during draw: " << err << std::endl;
-        }
-
-        // Disable vertex attributes
-        if (!positions.empty()) glDisableVertexAttribArray(0);
-        if (!normals.empty()) glDisableVertexAttribArray(1);
-        if (!colors.empty()) glDisableVertexAttribArray(2);
-        if (!uvSets["map1"].empty()) glDisableVertexAttribArray(3);
-
-        glBindVertexArray(0);
+        // errors come through the debug output callback in debug builds (installGLDebugOutput)
     }
 
     void drawShadow(GLuint depthShaderProgram) {
-        glBindVertexArray(VAO);
-
-        // Enable position attribute (location 0) since that's all we need
-        glEnableVertexAttribArray(0);
+        // the depth shader only reads location 0, the rest being enabled costs nothing
+        GLStateCache::getInstance().bindVertexArray(VAO);
 
         // For shadow mapping, we only need positions
         // No need to bind materials or textures since we're only writing depth
@@ -608,9 +755,53 @@ public:
             // Draw everything at once
             glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
         }
+    }
+
+    // model matrix attribute slots for instanced draws (4 columns, 7-10), after the bone slots,
+    // then the material table index (within the bound page)
+    static constexpr GLuint INSTANCE_MODEL_LOCATION = 7;
+    static constexpr GLuint INSTANCE_MATERIAL_LOCATION = 11;
+
+    // what instanceBuffer holds per instance
+    struct InstanceData {
+        glm::mat4 model;
+        GLint material;
+        GLint padding[3];
+    };
+
+    // count copies in one call, reading InstanceData from instanceBuffer at byteOffset.
+    // the caller binds the material page and textures, once for the whole group
+    void drawInstanced(GLuint instanceBuffer, size_t byteOffset, GLsizei count) {
+        if (VAO == 0) setupBuffers();
+
+        GLStateCache::getInstance().bindVertexArray(VAO);
+
+        // pointed at the group's slice every time, the buffer is shared by every mesh
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        for (GLuint column = 0; column < 4; column++) {
+            GLuint location = INSTANCE_MODEL_LOCATION + column;
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                (void*)(byteOffset + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+            glEnableVertexAttribArray(location);
+        }
+        glVertexAttribIPointer(INSTANCE_MATERIAL_LOCATION, 1, GL_INT, sizeof(InstanceData),
+            (void*)(byteOffset + offsetof(InstanceData, material)));
+        glVertexAttribDivisor(INSTANCE_MATERIAL_LOCATION, 1);
+        glEnableVertexAttribArray(INSTANCE_MATERIAL_LOCATION);
 
-        glDisableVertexAttribArray(0); 
-        glBindVertexArray(0);
+        if (!indices.empty()) {
+            glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0, count);
+        }
+        else {
+            glDrawArraysInstanced(GL_TRIANGLES, 0, positions.size(), count);
+        }
+
+        // left enabled they would keep pulling from the instance buffer in plain draws
+        for (GLuint column = 0; column < 4; column++) {
+            glDisableVertexAttribArray(INSTANCE_MODEL_LOCATION + column);
+        }
+        glDisableVertexAttribArray(INSTANCE_MATERIAL_LOCATION);
     }
 
     void drawWireframe() {
@@ -651,13 +842,13 @@ public:
 
         // If buffers are already set up, update them
         if (VAO != 0) {
-            glBindVertexArray(VAO);
+            GLStateCache::getInstance().bindVertexArray(VAO);
 
             // Update normal data
             size_t stride = sizeof(glm::vec3);  // Position
             if (!normals.empty()) stride += sizeof(glm::vec3);
             if (!colors.empty()) stride += sizeof(glm::vec4);
-            if (!uvSets["map1"].empty()) stride += sizeof(glm::vec2);
+            if (!uvSets[DEFAULT_UV_SET].empty()) stride += sizeof(glm::vec2);
             if (!tangents.empty()) stride += sizeof(glm::vec3);
 
             glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -674,7 +865,7 @@ public:
             if (!tangents.empty()) {
                 size_t tangentOffset = normalOffset +
                     ((!colors.empty()) ? sizeof(glm::vec4) : 0) +
-                    ((!uvSets["map1"].empty()) ? sizeof(glm::vec2) : 0);
+                    ((!uvSets[DEFAULT_UV_SET].empty()) ? sizeof(glm::vec2) : 0);
                 currentOffset = tangentOffset;
                 for (size_t i = 0; i < tangents.size(); i++) {
                     glBufferSubData(GL_ARRAY_BUFFER, currentOffset, sizeof(glm::vec3), &tangents[i]);
@@ -687,11 +878,11 @@ public:
             glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
                 indices.data(), GL_STATIC_DRAW);
 
-            glBindVertexArray(0);
+            GLStateCache::getInstance().bindVertexArray(0);
         }
 
         // Recalculate tangents since normals changed
-        if (!uvSets["map1"].empty()) {
+        if (!uvSets[DEFAULT_UV_SET].empty()) {
             calculateTangents();
         }
     }
@@ -701,9 +892,102 @@ public:
         std::cout << "Materials vector size = " << materials.size() << std::endl;
     }
 
+    // frees the GL buffers, setupBuffers() brings them back
+    void releaseBuffers() {
+        if (EBO) glDeleteBuffers(1, &EBO);
+        if (VBO) glDeleteBuffers(1, &VBO);
+        if (VAO) GLStateCache::getInstance().deleteVertexArrays(1, &VAO);
+        VAO = VBO = EBO = 0;
+        uploadPending = false;
+    }
+
+private:
+    AABB localBounds;
+    std::atomic<bool> boundsDirty{ true };
+    std::atomic<uint32_t> boundsVersion{ 0 };
+    inline static std::atomic<uint32_t> boundsEpoch{ 0 };
+
+public:
+    // cpu side vertex/index data, for memory budgets
+    size_t getMemoryBytes() const {
+        size_t bytes = positions.size() * sizeof(glm::vec3) + normals.size() * sizeof(glm::vec3) +
+            tangents.size() * sizeof(glm::vec3) + colors.size() * sizeof(glm::vec4) +
+            indices.size() * sizeof(unsigned int) + materialIds.size() * sizeof(int);
+        for (const auto& [name, uvs] : uvSets) {
+            bytes += uvs.size() * sizeof(glm::vec2);
+        }
+        return bytes;
+    }
+
     virtual ~Mesh() {}  // Makes Mesh polymorphic (can use dynamic cast)
 };
 
+// meshes waiting for their GL buffers. anything can queue (loaders, worker threads),
+// the main loop flushes once per frame before drawing. ENGINE_HEADLESS builds never
+// queue anything, building and loading scenes doesn't need a GL context there
+class MeshUploadQueue {
+private:
+    std::vector<std::weak_ptr<Mesh>> pending;
+    std::mutex mutex;
+
+    MeshUploadQueue() = default;
+
+public:
+    // loader workers can be the first to get here, the static init is thread safe
+    static MeshUploadQueue& getInstance() {
+        static MeshUploadQueue* queue = new MeshUploadQueue();
+        return *queue;
+    }
+
+    MeshUploadQueue(const MeshUploadQueue&) = delete;
+    MeshUploadQueue& operator=(const MeshUploadQueue&) = delete;
+
+    void push(std::weak_ptr<Mesh> mesh) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(mesh));
+    }
+
+    // GL thread only, returns how many meshes were uploaded
+    size_t flush() {
+        std::vector<std::weak_ptr<Mesh>> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch.swap(pending);
+        }
+
+        size_t uploaded = 0;
+        for (const auto& weak : batch) {
+            // gone already, or uploaded directly since it was queued
+            auto mesh = weak.lock();
+            if (!mesh || !mesh->uploadPending) continue;
+            mesh->setupBuffers();
+            ++uploaded;
+        }
+        return uploaded;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pending.size();
+    }
+};
+
+inline void Mesh::markForUpload() {
+    invalidateBounds();
+#ifndef ENGINE_HEADLESS
+    if (uploadPending.exchange(true)) return;
+
+    std::weak_ptr<Mesh> self = weak_from_this();
+    if (self.expired()) {
+        // not owned by a shared_ptr, nothing could keep it alive until the flush.
+        // draw() still uploads it on first use
+        uploadPending = false;
+        return;
+    }
+    MeshUploadQueue::getInstance().push(std::move(self));
+#endif
+}
+
 // maybe this should be MeshType
 enum class NodeType {
     Default,
@@ -749,6 +1033,37 @@ public:
     std::shared_ptr<Mesh> mesh; // mesh has materials
     // std::shared_ptr<Light> light;
 
+    // slot in the scene's flat transform array (transformHierarchy.h). nodes in a scene
+    // get their world matrix recomputed once per frame in the update pass when dirty,
+    // nodes outside a scene still update right away through updateWorldTransform
+    std::vector<uint8_t>* transformDirtyFlags = nullptr;
+    int32_t transformIndex = -1;
+
+    // where the node lives in Scene::sceneNodes, invalid when it isn't in a scene
+    SlotHandle sceneHandle;
+
+    // leaf in the scene's culling tree (mesh nodes only) and the mesh bounds it was fit to
+    int32_t cullProxy = -1;
+    uint32_t cullBoundsVersion = 0;
+
+    // replaces mesh->materials[0] for this node only. primitives share their mesh
+    // (primitiveMeshCache.h), so per node colors have to go here
+    std::shared_ptr<Material> material;
+
+    // low poly and solid, gets rasterized into the occlusion buffer to hide what's behind it
+    bool occluder = false;
+
+    // far enough away it's drawn as a billboard from a baked atlas (impostorRenderer.h)
+    bool impostor = false;
+
+    // never moves at runtime, the scene merges it into a static batch (staticBatcher.h).
+    // staticBatched is set while a batch draws it in place of the node
+    bool isStatic = false;
+    bool staticBatched = false;
+
+    // level picked by MeshLodManager this frame, 0 = the mesh itself
+    uint8_t lodLevel = 0;
+
 
     Node() :
         parent(nullptr),
@@ -770,11 +1085,35 @@ public:
         child->updateWorldTransform();
     }
 
-    virtual void updateWorldTransform() {
-        // Build local transform
+    void removeChild(const Node* child) {
+        auto it = std::find_if(children.begin(), children.end(),
+            [child](const std::shared_ptr<Node>& c) { return c.get() == child; });
+        if (it == children.end()) return;
+        (*it)->parent = nullptr;
+        children.erase(it);
+    }
+
+    glm::mat4 getLocalTransform() const {
         glm::mat4 localTransform = glm::translate(glm::mat4(1.0f), localTranslation);
         localTransform = localTransform * glm::mat4_cast(localRotation);
-        localTransform = glm::scale(localTransform, localScale);
+        return glm::scale(localTransform, localScale);
+    }
+
+    // call after changing localTranslation/localRotation/localScale
+    void markTransformDirty() {
+        if (transformDirtyFlags) {
+            // index is -1 until the hierarchy re-sorts, which dirties everything anyway
+            if (transformIndex >= 0) {
+                (*transformDirtyFlags)[transformIndex] = 1;
+            }
+            return;
+        }
+        updateWorldTransform();
+    }
+
+    virtual void updateWorldTransform() {
+        // Build local transform
+        glm::mat4 localTransform = getLocalTransform();
 
         // Combine with parent transform
         if (parent) {
@@ -817,13 +1156,53 @@ public:
         }
 
         // Update transforms
-        updateWorldTransform();
+        if (transformDirtyFlags) {
+            // own matrix right away so it can be read back, the subtree follows in the update pass
+            worldTransform = parent ? parent->worldTransform * getLocalTransform() : getLocalTransform();
+            markTransformDirty();
+        }
+        else {
+            updateWorldTransform();
+        }
     }
 
     glm::vec3 getWorldPosition() const {
         return glm::vec3(worldTransform[3]);
     }
 
+    // what gets drawn this frame, the mesh or one of its simplified levels
+    Mesh* getLodMesh() const {
+        if (!mesh) return nullptr;
+        return lodLevel > 0 && lodLevel <= mesh->lods.size() ? mesh->lods[lodLevel - 1].get() : mesh.get();
+    }
+
+    // what slot 0 is drawn with
+    std::shared_ptr<Material> getMaterial(size_t slot = 0) const {
+        if (slot == 0 && material) return material;
+        if (mesh && slot < mesh->materials.size()) return mesh->materials[slot];
+        return nullptr;
+    }
+
+    // this node's own material, copied from the mesh on first use so editing it doesn't
+    // recolor every node sharing the mesh
+    std::shared_ptr<Material> ownMaterial() {
+        if (!material) {
+            auto current = getMaterial();
+            material = current ? makePooled<Material, pools::Materials>(*current) : makePooled<Material, pools::Materials>();
+        }
+        return material;
+    }
+
+    // mesh bounds in world space, just the position for nodes without one
+    AABB getWorldBounds() const {
+        if (mesh) {
+            AABB bounds = mesh->getLocalBounds().transformed(worldTransform);
+            if (bounds.isValid()) return bounds;
+        }
+        glm::vec3 position = getWorldPosition();
+        return AABB(position, position);
+    }
+
 };
 
 
@@ -832,7 +1211,7 @@ inline void debugTextureParameters(GLuint textureId) {
     GLint currentTextureBinding;
     glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTextureBinding);
 
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureId);
 
     GLint wrapS, wrapT, minFilter, magFilter;
     glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, &wrapS);
@@ -846,7 +1225,7 @@ inline void debugTextureParameters(GLuint textureId) {
     std::cout << "Min Filter: " << minFilter << " (GL_LINEAR=" << GL_LINEAR << ")\n";
     std::cout << "Mag Filter: " << magFilter << " (GL_LINEAR=" << GL_LINEAR << ")\n";
 
-    glBindTexture(GL_TEXTURE_2D, currentTextureBinding);
+    GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, currentTextureBinding);
 }
 
 // Debug function to check UV coordinates
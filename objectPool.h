@@ -0,0 +1,183 @@
+// objectPool.h
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// fixed size slots carved out of big chunks with a free list on top. fresh chunks hand
+// out slots in address order, so objects spawned together end up next to each other
+// and despawn/respawn reuses the same memory instead of going back to malloc
+class FixedPool {
+public:
+    struct Stats {
+        const char* category = "";
+        size_t slotSize = 0;
+        size_t slotsInUse = 0;
+        size_t peakInUse = 0;
+        size_t slotsTotal = 0;
+        size_t totalAllocations = 0;
+    };
+
+    FixedPool(const char* category, size_t size, size_t align)
+        : category(category),
+          alignment(std::max(align, alignof(void*))),
+          slotSize((std::max(size, sizeof(void*)) + alignment - 1) / alignment * alignment) {
+        slotsPerChunk = std::max<size_t>(CHUNK_SIZE / slotSize, 16);
+    }
+
+    ~FixedPool() {
+        for (void* chunk : chunks) {
+            ::operator delete(chunk, std::align_val_t(alignment));
+        }
+    }
+
+    FixedPool(const FixedPool&) = delete;
+    FixedPool& operator=(const FixedPool&) = delete;
+
+    void* allocate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeList) grow();
+        void* slot = freeList;
+        freeList = *static_cast<void**>(slot);
+        ++slotsInUse;
+        ++totalAllocations;
+        peakInUse = std::max(peakInUse, slotsInUse);
+        return slot;
+    }
+
+    void deallocate(void* slot) {
+        std::lock_guard<std::mutex> lock(mutex);
+        *static_cast<void**>(slot) = freeList;
+        freeList = slot;
+        --slotsInUse;
+    }
+
+    Stats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return { category, slotSize, slotsInUse, peakInUse, slotsPerChunk * chunks.size(), totalAllocations };
+    }
+
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    const char* category;
+    size_t alignment;
+    size_t slotSize;
+    size_t slotsPerChunk;
+
+    mutable std::mutex mutex;
+    void* freeList = nullptr;
+    std::vector<void*> chunks;
+    size_t slotsInUse = 0;
+    size_t peakInUse = 0;
+    size_t totalAllocations = 0;
+
+    void grow() {
+        char* chunk = static_cast<char*>(::operator new(slotsPerChunk * slotSize, std::align_val_t(alignment)));
+        chunks.push_back(chunk);
+
+        // pushed back to front so the first pop is the lowest address
+        for (size_t i = slotsPerChunk; i-- > 0;) {
+            void* slot = chunk + i * slotSize;
+            *static_cast<void**>(slot) = freeList;
+            freeList = slot;
+        }
+    }
+};
+
+// every pool PoolAllocator has created, for the stats table in the debug menu
+class PoolRegistry {
+private:
+    std::vector<FixedPool*> pools;
+    mutable std::mutex mutex;
+
+    PoolRegistry() = default;
+
+public:
+    // function static instead of the usual null check, the first pooled object can be made on a worker
+    static PoolRegistry& getInstance() {
+        static PoolRegistry* registry = new PoolRegistry();
+        return *registry;
+    }
+
+    PoolRegistry(const PoolRegistry&) = delete;
+    PoolRegistry& operator=(const PoolRegistry&) = delete;
+
+    // pools live for the whole run, objects in globals (the scene) can outlive static destructors
+    FixedPool* create(const char* category, size_t size, size_t alignment) {
+        FixedPool* pool = new FixedPool(category, size, alignment);
+        std::lock_guard<std::mutex> lock(mutex);
+        pools.push_back(pool);
+        return pool;
+    }
+
+    std::vector<FixedPool::Stats> getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<FixedPool::Stats> stats;
+        stats.reserve(pools.size());
+        for (const FixedPool* pool : pools) {
+            stats.push_back(pool->getStats());
+        }
+        return stats;
+    }
+};
+
+// categories the pools are reported under
+namespace pools {
+struct Nodes { static constexpr const char* name = "Node"; };
+struct Primitives { static constexpr const char* name = "Primitive"; };
+struct Meshes { static constexpr const char* name = "Mesh"; };
+struct Materials { static constexpr const char* name = "Material"; };
+struct Bodies { static constexpr const char* name = "PhysXBody"; };
+}
+
+// std allocator with one pool per (type, tag). allocate_shared rebinds it to its
+// control block type, so each concrete class gets its own pool sized for
+// object + refcounts in a single slot
+template<typename T, typename Tag>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t count) {
+        if (count != 1) {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+        }
+        return static_cast<T*>(pool().allocate());
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept {
+        if (count != 1) {
+            ::operator delete(ptr, std::align_val_t(alignof(T)));
+            return;
+        }
+        pool().deallocate(ptr);
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U, Tag>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const PoolAllocator<U, Tag>&) const noexcept { return false; }
+
+private:
+    static FixedPool& pool() {
+        // thread safe init, meshes and nodes get built on worker threads too
+        static FixedPool* instance = PoolRegistry::getInstance().create(Tag::name, sizeof(T), alignof(T));
+        return *instance;
+    }
+};
+
+// make_shared, but the object and its control block come from the Tag pool
+template<typename T, typename Tag, typename... Args>
+std::shared_ptr<T> makePooled(Args&&... args) {
+    return std::allocate_shared<T>(PoolAllocator<T, Tag>(), std::forward<Args>(args)...);
+}
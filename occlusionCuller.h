@@ -0,0 +1,285 @@
+// occlusionCuller.h
+#pragma once
+#include "object3D.h"
+#include "bounds.h"
+#include "simd.h"
+#include "jobSystem.h"
+#include "frameArena.h"
+#include <span>
+
+// software occlusion culling, no GPU queries so it behaves the same headless.
+// a few big low poly occluders (boxes, meshes marked occluder) get rasterized into a
+// small depth buffer, 4 pixels at a time, then bounds of everything else that survived
+// frustum culling are tested against it in parallel. the buffer is split into 8x8
+// tiles that keep their farthest depth, most tests finish on the tiles alone
+class OcclusionCuller {
+public:
+    static constexpr int WIDTH = 256;       // multiple of TILE_SIZE (and of 4 for the SIMD rows)
+    static constexpr int HEIGHT = 144;
+    static constexpr int TILE_SIZE = 8;
+    static constexpr int TILES_X = WIDTH / TILE_SIZE;
+    static constexpr int TILES_Y = HEIGHT / TILE_SIZE;
+
+    int maxOccluders = 48;
+    size_t maxOccluderTriangles = 2048;    // bigger meshes cost more to rasterize than they save
+    float minOccluderSize = 0.05f;         // bounding radius / distance, skips specks
+
+    OcclusionCuller() : depth(WIDTH * HEIGHT, 1.0f), tileMax(TILES_X * TILES_Y, 1.0f) {}
+
+    // picks the biggest on screen occluders out of candidates and rasterizes them
+    void renderOccluders(std::span<Node* const> candidates, const glm::mat4& viewProj, const glm::vec3& cameraPos) {
+        viewProjection = viewProj;
+        std::fill(depth.begin(), depth.end(), 1.0f);
+        occluders.clear();
+        triangleCount = 0;
+
+        FrameVector<std::pair<float, Node*>> ranked;
+        for (Node* node : candidates) {
+            if (!node->occluder || !node->mesh || node->mesh->positions.empty()) continue;
+            if (node->mesh->indices.size() / 3 > maxOccluderTriangles) continue;
+
+            AABB bounds = node->getWorldBounds();
+            float radius = glm::length(bounds.getExtents());
+            float distance = std::max(glm::length(bounds.getCenter() - cameraPos), 0.001f);
+            float size = radius / distance;
+            if (size >= minOccluderSize) ranked.push_back({ size, node });
+        }
+
+        size_t count = std::min(ranked.size(), static_cast<size_t>(std::max(maxOccluders, 0)));
+        std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        for (size_t i = 0; i < count; ++i) {
+            rasterizeMesh(*ranked[i].second);
+            occluders.push_back(ranked[i].second);
+        }
+        std::sort(occluders.begin(), occluders.end());
+
+        updateTiles();
+    }
+
+    bool isOccluder(const Node* node) const {
+        return std::binary_search(occluders.begin(), occluders.end(), node);
+    }
+
+    // read only, safe from any number of threads after renderOccluders
+    bool isVisible(const AABB& bounds) const {
+        if (occluders.empty() || !bounds.isValid()) return true;
+
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+        float nearestDepth = FLT_MAX;
+        for (int i = 0; i < 8; ++i) {
+            glm::vec3 corner((i & 1) ? bounds.max.x : bounds.min.x, (i & 2) ? bounds.max.y : bounds.min.y,
+                (i & 4) ? bounds.max.z : bounds.min.z);
+            glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+            // crosses the near plane, can't say anything
+            if (clip.w <= NEAR_W) return true;
+
+            float invW = 1.0f / clip.w;
+            float sx = (clip.x * invW * 0.5f + 0.5f) * WIDTH;
+            float sy = (clip.y * invW * 0.5f + 0.5f) * HEIGHT;
+            minX = std::min(minX, sx);
+            maxX = std::max(maxX, sx);
+            minY = std::min(minY, sy);
+            maxY = std::max(maxY, sy);
+            nearestDepth = std::min(nearestDepth, clip.z * invW * 0.5f + 0.5f);
+        }
+        if (nearestDepth <= 0.0f) return true;
+
+        int x0 = std::max(static_cast<int>(std::floor(minX)), 0);
+        int y0 = std::max(static_cast<int>(std::floor(minY)), 0);
+        int x1 = std::min(static_cast<int>(std::ceil(maxX)), WIDTH - 1);
+        int y1 = std::min(static_cast<int>(std::ceil(maxY)), HEIGHT - 1);
+        // frustum culling let it through, rounding is the only way to get here
+        if (x0 > x1 || y0 > y1) return true;
+
+        for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ++ty) {
+            for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; ++tx) {
+                // whole tile is nearer than the box
+                if (tileMax[ty * TILES_X + tx] < nearestDepth) continue;
+
+                int px0 = std::max(x0, tx * TILE_SIZE), px1 = std::min(x1, tx * TILE_SIZE + TILE_SIZE - 1);
+                int py0 = std::max(y0, ty * TILE_SIZE), py1 = std::min(y1, ty * TILE_SIZE + TILE_SIZE - 1);
+                for (int y = py0; y <= py1; ++y) {
+                    const float* row = depth.data() + y * WIDTH;
+                    for (int x = px0; x <= px1; ++x) {
+                        if (row[x] >= nearestDepth) return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // drops hidden nodes from the list, keeps the order. boundsOf gives a conservative box
+    template<typename List, typename BoundsFn>
+    size_t cull(List& nodes, BoundsFn&& boundsOf) {
+        if (occluders.empty() || nodes.empty()) return 0;
+
+        FrameVector<uint8_t> visible(nodes.size(), 1);
+        JobSystem::getInstance().parallelFor(nodes.size(), 64, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!isOccluder(nodes[i])) {
+                    visible[i] = isVisible(boundsOf(nodes[i]));
+                }
+            }
+        });
+
+        size_t kept = 0;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (visible[i]) nodes[kept++] = nodes[i];
+        }
+        size_t culled = nodes.size() - kept;
+        nodes.resize(kept);
+        return culled;
+    }
+
+    size_t getOccluderCount() const { return occluders.size(); }
+    size_t getTriangleCount() const { return triangleCount; }
+    const float* getDepthBuffer() const { return depth.data(); }
+
+private:
+    static constexpr float NEAR_W = 1e-4f;
+
+    AlignedVector<float> depth;     // 0 near .. 1 far, rows bottom up like NDC
+    std::vector<float> tileMax;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    std::vector<const Node*> occluders;     // sorted, for isOccluder
+    size_t triangleCount = 0;
+
+    struct ScreenVertex {
+        float x, y, z;
+        bool valid;
+    };
+
+    void rasterizeMesh(const Node& node) {
+        const Mesh& mesh = *node.mesh;
+        glm::mat4 mvp = viewProjection * node.worldTransform;
+
+        FrameVector<ScreenVertex> projected(mesh.positions.size());
+        for (size_t i = 0; i < mesh.positions.size(); ++i) {
+            glm::vec4 clip = mvp * glm::vec4(mesh.positions[i], 1.0f);
+            ScreenVertex& v = projected[i];
+            v.valid = clip.w > NEAR_W;
+            if (!v.valid) continue;
+            float invW = 1.0f / clip.w;
+            v.x = (clip.x * invW * 0.5f + 0.5f) * WIDTH;
+            v.y = (clip.y * invW * 0.5f + 0.5f) * HEIGHT;
+            v.z = clip.z * invW * 0.5f + 0.5f;
+        }
+
+        auto triangle = [&](uint32_t a, uint32_t b, uint32_t c) {
+            if (a >= projected.size() || b >= projected.size() || c >= projected.size()) return;
+            // near plane clipping isn't worth it here, dropping the triangle only loses occlusion
+            if (!projected[a].valid || !projected[b].valid || !projected[c].valid) return;
+            rasterizeTriangle(projected[a], projected[b], projected[c]);
+            ++triangleCount;
+        };
+
+        if (!mesh.indices.empty()) {
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+                triangle(mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]);
+            }
+        }
+        else {
+            for (uint32_t i = 0; i + 2 < projected.size(); i += 3) {
+                triangle(i, i + 1, i + 2);
+            }
+        }
+    }
+
+    // edge functions at pixel centers, both windings, nearest depth wins
+    void rasterizeTriangle(ScreenVertex v0, ScreenVertex v1, ScreenVertex v2) {
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (std::abs(area) < 1e-6f) return;
+        if (area < 0.0f) {
+            std::swap(v1, v2);
+            area = -area;
+        }
+
+        int minX = std::max(static_cast<int>(std::floor(std::min({ v0.x, v1.x, v2.x }))), 0);
+        int maxX = std::min(static_cast<int>(std::ceil(std::max({ v0.x, v1.x, v2.x }))), WIDTH - 1);
+        int minY = std::max(static_cast<int>(std::floor(std::min({ v0.y, v1.y, v2.y }))), 0);
+        int maxY = std::min(static_cast<int>(std::ceil(std::max({ v0.y, v1.y, v2.y }))), HEIGHT - 1);
+        if (minX > maxX || minY > maxY) return;
+
+        // E(x, y) = A x + B y + C, >= 0 inside
+        auto edge = [](const ScreenVertex& a, const ScreenVertex& b, float& A, float& B, float& C) {
+            A = a.y - b.y;
+            B = b.x - a.x;
+            C = -(A * a.x + B * a.y);
+        };
+        float A0, B0, C0, A1, B1, C1, A2, B2, C2;
+        edge(v1, v2, A0, B0, C0);   // weight of v0
+        edge(v2, v0, A1, B1, C1);   // weight of v1
+        edge(v0, v1, A2, B2, C2);   // weight of v2
+
+        // z/w is linear in screen space
+        float invArea = 1.0f / area;
+        float zA = (A1 * (v1.z - v0.z) + A2 * (v2.z - v0.z)) * invArea;
+        float zB = (B1 * (v1.z - v0.z) + B2 * (v2.z - v0.z)) * invArea;
+        float zC = v0.z + (C1 * (v1.z - v0.z) + C2 * (v2.z - v0.z)) * invArea;
+
+        int startX = minX & ~3;
+#ifdef ENGINE_SIMD_SSE
+        const __m128 laneOffset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        for (int y = minY; y <= maxY; ++y) {
+            float py = y + 0.5f;
+            __m128 rowE0 = _mm_set1_ps(B0 * py + C0);
+            __m128 rowE1 = _mm_set1_ps(B1 * py + C1);
+            __m128 rowE2 = _mm_set1_ps(B2 * py + C2);
+            __m128 rowZ = _mm_set1_ps(zB * py + zC);
+            float* row = depth.data() + y * WIDTH;
+
+            for (int x = startX; x <= maxX; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffset);
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A0), px), rowE0);
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A1), px), rowE1);
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A2), px), rowE2);
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                    _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside) == 0) continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zA), px), rowZ);
+                z = _mm_min_ps(_mm_max_ps(z, zero), one);
+                __m128 old = _mm_load_ps(row + x);
+                __m128 nearest = _mm_min_ps(old, z);
+                _mm_store_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+        }
+#else
+        for (int y = minY; y <= maxY; ++y) {
+            float py = y + 0.5f;
+            float* row = depth.data() + y * WIDTH;
+            for (int x = startX; x <= maxX; ++x) {
+                float px = x + 0.5f;
+                if (A0 * px + B0 * py + C0 < 0.0f || A1 * px + B1 * py + C1 < 0.0f || A2 * px + B2 * py + C2 < 0.0f) continue;
+                float z = std::clamp(zA * px + zB * py + zC, 0.0f, 1.0f);
+                row[x] = std::min(row[x], z);
+            }
+        }
+#endif
+    }
+
+    void updateTiles() {
+        for (int ty = 0; ty < TILES_Y; ++ty) {
+            for (int tx = 0; tx < TILES_X; ++tx) {
+                float farthest = 0.0f;
+                for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; ++y) {
+                    const float* row = depth.data() + y * WIDTH + tx * TILE_SIZE;
+#ifdef ENGINE_SIMD_SSE
+                    __m128 m = _mm_max_ps(_mm_load_ps(row), _mm_load_ps(row + 4));
+                    m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+                    m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+                    farthest = std::max(farthest, _mm_cvtss_f32(m));
+#else
+                    for (int x = 0; x < TILE_SIZE; ++x) farthest = std::max(farthest, row[x]);
+#endif
+                }
+                tileMax[ty * TILES_X + tx] = farthest;
+            }
+        }
+    }
+};
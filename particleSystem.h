@@ -0,0 +1,462 @@
+// particleSystem.h
+#pragma once
+#include "GameEngine.h"
+#include "glState.h"
+#include "simd.h"
+#include "jobSystem.h"
+#include "shader.h"
+#include "paths.h"
+#include "PhysXManager.h"
+
+// cheap effects (sparks, dust, debris) that don't need a PhysXBody + SphereNode per particle.
+// particles are kept in SoA arrays so the update kernels can run 4 at a time,
+// and each emitter is drawn with a single point sprite draw call
+
+enum class ParticleCollisionMode {
+    None,
+    Plane,        // infinite plane, dot(planeNormal, p) = planeOffset
+    Heightfield,  // heightfield(x, z) returns the ground height
+    SceneQuery    // raycast against the PhysX scene, most expensive
+};
+
+struct ParticleEmitterSettings {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 direction = glm::vec3(0.0f, 1.0f, 0.0f);
+    float spreadAngle = glm::radians(25.0f);   // half angle of the emission cone
+    float emissionRate = 1000.0f;              // particles per second, 0 for burst only
+
+    float minSpeed = 2.0f;
+    float maxSpeed = 4.0f;
+    float minLifetime = 1.0f;
+    float maxLifetime = 2.0f;
+
+    glm::vec3 gravity = glm::vec3(0.0f, -9.8f, 0.0f);
+    float drag = 0.1f;
+
+    // size is the world space diameter of the sprite
+    float startSize = 0.05f;
+    float endSize = 0.02f;
+    glm::vec4 startColor = glm::vec4(1.0f, 0.8f, 0.3f, 1.0f);
+    glm::vec4 endColor = glm::vec4(0.8f, 0.2f, 0.0f, 0.0f);
+    bool additive = true;
+
+    size_t maxParticles = 10000;
+
+    ParticleCollisionMode collisionMode = ParticleCollisionMode::None;
+    glm::vec3 planeNormal = glm::vec3(0.0f, 1.0f, 0.0f);
+    float planeOffset = 0.0f;
+    std::function<float(float, float)> heightfield;
+    float restitution = 0.3f;
+    float friction = 0.2f;
+};
+
+class ParticleEmitter {
+public:
+    ParticleEmitterSettings settings;
+    bool emitting = true;
+    bool visible = true;
+
+    ParticleEmitter(const ParticleEmitterSettings& emitterSettings)
+        : settings(emitterSettings), rng(std::random_device{}()) {
+        settings.planeNormal = glm::normalize(settings.planeNormal);
+        reserve(settings.maxParticles);
+    }
+
+    ~ParticleEmitter() {
+        if (vbo) glDeleteBuffers(1, &vbo);
+        if (vao) GLStateCache::getInstance().deleteVertexArrays(1, &vao);
+    }
+
+    ParticleEmitter(const ParticleEmitter&) = delete;
+    ParticleEmitter& operator=(const ParticleEmitter&) = delete;
+
+    size_t getParticleCount() const { return count; }
+
+    // spawn n particles right now (explosions, impacts)
+    void burst(size_t n) {
+        spawn(n);
+    }
+
+    void clear() {
+        count = 0;
+        emitAccumulator = 0.0f;
+    }
+
+    void update(float deltaTime) {
+        if (deltaTime <= 0.0f) return;
+
+        if (emitting && settings.emissionRate > 0.0f) {
+            emitAccumulator += settings.emissionRate * deltaTime;
+            size_t toSpawn = static_cast<size_t>(emitAccumulator);
+            emitAccumulator -= static_cast<float>(toSpawn);
+            spawn(toSpawn);
+        }
+
+        if (count == 0) return;
+
+        // work in whole 4-wide blocks, padding lanes past count are harmless
+        size_t blockCount = simdPadding(count) / 4;
+        JobSystem::getInstance().parallelFor(blockCount, 1024, [&](size_t begin, size_t end) {
+            integrate(begin * 4, end * 4, deltaTime);
+            switch (settings.collisionMode) {
+            case ParticleCollisionMode::Plane:
+                collidePlane(begin * 4, end * 4);
+                break;
+            case ParticleCollisionMode::Heightfield:
+                collideHeightfield(begin * 4, std::min(end * 4, count));
+                break;
+            case ParticleCollisionMode::SceneQuery:
+                collideSceneQuery(begin * 4, std::min(end * 4, count), deltaTime);
+                break;
+            default:
+                break;
+            }
+        });
+
+        removeDead();
+        gpuDirty = true;
+    }
+
+    // expects the particle program to be bound already (see ParticleSystem::render)
+    void draw() {
+        if (!visible || count == 0) return;
+
+        if (vao == 0) {
+            setupBuffers();
+        }
+
+        if (gpuDirty) {
+            buildGpuData();
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            // orphan the old storage so we don't stall on last frame's draw
+            glBufferData(GL_ARRAY_BUFFER, gpuData.size() * sizeof(float), nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, count * FLOATS_PER_PARTICLE * sizeof(float), gpuData.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            gpuDirty = false;
+        }
+
+        GLStateCache::getInstance().bindVertexArray(vao);
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(count));
+        GLStateCache::getInstance().bindVertexArray(0);
+    }
+
+private:
+    static const size_t FLOATS_PER_PARTICLE = 8; // xyz + size, rgba
+
+    AlignedVector<float> posX, posY, posZ;
+    AlignedVector<float> velX, velY, velZ;
+    AlignedVector<float> age, lifetime;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    float emitAccumulator = 0.0f;
+    std::mt19937 rng;
+
+    std::vector<float> gpuData;
+    bool gpuDirty = false;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+
+    void reserve(size_t maxParticles) {
+        capacity = simdPadding(std::max<size_t>(maxParticles, 4));
+        for (auto* arr : { &posX, &posY, &posZ, &velX, &velY, &velZ, &age }) {
+            arr->assign(capacity, 0.0f);
+        }
+        lifetime.assign(capacity, 1.0f);
+        gpuData.resize(capacity * FLOATS_PER_PARTICLE);
+    }
+
+    void spawn(size_t n) {
+        n = std::min(n, settings.maxParticles - std::min(settings.maxParticles, count));
+        if (n == 0) return;
+
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        // basis around the emit direction for sampling the cone
+        glm::vec3 dir = glm::normalize(settings.direction);
+        glm::vec3 helper = std::abs(dir.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 tangent = glm::normalize(glm::cross(helper, dir));
+        glm::vec3 bitangent = glm::cross(dir, tangent);
+        float cosSpread = std::cos(settings.spreadAngle);
+
+        for (size_t k = 0; k < n; ++k) {
+            size_t i = count++;
+
+            float cosTheta = glm::mix(cosSpread, 1.0f, unit(rng));
+            float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+            float phi = unit(rng) * glm::two_pi<float>();
+            glm::vec3 v = (tangent * std::cos(phi) * sinTheta + bitangent * std::sin(phi) * sinTheta + dir * cosTheta)
+                * glm::mix(settings.minSpeed, settings.maxSpeed, unit(rng));
+
+            posX[i] = settings.position.x;
+            posY[i] = settings.position.y;
+            posZ[i] = settings.position.z;
+            velX[i] = v.x;
+            velY[i] = v.y;
+            velZ[i] = v.z;
+            age[i] = 0.0f;
+            lifetime[i] = glm::mix(settings.minLifetime, settings.maxLifetime, unit(rng));
+        }
+    }
+
+    // v += g*dt, v *= damping, p += v*dt, age += dt
+    void integrate(size_t begin, size_t end, float dt) {
+        const float damping = std::max(0.0f, 1.0f - settings.drag * dt);
+#ifdef ENGINE_SIMD_SSE
+        const __m128 vdt = _mm_set1_ps(dt);
+        const __m128 vdamp = _mm_set1_ps(damping);
+        const __m128 gdtX = _mm_set1_ps(settings.gravity.x * dt);
+        const __m128 gdtY = _mm_set1_ps(settings.gravity.y * dt);
+        const __m128 gdtZ = _mm_set1_ps(settings.gravity.z * dt);
+
+        for (size_t i = begin; i < end; i += 4) {
+            __m128 vx = _mm_mul_ps(_mm_add_ps(_mm_load_ps(&velX[i]), gdtX), vdamp);
+            __m128 vy = _mm_mul_ps(_mm_add_ps(_mm_load_ps(&velY[i]), gdtY), vdamp);
+            __m128 vz = _mm_mul_ps(_mm_add_ps(_mm_load_ps(&velZ[i]), gdtZ), vdamp);
+            _mm_store_ps(&velX[i], vx);
+            _mm_store_ps(&velY[i], vy);
+            _mm_store_ps(&velZ[i], vz);
+
+            _mm_store_ps(&posX[i], _mm_add_ps(_mm_load_ps(&posX[i]), _mm_mul_ps(vx, vdt)));
+            _mm_store_ps(&posY[i], _mm_add_ps(_mm_load_ps(&posY[i]), _mm_mul_ps(vy, vdt)));
+            _mm_store_ps(&posZ[i], _mm_add_ps(_mm_load_ps(&posZ[i]), _mm_mul_ps(vz, vdt)));
+
+            _mm_store_ps(&age[i], _mm_add_ps(_mm_load_ps(&age[i]), vdt));
+        }
+#else
+        const glm::vec3 gdt = settings.gravity * dt;
+        for (size_t i = begin; i < end; ++i) {
+            velX[i] = (velX[i] + gdt.x) * damping;
+            velY[i] = (velY[i] + gdt.y) * damping;
+            velZ[i] = (velZ[i] + gdt.z) * damping;
+            posX[i] += velX[i] * dt;
+            posY[i] += velY[i] * dt;
+            posZ[i] += velZ[i] * dt;
+            age[i] += dt;
+        }
+#endif
+    }
+
+    // push particles out of the plane and reflect the normal velocity
+    void collidePlane(size_t begin, size_t end) {
+        const glm::vec3 n = settings.planeNormal;
+        const float bounce = 1.0f + settings.restitution;
+#ifdef ENGINE_SIMD_SSE
+        const __m128 nx = _mm_set1_ps(n.x);
+        const __m128 ny = _mm_set1_ps(n.y);
+        const __m128 nz = _mm_set1_ps(n.z);
+        const __m128 offset = _mm_set1_ps(settings.planeOffset);
+        const __m128 vbounce = _mm_set1_ps(bounce);
+        const __m128 vfriction = _mm_set1_ps(settings.friction);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        for (size_t i = begin; i < end; i += 4) {
+            __m128 px = _mm_load_ps(&posX[i]);
+            __m128 py = _mm_load_ps(&posY[i]);
+            __m128 pz = _mm_load_ps(&posZ[i]);
+
+            __m128 dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, px), _mm_mul_ps(ny, py)), _mm_mul_ps(nz, pz)), offset);
+            __m128 hit = _mm_cmplt_ps(dist, zero);
+            if (_mm_movemask_ps(hit) == 0) continue;
+
+            __m128 pen = _mm_min_ps(dist, zero);
+            _mm_store_ps(&posX[i], _mm_sub_ps(px, _mm_mul_ps(nx, pen)));
+            _mm_store_ps(&posY[i], _mm_sub_ps(py, _mm_mul_ps(ny, pen)));
+            _mm_store_ps(&posZ[i], _mm_sub_ps(pz, _mm_mul_ps(nz, pen)));
+
+            __m128 vx = _mm_load_ps(&velX[i]);
+            __m128 vy = _mm_load_ps(&velY[i]);
+            __m128 vz = _mm_load_ps(&velZ[i]);
+            __m128 vn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, vx), _mm_mul_ps(ny, vy)), _mm_mul_ps(nz, vz));
+            __m128 impulse = _mm_mul_ps(_mm_and_ps(hit, _mm_min_ps(vn, zero)), vbounce);
+            __m128 keep = _mm_sub_ps(one, _mm_and_ps(hit, vfriction));
+
+            _mm_store_ps(&velX[i], _mm_mul_ps(_mm_sub_ps(vx, _mm_mul_ps(nx, impulse)), keep));
+            _mm_store_ps(&velY[i], _mm_mul_ps(_mm_sub_ps(vy, _mm_mul_ps(ny, impulse)), keep));
+            _mm_store_ps(&velZ[i], _mm_mul_ps(_mm_sub_ps(vz, _mm_mul_ps(nz, impulse)), keep));
+        }
+#else
+        for (size_t i = begin; i < end; ++i) {
+            float dist = n.x * posX[i] + n.y * posY[i] + n.z * posZ[i] - settings.planeOffset;
+            if (dist >= 0.0f) continue;
+
+            posX[i] -= n.x * dist;
+            posY[i] -= n.y * dist;
+            posZ[i] -= n.z * dist;
+
+            float vn = std::min(0.0f, n.x * velX[i] + n.y * velY[i] + n.z * velZ[i]) * bounce;
+            float keep = 1.0f - settings.friction;
+            velX[i] = (velX[i] - n.x * vn) * keep;
+            velY[i] = (velY[i] - n.y * vn) * keep;
+            velZ[i] = (velZ[i] - n.z * vn) * keep;
+        }
+#endif
+    }
+
+    // treats the ground as locally flat, good enough for dust and sparks
+    void collideHeightfield(size_t begin, size_t end) {
+        if (!settings.heightfield) return;
+        const float keep = 1.0f - settings.friction;
+        for (size_t i = begin; i < end; ++i) {
+            float ground = settings.heightfield(posX[i], posZ[i]);
+            if (posY[i] >= ground) continue;
+            posY[i] = ground;
+            if (velY[i] < 0.0f) velY[i] = -velY[i] * settings.restitution;
+            velX[i] *= keep;
+            velZ[i] *= keep;
+        }
+    }
+
+    // raycast along this step's movement, only safe outside simulate()/fetchResults
+    void collideSceneQuery(size_t begin, size_t end, float dt) {
+        PxScene* pxScene = PhysXManager::getInstance().getScene();
+        if (!pxScene) return;
+
+        const float keep = 1.0f - settings.friction;
+        for (size_t i = begin; i < end; ++i) {
+            glm::vec3 v(velX[i], velY[i], velZ[i]);
+            float speed = glm::length(v);
+            float dist = speed * dt;
+            if (dist < 1e-5f) continue;
+
+            glm::vec3 dir = v / speed;
+            glm::vec3 origin = glm::vec3(posX[i], posY[i], posZ[i]) - v * dt;
+
+            PxRaycastBuffer hit;
+            if (!pxScene->raycast(PxVec3(origin.x, origin.y, origin.z), PxVec3(dir.x, dir.y, dir.z), dist, hit,
+                PxHitFlag::ePOSITION | PxHitFlag::eNORMAL) || !hit.hasBlock) {
+                continue;
+            }
+
+            glm::vec3 n(hit.block.normal.x, hit.block.normal.y, hit.block.normal.z);
+            glm::vec3 p = glm::vec3(hit.block.position.x, hit.block.position.y, hit.block.position.z) + n * 0.001f;
+            float vn = glm::dot(v, n);
+            if (vn < 0.0f) v -= (1.0f + settings.restitution) * vn * n;
+            v *= keep;
+
+            posX[i] = p.x; posY[i] = p.y; posZ[i] = p.z;
+            velX[i] = v.x; velY[i] = v.y; velZ[i] = v.z;
+        }
+    }
+
+    // swap dead particles with the last live one, keeps the arrays dense
+    void removeDead() {
+        size_t i = 0;
+        while (i < count) {
+            if (age[i] < lifetime[i]) {
+                ++i;
+                continue;
+            }
+            size_t last = --count;
+            posX[i] = posX[last]; posY[i] = posY[last]; posZ[i] = posZ[last];
+            velX[i] = velX[last]; velY[i] = velY[last]; velZ[i] = velZ[last];
+            age[i] = age[last];
+            lifetime[i] = lifetime[last];
+        }
+    }
+
+    void buildGpuData() {
+        JobSystem::getInstance().parallelFor(count, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                float t = std::clamp(age[i] / lifetime[i], 0.0f, 1.0f);
+                glm::vec4 color = glm::mix(settings.startColor, settings.endColor, t);
+                float* out = &gpuData[i * FLOATS_PER_PARTICLE];
+                out[0] = posX[i];
+                out[1] = posY[i];
+                out[2] = posZ[i];
+                out[3] = glm::mix(settings.startSize, settings.endSize, t);
+                out[4] = color.r;
+                out[5] = color.g;
+                out[6] = color.b;
+                out[7] = color.a;
+            }
+        });
+    }
+
+    void setupBuffers() {
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+
+        GLStateCache::getInstance().bindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, gpuData.size() * sizeof(float), nullptr, GL_STREAM_DRAW);
+
+        GLsizei stride = FLOATS_PER_PARTICLE * sizeof(float);
+        // position + size
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        // color
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(4 * sizeof(float)));
+
+        GLStateCache::getInstance().bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+
+class ParticleSystem {
+public:
+    std::vector<std::shared_ptr<ParticleEmitter>> emitters;
+
+    std::shared_ptr<ParticleEmitter> addEmitter(const ParticleEmitterSettings& settings) {
+        auto emitter = std::make_shared<ParticleEmitter>(settings);
+        emitters.push_back(emitter);
+        return emitter;
+    }
+
+    void removeEmitter(const std::shared_ptr<ParticleEmitter>& emitter) {
+        emitters.erase(std::remove(emitters.begin(), emitters.end(), emitter), emitters.end());
+    }
+
+    void update(float deltaTime) {
+        for (auto& emitter : emitters) {
+            emitter->update(deltaTime);
+        }
+    }
+
+    size_t getParticleCount() const {
+        size_t total = 0;
+        for (const auto& emitter : emitters) {
+            total += emitter->getParticleCount();
+        }
+        return total;
+    }
+
+    // drawn after the skybox since particles don't write depth
+    void render(const glm::mat4& view, const glm::mat4& projection, int viewportHeight) {
+        if (emitters.empty()) return;
+
+        if (shaderProgram == 0) {
+            Shader particleShader(Paths::Shaders::particleVertexShader.c_str(), Paths::Shaders::particleFragmentShader.c_str());
+            shaderProgram = particleShader.getShaderProgram();
+        }
+
+        GLStateCache& gl = GLStateCache::getInstance();
+        gl.useProgram(shaderProgram);
+        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        glUniform1f(glGetUniformLocation(shaderProgram, "viewportHeight"), static_cast<float>(viewportHeight));
+
+        glEnable(GL_PROGRAM_POINT_SIZE);
+        gl.enable(GL_BLEND);
+        gl.depthMask(GL_FALSE);
+
+        for (auto& emitter : emitters) {
+            if (emitter->settings.additive) {
+                gl.blendFunc(GL_SRC_ALPHA, GL_ONE);
+            }
+            else {
+                gl.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            }
+            emitter->draw();
+        }
+
+        gl.depthMask(GL_TRUE);
+        gl.disable(GL_BLEND);
+        glDisable(GL_PROGRAM_POINT_SIZE);
+    }
+
+private:
+    GLuint shaderProgram = 0;
+};
@@ -13,6 +13,12 @@ namespace Paths {
         const std::string backgroundFragmentShader = getProjectRoot() + "/shaders/background_fragment.glsl";
         const std::string skyboxVertexShader = getProjectRoot() + "/shaders/skybox_vertex.glsl";
         const std::string skyboxFragmentShader = getProjectRoot() + "/shaders/skybox_fragment.glsl";
+        const std::string particleVertexShader = getProjectRoot() + "/shaders/particle_vertex.glsl";
+        const std::string particleFragmentShader = getProjectRoot() + "/shaders/particle_fragment.glsl";
+        const std::string impostorBakeVertexShader = getProjectRoot() + "/shaders/impostor_bake_vertex.glsl";
+        const std::string impostorBakeFragmentShader = getProjectRoot() + "/shaders/impostor_bake_fragment.glsl";
+        const std::string impostorVertexShader = getProjectRoot() + "/shaders/impostor_vertex.glsl";
+        const std::string impostorFragmentShader = getProjectRoot() + "/shaders/impostor_fragment.glsl";
     }
 
     namespace Textures {
@@ -20,6 +26,11 @@ namespace Paths {
         const std::string defaultTexture = getProjectRoot() + "/textures/default.png";
     }
 
+    namespace Scenes {
+        const std::string defaultScene = getProjectRoot() + "/scenes/default.gscn";
+        const std::string worldManifest = getProjectRoot() + "/scenes/world.cells";
+    }
+
     namespace Models {
         const std::string cube = getProjectRoot() + "/models/cube.obj";
         const std::string sphere = getProjectRoot() + "/models/sphere.obj";
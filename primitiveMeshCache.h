@@ -0,0 +1,86 @@
+// primitiveMeshCache.h
+#pragma once
+#include "object3D.h"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+// one mesh per (primitive type, constructor params), shared by every node built with
+// the same arguments. spawning a thousand identical spheres generates and uploads the
+// geometry once, and the instanced renderer sees a single mesh. cached meshes are
+// marked shared and must not be edited, per node colors go in Node::material
+class PrimitiveMeshCache {
+private:
+    struct Key {
+        NodeType type;
+        float params[4];
+
+        bool operator<(const Key& other) const {
+            return std::tie(type, params[0], params[1], params[2], params[3]) <
+                std::tie(other.type, other.params[0], other.params[1], other.params[2], other.params[3]);
+        }
+    };
+
+    std::map<Key, std::shared_ptr<Mesh>> meshes;
+    mutable std::mutex mutex;
+
+    PrimitiveMeshCache() = default;
+
+public:
+    // past this many distinct shapes new ones are built uncached, random sizes would
+    // otherwise pin every mesh ever spawned
+    size_t maxEntries = 256;
+
+    // function static like PoolRegistry, primitives get built on loader threads too
+    static PrimitiveMeshCache& getInstance() {
+        static PrimitiveMeshCache* cache = new PrimitiveMeshCache();
+        return *cache;
+    }
+
+    PrimitiveMeshCache(const PrimitiveMeshCache&) = delete;
+    PrimitiveMeshCache& operator=(const PrimitiveMeshCache&) = delete;
+
+    // build fills an empty mesh (with one default material) the first time a key is seen
+    std::shared_ptr<Mesh> get(NodeType type, std::initializer_list<float> params, const std::function<void(Mesh&)>& build) {
+        Key key{ type, {} };
+        std::copy_n(params.begin(), std::min<size_t>(params.size(), 4), key.params);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = meshes.find(key);
+            if (it != meshes.end()) return it->second;
+        }
+
+        // built outside the lock, two threads racing on a new key both build and one wins
+        auto mesh = makePooled<Mesh, pools::Meshes>();
+        build(*mesh);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (meshes.size() >= maxEntries) {
+            mesh->markForUpload();
+            return mesh;
+        }
+        auto [it, inserted] = meshes.emplace(key, mesh);
+        if (inserted) {
+            mesh->shared = true;
+            mesh->markForUpload();
+        }
+        return it->second;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return meshes.size();
+    }
+
+    size_t getMemoryBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t bytes = 0;
+        for (const auto& [key, mesh] : meshes) {
+            bytes += mesh->getMemoryBytes();
+        }
+        return bytes;
+    }
+};
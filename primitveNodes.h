@@ -1,6 +1,7 @@
 //primitiveNodes.h
 #pragma once
 #include "object3D.h"
+#include "primitiveMeshCache.h"
 
 class SphereNode : public Node {
 public:
@@ -25,9 +26,13 @@ public:
 
 
 private:
+    // shared with every other SphereNode built with the same arguments
     void generateMesh() {
-        mesh = std::make_shared<Mesh>();
+        mesh = PrimitiveMeshCache::getInstance().get(type, { radius, static_cast<float>(slices), static_cast<float>(stacks) },
+            [this](Mesh& geometry) { buildGeometry(geometry); });
+    }
 
+    void buildGeometry(Mesh& geometry) const {
         // Generate vertices
         for (int i = 0; i <= stacks; ++i) {
             float stackAngle = i * (glm::pi<float>() / stacks);
@@ -46,16 +51,16 @@ private:
                 float s = (float)j / slices;
 
                 // Position
-                mesh->positions.push_back(glm::vec3(x, y, z));
+                geometry.positions.push_back(glm::vec3(x, y, z));
 
                 // Normal (normalized position for sphere)
-                mesh->normals.push_back(glm::normalize(glm::vec3(x, y, z)));
+                geometry.normals.push_back(glm::normalize(glm::vec3(x, y, z)));
 
                 // UV coordinates
-                mesh->uvSets["map1"].push_back(glm::vec2(s, t));
+                geometry.uvSets[Mesh::DEFAULT_UV_SET].push_back(glm::vec2(s, t));
 
                 // Default color (white)
-                mesh->colors.push_back(glm::vec4(1.0f));
+                geometry.colors.push_back(glm::vec4(1.0f));
             }
         }
 
@@ -65,17 +70,15 @@ private:
                 unsigned int first = (unsigned int)(i * (slices + 1) + j);
                 unsigned int second = first + (unsigned int)(slices + 1);
 
-                mesh->indices.push_back(first);
-                mesh->indices.push_back(second);
-                mesh->indices.push_back((unsigned int)(first + 1));
+                geometry.indices.push_back(first);
+                geometry.indices.push_back(second);
+                geometry.indices.push_back((unsigned int)(first + 1));
 
-                mesh->indices.push_back(second);
-                mesh->indices.push_back((unsigned int)(second + 1));
-                mesh->indices.push_back((unsigned int)(first + 1));
+                geometry.indices.push_back(second);
+                geometry.indices.push_back((unsigned int)(second + 1));
+                geometry.indices.push_back((unsigned int)(first + 1));
             }
         }
-
-        mesh->setupBuffers();
     }
 };
 
@@ -88,13 +91,18 @@ public:
     BoxNode(float w, float h, float d) :
         width(w), height(h), depth(d) {
         type = NodeType::Box;
+        occluder = true;
         generateMesh();
     }
 
 private:
+    // shared with every other BoxNode built with the same arguments
     void generateMesh() {
-        mesh = std::make_shared<Mesh>();
+        mesh = PrimitiveMeshCache::getInstance().get(type, { width, height, depth },
+            [this](Mesh& geometry) { buildGeometry(geometry); });
+    }
 
+    void buildGeometry(Mesh& geometry) const {
         float hw = width * 0.5f;   // half width
         float hh = height * 0.5f;  // half height
         float hd = depth * 0.5f;   // half depth
@@ -112,69 +120,69 @@ private:
         };
 
         // Front face (-Z)
-        mesh->positions.insert(mesh->positions.end(), { vertices[0], vertices[1], vertices[2], vertices[3] });
+        geometry.positions.insert(geometry.positions.end(), { vertices[0], vertices[1], vertices[2], vertices[3] });
         for (int i = 0; i < 4; i++) {
-            mesh->normals.push_back(glm::vec3(0.0f, 0.0f, -1.0f));
-            mesh->colors.push_back(glm::vec4(1.0f));
+            geometry.normals.push_back(glm::vec3(0.0f, 0.0f, -1.0f));
+            geometry.colors.push_back(glm::vec4(1.0f));
         }
-        mesh->uvSets["map1"].insert(mesh->uvSets["map1"].end(), {
+        geometry.uvSets[Mesh::DEFAULT_UV_SET].insert(geometry.uvSets[Mesh::DEFAULT_UV_SET].end(), {
             glm::vec2(0, 0), glm::vec2(1, 0), glm::vec2(1, 1), glm::vec2(0, 1)
             });
 
         // Back face (+Z)
-        mesh->positions.insert(mesh->positions.end(), { vertices[4], vertices[5], vertices[6], vertices[7] });
+        geometry.positions.insert(geometry.positions.end(), { vertices[4], vertices[5], vertices[6], vertices[7] });
         for (int i = 0; i < 4; i++) {
-            mesh->normals.push_back(glm::vec3(0.0f, 0.0f, 1.0f));
-            mesh->colors.push_back(glm::vec4(1.0f));
+            geometry.normals.push_back(glm::vec3(0.0f, 0.0f, 1.0f));
+            geometry.colors.push_back(glm::vec4(1.0f));
         }
-        mesh->uvSets["map1"].insert(mesh->uvSets["map1"].end(), {
+        geometry.uvSets[Mesh::DEFAULT_UV_SET].insert(geometry.uvSets[Mesh::DEFAULT_UV_SET].end(), {
             glm::vec2(1, 0), glm::vec2(0, 0), glm::vec2(0, 1), glm::vec2(1, 1)
             });
 
         // Left face (-X)
-        mesh->positions.insert(mesh->positions.end(), { vertices[0], vertices[3], vertices[7], vertices[4] });
+        geometry.positions.insert(geometry.positions.end(), { vertices[0], vertices[3], vertices[7], vertices[4] });
         for (int i = 0; i < 4; i++) {
-            mesh->normals.push_back(glm::vec3(-1.0f, 0.0f, 0.0f));
-            mesh->colors.push_back(glm::vec4(1.0f));
+            geometry.normals.push_back(glm::vec3(-1.0f, 0.0f, 0.0f));
+            geometry.colors.push_back(glm::vec4(1.0f));
         }
-        mesh->uvSets["map1"].insert(mesh->uvSets["map1"].end(), {
+        geometry.uvSets[Mesh::DEFAULT_UV_SET].insert(geometry.uvSets[Mesh::DEFAULT_UV_SET].end(), {
             glm::vec2(0, 0), glm::vec2(1, 0), glm::vec2(1, 1), glm::vec2(0, 1)
             });
 
         // Right face (+X)
-        mesh->positions.insert(mesh->positions.end(), { vertices[1], vertices[5], vertices[6], vertices[2] });
+        geometry.positions.insert(geometry.positions.end(), { vertices[1], vertices[5], vertices[6], vertices[2] });
         for (int i = 0; i < 4; i++) {
-            mesh->normals.push_back(glm::vec3(1.0f, 0.0f, 0.0f));
-            mesh->colors.push_back(glm::vec4(1.0f));
+            geometry.normals.push_back(glm::vec3(1.0f, 0.0f, 0.0f));
+            geometry.colors.push_back(glm::vec4(1.0f));
         }
-        mesh->uvSets["map1"].insert(mesh->uvSets["map1"].end(), {
+        geometry.uvSets[Mesh::DEFAULT_UV_SET].insert(geometry.uvSets[Mesh::DEFAULT_UV_SET].end(), {
             glm::vec2(1, 0), glm::vec2(0, 0), glm::vec2(0, 1), glm::vec2(1, 1)
             });
 
         // Bottom face (-Y)
-        mesh->positions.insert(mesh->positions.end(), { vertices[0], vertices[1], vertices[5], vertices[4] });
+        geometry.positions.insert(geometry.positions.end(), { vertices[0], vertices[1], vertices[5], vertices[4] });
         for (int i = 0; i < 4; i++) {
-            mesh->normals.push_back(glm::vec3(0.0f, -1.0f, 0.0f));
-            mesh->colors.push_back(glm::vec4(1.0f));
+            geometry.normals.push_back(glm::vec3(0.0f, -1.0f, 0.0f));
+            geometry.colors.push_back(glm::vec4(1.0f));
         }
-        mesh->uvSets["map1"].insert(mesh->uvSets["map1"].end(), {
+        geometry.uvSets[Mesh::DEFAULT_UV_SET].insert(geometry.uvSets[Mesh::DEFAULT_UV_SET].end(), {
             glm::vec2(0, 1), glm::vec2(1, 1), glm::vec2(1, 0), glm::vec2(0, 0)
             });
 
         // Top face (+Y)
-        mesh->positions.insert(mesh->positions.end(), { vertices[3], vertices[2], vertices[6], vertices[7] });
+        geometry.positions.insert(geometry.positions.end(), { vertices[3], vertices[2], vertices[6], vertices[7] });
         for (int i = 0; i < 4; i++) {
-            mesh->normals.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
-            mesh->colors.push_back(glm::vec4(1.0f));
+            geometry.normals.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
+            geometry.colors.push_back(glm::vec4(1.0f));
         }
-        mesh->uvSets["map1"].insert(mesh->uvSets["map1"].end(), {
+        geometry.uvSets[Mesh::DEFAULT_UV_SET].insert(geometry.uvSets[Mesh::DEFAULT_UV_SET].end(), {
             glm::vec2(0, 0), glm::vec2(1, 0), glm::vec2(1, 1), glm::vec2(0, 1)
             });
 
         // Generate indices for all faces (6 faces, 2 triangles each)
         for (unsigned int face = 0; face < 6; face++) {
             unsigned int base = face * 4;
-            mesh->indices.insert(mesh->indices.end(), {
+            geometry.indices.insert(geometry.indices.end(), {
                 (unsigned int)(base),
                 (unsigned int)(base + 1),
                 (unsigned int)(base + 2),
@@ -183,8 +191,6 @@ private:
                 (unsigned int)(base)
                 });
         }
-
-        mesh->setupBuffers();
     }
 };
 
@@ -202,9 +208,13 @@ public:
     }
 
 private:
+    // shared with every other CylinderNode built with the same arguments
     void generateMesh() {
-        mesh = std::make_shared<Mesh>();
+        mesh = PrimitiveMeshCache::getInstance().get(type, { radius, height, static_cast<float>(slices), static_cast<float>(stacks) },
+            [this](Mesh& geometry) { buildGeometry(geometry); });
+    }
 
+    void buildGeometry(Mesh& geometry) const {
         // Generate vertices for the cylinder body
         for (int i = 0; i <= stacks; ++i) {
             float stackHeight = height * ((float)i / stacks) - height / 2.0f;
@@ -215,18 +225,18 @@ private:
                 float z = radius * sin(angle);
 
                 // Position
-                mesh->positions.push_back(glm::vec3(x, stackHeight, z));
+                geometry.positions.push_back(glm::vec3(x, stackHeight, z));
 
                 // Normal (pointing outward for the body)
-                mesh->normals.push_back(glm::normalize(glm::vec3(x, 0.0f, z)));
+                geometry.normals.push_back(glm::normalize(glm::vec3(x, 0.0f, z)));
 
                 // UV coordinates
                 float u = (float)j / slices;
                 float v = (float)i / stacks;
-                mesh->uvSets["map1"].push_back(glm::vec2(u, v));
+                geometry.uvSets[Mesh::DEFAULT_UV_SET].push_back(glm::vec2(u, v));
 
                 // Default color (white)
-                mesh->colors.push_back(glm::vec4(1.0f));
+                geometry.colors.push_back(glm::vec4(1.0f));
             }
         }
 
@@ -236,13 +246,13 @@ private:
                 unsigned int first = i * (slices + 1) + j;
                 unsigned int second = first + slices + 1;
 
-                mesh->indices.push_back(first);
-                mesh->indices.push_back(second);
-                mesh->indices.push_back(first + 1);
+                geometry.indices.push_back(first);
+                geometry.indices.push_back(second);
+                geometry.indices.push_back(first + 1);
 
-                mesh->indices.push_back(second);
-                mesh->indices.push_back(second + 1);
-                mesh->indices.push_back(first + 1);
+                geometry.indices.push_back(second);
+                geometry.indices.push_back(second + 1);
+                geometry.indices.push_back(first + 1);
             }
         }
 
@@ -252,11 +262,11 @@ private:
             float normalY = (cap == 0) ? -1.0f : 1.0f;
 
             // Center vertex
-            unsigned int centerIndex = mesh->positions.size();
-            mesh->positions.push_back(glm::vec3(0.0f, y, 0.0f));
-            mesh->normals.push_back(glm::vec3(0.0f, normalY, 0.0f));
-            mesh->uvSets["map1"].push_back(glm::vec2(0.5f, 0.5f));
-            mesh->colors.push_back(glm::vec4(1.0f));
+            unsigned int centerIndex = geometry.positions.size();
+            geometry.positions.push_back(glm::vec3(0.0f, y, 0.0f));
+            geometry.normals.push_back(glm::vec3(0.0f, normalY, 0.0f));
+            geometry.uvSets[Mesh::DEFAULT_UV_SET].push_back(glm::vec2(0.5f, 0.5f));
+            geometry.colors.push_back(glm::vec4(1.0f));
 
             // Generate vertices around the cap
             for (int i = 0; i <= slices; ++i) {
@@ -264,32 +274,30 @@ private:
                 float x = radius * cos(angle);
                 float z = radius * sin(angle);
 
-                mesh->positions.push_back(glm::vec3(x, y, z));
-                mesh->normals.push_back(glm::vec3(0.0f, normalY, 0.0f));
+                geometry.positions.push_back(glm::vec3(x, y, z));
+                geometry.normals.push_back(glm::vec3(0.0f, normalY, 0.0f));
 
                 // UV coordinates for the cap (circular mapping)
                 float u = cos(angle) * 0.5f + 0.5f;
                 float v = sin(angle) * 0.5f + 0.5f;
-                mesh->uvSets["map1"].push_back(glm::vec2(u, v));
+                geometry.uvSets[Mesh::DEFAULT_UV_SET].push_back(glm::vec2(u, v));
 
-                mesh->colors.push_back(glm::vec4(1.0f));
+                geometry.colors.push_back(glm::vec4(1.0f));
 
                 // Generate indices for the cap triangles
                 if (i < slices) {
                     if (cap == 0) {  // Bottom cap
-                        mesh->indices.push_back(centerIndex);
-                        mesh->indices.push_back(centerIndex + i + 1);
-                        mesh->indices.push_back(centerIndex + i + 2);
+                        geometry.indices.push_back(centerIndex);
+                        geometry.indices.push_back(centerIndex + i + 1);
+                        geometry.indices.push_back(centerIndex + i + 2);
                     }
                     else {  // Top cap
-                        mesh->indices.push_back(centerIndex);
-                        mesh->indices.push_back(centerIndex + i + 2);
-                        mesh->indices.push_back(centerIndex + i + 1);
+                        geometry.indices.push_back(centerIndex);
+                        geometry.indices.push_back(centerIndex + i + 2);
+                        geometry.indices.push_back(centerIndex + i + 1);
                     }
                 }
             }
         }
-
-        mesh->setupBuffers();
     }
 };
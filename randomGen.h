@@ -34,18 +34,18 @@ void generateRandomSpheres(Scene& scene,
 
         // Create sphere
 
-        auto sphereNode = std::make_shared<SphereNode>(radius, numSlices, numStacks);
+        auto sphereNode = makePooled<SphereNode, pools::Primitives>(radius, numSlices, numStacks);
         sphereNode->setWorldPosition(position);
 
         // Set random color for the mesh
         if (sphereNode->mesh) {
-            sphereNode->mesh->materials[0]->baseColor = randomColor();
+            sphereNode->ownMaterial()->baseColor = randomColor();
             // Update the mesh buffers to reflect the color change
             //sphereNode->mesh->updateBuffers();
         }
 
         // Create physics body for the sphere
-        auto sphereBody = std::make_shared<PhysXBody>(sphereNode, false);  // false = dynamic body
+        auto sphereBody = makePooled<PhysXBody, pools::Bodies>(sphereNode, false);  // false = dynamic body
         scene.addPhysicsBody(sphereBody);
 
       
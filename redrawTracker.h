@@ -0,0 +1,84 @@
+// redrawTracker.h
+#pragma once
+#include "GameEngine.h"
+#include <atomic>
+
+// render on demand for the editor. anything that changes what's on screen calls
+// markDirty (input, transform changes, nodes added/removed, UI edits, play mode),
+// when nothing did the main loop skips the frame, the last swapped frame stays up
+// and the thread sleeps in glfwWaitEventsTimeout instead of spinning
+class RedrawTracker {
+private:
+    inline static RedrawTracker* instance;
+
+    std::atomic<int> framesLeft{ 2 };   // first frames always draw
+    glm::mat4 lastViewProjection = glm::mat4(0.0f);
+    size_t renderedFrames = 0;
+    size_t skippedFrames = 0;
+
+    RedrawTracker() = default;
+
+    static void onWindowEvent(GLFWwindow*) { getInstance().markDirty(); }
+    static void onFocus(GLFWwindow*, int) { getInstance().markDirty(); }
+    static void onMouseButton(GLFWwindow*, int, int, int) { getInstance().markDirty(); }
+    static void onScroll(GLFWwindow*, double, double) { getInstance().markDirty(); }
+    static void onChar(GLFWwindow*, unsigned int) { getInstance().markDirty(); }
+    static void onFramebufferSize(GLFWwindow*, int, int) { getInstance().markDirty(); }
+
+public:
+    bool enabled = true;
+    int settleFrames = 3;       // frames drawn after the last change, imgui hover/active state lags a frame
+    double idleTimeout = 0.1;   // seconds, also how often background work (streaming jobs) gets polled while idle
+
+    static RedrawTracker& getInstance() {
+        if (instance == nullptr) {
+            instance = new RedrawTracker();
+        }
+        return *instance;
+    }
+
+    RedrawTracker(const RedrawTracker&) = delete;
+    RedrawTracker& operator=(const RedrawTracker&) = delete;
+
+    // call before initImGui, imgui chains to callbacks that are already set.
+    // key and cursor callbacks are input.cpp's and mark dirty themselves
+    void installCallbacks(GLFWwindow* window) {
+        glfwSetWindowRefreshCallback(window, onWindowEvent);
+        glfwSetFramebufferSizeCallback(window, onFramebufferSize);
+        glfwSetWindowFocusCallback(window, onFocus);
+        glfwSetMouseButtonCallback(window, onMouseButton);
+        glfwSetScrollCallback(window, onScroll);
+        glfwSetCharCallback(window, onChar);
+    }
+
+    void markDirty() {
+        framesLeft.store(settleFrames, std::memory_order_relaxed);
+    }
+
+    // camera fields get written directly in a few places (player, input), so compare the result
+    void watchCamera(const glm::mat4& viewProjection) {
+        if (viewProjection != lastViewProjection) {
+            lastViewProjection = viewProjection;
+            markDirty();
+        }
+    }
+
+    bool shouldRender() const {
+        return !enabled || framesLeft.load(std::memory_order_relaxed) > 0;
+    }
+
+    void frameRendered() {
+        int left = framesLeft.load(std::memory_order_relaxed);
+        if (left > 0) framesLeft.compare_exchange_strong(left, left - 1, std::memory_order_relaxed);
+        ++renderedFrames;
+    }
+
+    // nothing to draw: sleep until an event arrives or the timeout passes
+    void waitForChanges() {
+        ++skippedFrames;
+        glfwWaitEventsTimeout(idleTimeout);
+    }
+
+    size_t getRenderedFrames() const { return renderedFrames; }
+    size_t getSkippedFrames() const { return skippedFrames; }
+};
@@ -1,4 +1,5 @@
 #include "GameEngine.h"
+#include "glState.h"
 #include <fstream> // for cerr i think
 
 #ifndef M_PI
@@ -67,7 +68,7 @@ void drawAxes(const glm::mat4& view, const glm::mat4& projection) {
     glLineWidth(3.0f);
 
     // // Disable the shader program to use fixed-function pipeline
-    glUseProgram(0);
+    GLStateCache::getInstance().useProgram(0);
 
     /// Set the view and projection matrices
     glMatrixMode(GL_PROJECTION);
@@ -112,7 +113,7 @@ void drawPoint(const glm::vec3& point, const glm::mat4& view, const glm::mat4& p
 	// Set point color
 	glColor3f(color.r, color.g, color.b);
 	// // Disable the shader program to use fixed-function pipeline
-	glUseProgram(0);
+	GLStateCache::getInstance().useProgram(0);
 	/// Set the view and projection matrices
 	glMatrixMode(GL_PROJECTION);
 	glLoadMatrixf(glm::value_ptr(projection));
@@ -1,6 +1,7 @@
 // Renderer2D.h
 #pragma once
 #include "GameEngine.h"
+#include "glState.h"
 #include "shader.h"
 
 struct Vertex2D {
@@ -34,8 +35,9 @@ public:
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
 
+        GLStateCache& gl = GLStateCache::getInstance();
         // Bind VAO
-        glBindVertexArray(VAO);
+        gl.bindVertexArray(VAO);
 
         // Setup vertex buffer
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -59,11 +61,11 @@ public:
         glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex2D), (void*)offsetof(Vertex2D, color));
 
         // Unbind VAO
-        glBindVertexArray(0);
+        gl.bindVertexArray(0);
 
         // Setup blending
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        gl.enable(GL_BLEND);
+        gl.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     }
 
     void beginBatch() {
@@ -116,7 +118,7 @@ public:
 
         // Bind shader and VAO
         spriteShader->use();
-        glBindVertexArray(VAO);
+        GLStateCache::getInstance().bindVertexArray(VAO);
 
         // Update vertex buffer
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -143,7 +145,7 @@ public:
     }
 
     ~Renderer2D() {
-        glDeleteVertexArrays(1, &VAO);
+        GLStateCache::getInstance().deleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
         glDeleteBuffers(1, &EBO);
     }
@@ -3,6 +3,9 @@
 #include "object3D.h"
 #include "camera.h"
 #include "PhysXWorld.h"
+#include "PhysXStaticWorld.h"
+#include "PhysXSnapshot.h"
+#include "forceField.h"
 #include "shadowRenderer.h"
 #include "player.h"
 #include "UVviewer.h"
@@ -10,6 +13,16 @@
 #include "vender/imgui/backends/imgui_impl_glfw.h"
 #include "vender/imgui/backends/imgui_impl_opengl3.h"
 #include "background.h"
+#include "particleSystem.h"
+#include "transformHierarchy.h"
+#include "ecsSystems.h"
+#include "redrawTracker.h"
+#include "sceneCommands.h"
+#include "aabbTree.h"
+#include "occlusionCuller.h"
+#include "staticBatcher.h"
+#include "impostorRenderer.h"
+#include "meshLod.h"
 
 
 class Scene {
@@ -33,16 +46,64 @@ public:
     // object nodes
     // scene should control which nodes are drawn on camera (view frustum culling)
     // but these are all the nodes in the scene including the culled ones and the ones in physicsWorld
-    std::vector<std::shared_ptr<Node>> sceneNodes;
-    std::unordered_map<std::string, std::shared_ptr<Node>> nodeRegistry;
+    // dense storage, iterate it like a vector. nodes know their own handle so removal is O(1)
+    SlotMap<std::shared_ptr<Node>> sceneNodes;
+    std::unordered_map<StringId, std::shared_ptr<Node>> nodeRegistry;
+
+    // depth sorted world matrix update for everything in sceneNodes
+    TransformHierarchy transformHierarchy;
+
+    // world bounds of every mesh node, refit from the nodes that moved. render only
+    // draws what the camera frustum query returns, shadow maps query per light
+    AABBTree<Node*> cullingTree;
+    bool frustumCulling = true;
+    size_t drawnNodeCount = 0;
+    size_t culledNodeCount = 0;
+    uint32_t cullingBoundsEpoch = 0;    // Mesh::getBoundsEpoch() at the last refit
+
+    // then whatever is behind the biggest occluders on screen gets dropped too
+    OcclusionCuller occlusionCuller;
+    bool occlusionCulling = true;
+    size_t occludedNodeCount = 0;
+
+    // static mesh nodes merged per material, drawn as world space render items
+    StaticBatcher staticBatches;
+    bool staticBatching = true;
+
+    // far away imported models as billboards from baked atlases, all in one instanced draw
+    ImpostorRenderer impostors;
+
+    // simplified levels for dense meshes, picked per node in both passes
+    MeshLodManager meshLods;
+
+    // chunked entities for large counts of simple objects, plus node mirrors for chunk queries
+    EntityWorld entities;
+    NodeEntityBridge nodeEntities{ entities };
+
+    // add/remove/reparent/spawn from other threads, applied at the start of update().
+    // the methods below are main thread only
+    SceneCommandBuffer commands;
 
     //which nodes are selected
     std::vector<std::shared_ptr<Node>> selectedNodes;
+    std::unordered_map<const Node*, size_t> selectedIndex; // position in selectedNodes
 
 
     // physics world
     PhysXWorld physicsWorld;
 
+    // merged static colliders (ground, walls, level props)
+    PhysXStaticWorld staticWorld;
+
+    // saved physics state for restarting a scenario
+    PhysXSnapshot physicsSnapshot;
+
+    // bodies of streamed cells (see worldStreamer.h). the cell owns them, snapshots leave them out
+    std::unordered_set<const PhysXBody*> streamedBodies;
+
+    // explosions, wind, attractors
+    ForceFieldSystem forceFields;
+
     // phyiscs params
     bool play = false; // play sim/animation
     bool gravityEnabled = true; // enable gravity
@@ -70,6 +131,9 @@ public:
     // Animation system (for controlling all the animations playing in scene)
     AnimationSystem animationSystem;
 
+    // cpu particle effects (sparks, dust...)
+    ParticleSystem particleSystem;
+
     Scene() : ambientLight(0.1f, 0.1f, 0.1f) {
 
         // Initialize the background member
@@ -121,7 +185,7 @@ public:
         skybox->loadCubemap(faces);
 
         glClearColor(0.0f,  0.0f, 0.0f, 0.0f);
-        glEnable(GL_DEPTH_TEST);
+        GLStateCache::getInstance().enable(GL_DEPTH_TEST);
         glShadeModel(GL_SMOOTH);
 
         // Initialize shadow rendering
@@ -133,35 +197,129 @@ public:
     }
 
     // Node Management
-    void addNode(std::shared_ptr<Node> node, const std::string& name = "") {
-        sceneNodes.push_back(node);
+    SlotHandle addNode(std::shared_ptr<Node> node, const std::string& name = "") {
+        if (!sceneNodes.contains(node->sceneHandle)) {
+            node->sceneHandle = sceneNodes.insert(node);
+            transformHierarchy.add(node);
+            refitCullProxy(node.get());
+            if (node->isStatic) staticBatches.markDirty(node.get());
+            impostors.prepare(node.get());
+            nodeEntities.link(node);
+            RedrawTracker::getInstance().markDirty();
+        }
         if (!name.empty()) {
-            nodeRegistry[name] = node;
+            nodeRegistry[internString(name)] = node;
         }
 
         // Add all child nodes recursively
         for (const auto& child : node->children) {
             addNode(child);
         }
+        return node->sceneHandle;
     }
 
     std::shared_ptr<Node> getNode(const std::string& name) {
+        return getNode(StringId(name));
+    }
+
+    std::shared_ptr<Node> getNode(StringId name) {
         auto it = nodeRegistry.find(name);
         return (it != nodeRegistry.end()) ? it->second : nullptr;
     }
 
+    // nullptr once the node has been removed, even if the slot got reused
+    std::shared_ptr<Node> getNode(SlotHandle handle) const {
+        const auto* node = sceneNodes.get(handle);
+        return node ? *node : nullptr;
+    }
+
     void removeNode(const std::string& name) {
         auto node = getNode(name);
         if (node) {
             // Remove from registry
-            nodeRegistry.erase(name);
+            nodeRegistry.erase(StringId(name));
+            removeNode(node);
+        }
+    }
 
-            // Remove from scene nodes
-            auto it = std::find(sceneNodes.begin(), sceneNodes.end(), node);
-            if (it != sceneNodes.end()) {
-                sceneNodes.erase(it);
+    // children stay in the scene, same as before
+    void removeNode(const std::shared_ptr<Node>& node) {
+        if (!node) return;
+        sceneNodes.remove(node->sceneHandle);
+        node->sceneHandle = SlotHandle();
+        transformHierarchy.remove(node);
+        if (node->cullProxy >= 0) {
+            cullingTree.remove(node->cullProxy);
+            node->cullProxy = -1;
+        }
+        staticBatches.remove(node.get());
+        nodeEntities.unlink(node.get());
+        removeSelectedNode(node);
+        RedrawTracker::getInstance().markDirty();
+    }
+
+    // removeNode plus the node's physics body, collision goes with it. pass the name it was
+    // added under to take it out of the registry too
+    void deleteNode(const std::shared_ptr<Node>& node, const std::string& name = "") {
+        if (!node) return;
+        if (auto body = physicsWorld.findBody(node.get())) {
+            physicsWorld.removeBody(body);
+            staticWorld.removeStaticBody(body.get());   // only its shapes, if merged
+            body->releaseActor();
+        }
+        if (!name.empty() && getNode(name) == node) {
+            removeNode(name);
+        }
+        else {
+            removeNode(node);
+        }
+    }
+
+    // moves node under newParent (nullptr = top level). the local transform is kept, same as addChild
+    void reparentNode(const std::shared_ptr<Node>& node, const std::shared_ptr<Node>& newParent) {
+        if (!node || node == newParent || node->parent == newParent.get()) return;
+        for (Node* p = newParent.get(); p; p = p->parent) {
+            if (p == node.get()) return; // newParent is below node
+        }
+
+        auto keepAlive = node;
+        if (node->parent) {
+            node->parent->removeChild(node.get());
+        }
+        if (newParent) {
+            newParent->addChild(node);
+            if (sceneNodes.contains(newParent->sceneHandle) && !sceneNodes.contains(node->sceneHandle)) {
+                addNode(node);
             }
         }
+
+        transformHierarchy.markStructureDirty();
+        node->markTransformDirty();
+        RedrawTracker::getInstance().markDirty();
+    }
+
+    // sync point for commands recorded on other threads, returns how many ran
+    size_t applyCommands() {
+        using Type = SceneCommandBuffer::CommandType;
+        return commands.drain([this](SceneCommandBuffer::Command& command) {
+            switch (command.type) {
+            case Type::AddNode:
+                if (command.node) addNode(command.node, command.name);
+                break;
+            case Type::RemoveNode:
+                if (command.node) deleteNode(command.node, command.name);
+                break;
+            case Type::Reparent:
+                reparentNode(command.node, command.parent);
+                break;
+            case Type::AddPhysicsBody:
+                if (command.body) addPhysicsBody(command.body, command.name);
+                break;
+            case Type::Spawn:
+                if (command.spawn) command.spawn(*this);
+                break;
+            }
+        });
     }
 
     // Physics Management
@@ -172,6 +330,85 @@ public:
         }
     }
 
+    // static level geometry, collision only goes in once buildStaticWorld() runs
+    void addStaticCollider(std::shared_ptr<Node> node, const std::string& name = "") {
+        addNode(node, name);
+        staticWorld.addStaticNode(node);
+    }
+
+    // merges every static collider (and static bodies already in the world) into a few actors.
+    // with a cache path the collider list is loaded from / saved next to the level, a hit
+    // skips walking the bodies' shapes. calling it again merges what was added since, the
+    // cache is only used by the first build
+    void buildStaticWorld(const std::string& cachePath = "", uint32_t levelVersion = 0) {
+        bool useCache = !cachePath.empty() && !staticWorld.isBuilt();
+        bool cached = useCache && staticWorld.loadCache(cachePath, levelVersion);
+
+        for (const auto& body : physicsWorld.bodies) {
+            if (!body->isStatic) continue;
+            if (cached) staticWorld.addCachedBody(body);
+            else staticWorld.addStaticBody(body);
+        }
+
+        if (useCache && !cached) {
+            staticWorld.saveCache(cachePath, levelVersion);
+        }
+
+        staticWorld.build();
+    }
+
+    // merged static actors don't change during a scenario and streamed cells come and go
+    // on their own, snapshots leave both alone
+    std::unordered_set<PxRigidActor*> getSnapshotSkipActors() const {
+        const auto& actors = staticWorld.getActors();
+        std::unordered_set<PxRigidActor*> skip(actors.begin(), actors.end());
+        for (const auto& body : physicsWorld.bodies) {
+            if (body->actor && streamedBodies.count(body.get())) skip.insert(body->actor);
+        }
+        return skip;
+    }
+
+    bool capturePhysicsSnapshot() {
+        return physicsSnapshot.capture(physicsWorld.bodies, getSnapshotSkipActors());
+    }
+
+    // puts every body back the way it was at capture, bodies created since are dropped
+    // and bodies deleted since come back
+    void restorePhysicsSnapshot() {
+        if (!physicsSnapshot.isValid()) return;
+
+        auto skipActors = getSnapshotSkipActors();
+        auto restored = physicsSnapshot.restore(physicsWorld.bodies, skipActors);
+        std::unordered_set<PhysXBody*> restoredSet;
+        for (const auto& body : restored) {
+            restoredSet.insert(body.get());
+        }
+
+        std::vector<std::shared_ptr<PhysXBody>> bodies;
+        std::unordered_set<Node*> droppedNodes;
+        for (const auto& body : physicsWorld.bodies) {
+            if (staticWorld.contains(body.get()) || streamedBodies.count(body.get())) {
+                bodies.push_back(body);
+            }
+            else if (!restoredSet.count(body.get()) && body->node) {
+                droppedNodes.insert(body->node.get());
+                removeNode(body->node);
+            }
+        }
+        bodies.insert(bodies.end(), restored.begin(), restored.end());
+        physicsWorld.setBodies(std::move(bodies));
+
+        for (auto it = nodeRegistry.begin(); it != nodeRegistry.end();) {
+            it = droppedNodes.count(it->second.get()) ? nodeRegistry.erase(it) : std::next(it);
+        }
+
+        for (const auto& body : restored) {
+            if (body->node && !sceneNodes.contains(body->node->sceneHandle)) {
+                addNode(body->node);
+            }
+        }
+    }
+
     // Camera Management
     void setActiveCamera(size_t index) {
         if (index < cameras.size()) {
@@ -197,6 +434,54 @@ public:
 
     }
 
+    void removeSpotLight(const std::shared_ptr<SpotLight>& spotLight) {
+        spotLights.erase(std::remove(spotLights.begin(), spotLights.end(), spotLight), spotLights.end());
+        shadowRenderer.removeSpotLight(spotLight);
+        removeNode(spotLight);
+    }
+
+    void removeSunLight(const std::shared_ptr<SunLight>& sunLight) {
+        sunLights.erase(std::remove(sunLights.begin(), sunLights.end(), sunLight), sunLights.end());
+        removeNode(sunLight);
+    }
+
+    // drops every node, body and light, everything a scene file holds, so loading one
+    // replaces the scene instead of adding a second copy. cameras and the player stay.
+    // streamed cells have to go first (WorldStreamer::unloadAll), they track their own nodes
+    void clear() {
+        // restored actors belong to the snapshot's collection, they go first
+        physicsSnapshot.clear();
+        staticWorld.clear();
+        for (const auto& body : physicsWorld.bodies) {
+            body->releaseActor();
+        }
+        physicsWorld.setBodies({});
+        streamedBodies.clear();
+
+        for (const auto& spotLight : spotLights) {
+            shadowRenderer.removeSpotLight(spotLight);
+        }
+        spotLights.clear();
+        sunLights.clear();
+
+        std::vector<std::shared_ptr<Node>> nodes(sceneNodes.begin(), sceneNodes.end());
+        for (const auto& node : nodes) {
+            if (!isPlayerNode(node.get())) removeNode(node);
+        }
+        for (auto it = nodeRegistry.begin(); it != nodeRegistry.end();) {
+            it = isPlayerNode(it->second.get()) ? std::next(it) : nodeRegistry.erase(it);
+        }
+    }
+
+    // the player's model or anything below it, those belong to the player and not the level
+    bool isPlayerNode(const Node* node) const {
+        if (!player || !player->playerModel) return false;
+        for (; node; node = node->parent) {
+            if (node == player->playerModel.get()) return true;
+        }
+        return false;
+    }
+
     void addPlayer(std::shared_ptr<Player> player) {
 		this->player = player;
 
@@ -210,19 +495,112 @@ public:
 
     // Scene Update and Rendering
     void update(float deltaTime) {
+        applyCommands();
+
         if (play) {
 
             // Update animations
             animationSystem.update(deltaTime);
 
+            // persistent fields add their forces before the step
+            forceFields.update(deltaTime);
+
             // Update physics
             physicsWorld.updateSimulation(deltaTime);
 
-            // Update scene graph
-            for (auto& node : sceneNodes) {
-                node->updateWorldTransform();
+            // particles after physics so scene queries see this step's poses
+            particleSystem.update(deltaTime);
+
+            // same for entities that aren't nodes
+            if (hasFreeEntities()) {
+                ecs::syncPhysics(entities);
+                ecs::updateAnimations(entities, deltaTime);
+            }
+
+        }
+
+        // Update scene graph, only nodes that moved (or whose parent moved) get recomputed.
+        // runs while paused too so editor changes show up
+        if (transformHierarchy.update() > 0) {
+            RedrawTracker::getInstance().markDirty();
+        }
+        if (hasFreeEntities()) ecs::updateTransforms(entities);
+        nodeEntities.pullTransforms(transformHierarchy.getChangedNodes());
+    }
+
+    // entities that aren't node mirrors, the ecs:: passes only look at those
+    bool hasFreeEntities() const {
+        return entities.size() > nodeEntities.getLinkedCount();
+    }
+
+    static bool isTransparent(const Node* node) {
+        for (size_t slot = 0; slot < node->mesh->materials.size(); ++slot) {
+            auto material = node->getMaterial(slot);
+            if (material && material->alpha < 1.0f) return true;
+        }
+        return false;
+    }
+
+    // mesh nodes get a leaf, nodes that lost their mesh give it back
+    void refitCullProxy(Node* node) {
+        if (!node->mesh) {
+            if (node->cullProxy >= 0) {
+                cullingTree.remove(node->cullProxy);
+                node->cullProxy = -1;
+            }
+            return;
+        }
+
+        AABB bounds = node->getWorldBounds();
+        node->cullBoundsVersion = node->mesh->getBoundsVersion();
+        if (node->cullProxy < 0) {
+            node->cullProxy = cullingTree.insert(bounds, node);
+        }
+        else {
+            cullingTree.move(node->cullProxy, bounds);
+        }
+    }
+
+    // call after changing a node's isStatic flag, mesh or materials by hand. moves and
+    // geometry edits are picked up on their own
+    void markStaticEdited(Node* node) {
+        if (node->isStatic || node->staticBatched) {
+            staticBatches.markDirty(node);
+        }
+    }
+
+    // nodes whose matrix changed this frame, plus meshes whose geometry changed
+    void updateCullingBounds() {
+        for (Node* node : transformHierarchy.getChangedNodes()) {
+            // could have been removed since the update pass
+            if (sceneNodes.contains(node->sceneHandle)) {
+                refitCullProxy(node);
+                markStaticEdited(node);
             }
+        }
 
+        uint32_t epoch = Mesh::getBoundsEpoch();
+        if (epoch != cullingBoundsEpoch) {
+            cullingBoundsEpoch = epoch;
+            for (const auto& node : sceneNodes) {
+                if (node->mesh ? node->cullBoundsVersion != node->mesh->getBoundsVersion() : node->cullProxy >= 0) {
+                    refitCullProxy(node.get());
+                    markStaticEdited(node.get());
+                }
+            }
+        }
+    }
+
+    // fn(Node*) for every mesh node touching the frustum (all of them with culling off)
+    template<typename Fn>
+    void queryVisibleNodes(const Frustum& frustum, Fn&& fn) {
+        if (frustumCulling) {
+            cullingTree.query(frustum, [&](Node* node) { fn(node); });
+        }
+        else {
+            for (const auto& node : sceneNodes) {
+                if (node->mesh) fn(node.get());
+            }
         }
     }
 
@@ -235,50 +613,117 @@ public:
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        // imgui and the fixed function helpers run between frames, start from a clean slate
+        GLStateCache::getInstance().invalidate();
+        GLStateCache::getInstance().resetStats();
+        MaterialTable::getInstance().beginFrame();
 
-        // Separate opaque and transparent objects
-        std::vector<std::shared_ptr<Node>> opaqueNodes;
-        std::vector<std::shared_ptr<Node>> transparentNodes;
-
-        for (const auto& node : sceneNodes) {
-            if (node->mesh && node->visible) {
-                bool isTransparent = false;
-                for (const auto& material : node->mesh->materials) {
-                    if (material && material->alpha < 1.0f) {
-                        isTransparent = true;
-                        break;
-                    }
-                }
-                if (isTransparent) {
-                    transparentNodes.push_back(node);
-                }
-                else {
-                    opaqueNodes.push_back(node);
-                }
-            }
+        // culling before anything gets drawn
+        updateCullingBounds();
+        if (staticBatching) {
+            staticBatches.update(sceneNodes);
+        }
+        else if (staticBatches.getBatchCount() > 0) {
+            staticBatches.clear();
+        }
+        const Frustum frustum(projection * view);
+
+        // Separate opaque and transparent objects. frame arena lists of raw pointers,
+        // sceneNodes keeps the nodes alive for the frame
+        FrameVector<Node*> opaqueNodes;
+        FrameVector<Node*> transparentNodes;
+
+        queryVisibleNodes(frustum, [&](Node* node) {
+            if (!node->visible) return;
+            (isTransparent(node) ? transparentNodes : opaqueNodes).push_back(node);
+        });
+
+        occludedNodeCount = 0;
+        if (occlusionCulling) {
+            // batched nodes still occlude, their batch draws them
+            occlusionCuller.renderOccluders(opaqueNodes, projection * view, activeCamera->cameraPos);
+        }
+        size_t batchedInView = std::erase_if(opaqueNodes, [](const Node* node) { return node->staticBatched; });
+
+        if (occlusionCulling) {
+            // fat tree bounds, already there and a bit conservative
+            auto boundsOf = [&](Node* node) {
+                return node->cullProxy >= 0 ? cullingTree.getFatBounds(node->cullProxy) : node->getWorldBounds();
+            };
+            occludedNodeCount += occlusionCuller.cull(opaqueNodes, boundsOf);
+            occludedNodeCount += occlusionCuller.cull(transparentNodes, boundsOf);
         }
 
-        // 1. First render shadow map
+        // what's left and small on screen swaps to its billboard, atlases still baking draw the mesh
+        // projected radius / distance * this = fraction of the screen height
+        const float projectionScale = projection[1][1] * 0.5f;
+        const glm::vec3 cameraPos = activeCamera->cameraPos;
+        impostors.begin();
+        if (impostors.enabled) {
+            std::erase_if(opaqueNodes, [&](Node* node) { return impostors.tryAdd(node, cameraPos, projectionScale); });
+        }
 
-        shadowRenderer.renderShadowPass(opaqueNodes);  // Only render opaque objects to shadow map
+        // levels always come from the camera's view, the shadow pass uses the same ones
+        meshLods.update();
+        for (Node* node : opaqueNodes) meshLods.select(node, cameraPos, projectionScale);
+        for (Node* node : transparentNodes) meshLods.select(node, cameraPos, projectionScale);
+        drawnNodeCount = opaqueNodes.size() + transparentNodes.size() + impostors.getImpostorCount();
+        culledNodeCount = cullingTree.size() - std::min(cullingTree.size(), drawnNodeCount + occludedNodeCount + batchedInView);
+
+        // entities without a node. all of them cast shadows, the main pass gets the ones on screen
+        FrameVector<RenderItem> opaqueItems;
+        FrameVector<RenderItem> transparentItems;
+        if (hasFreeEntities()) ecs::gatherRenderables(entities, opaqueItems, transparentItems);
+        staticBatches.forEachBatch([&](const StaticBatcher::Batch& batch) {
+            opaqueItems.push_back({ batch.mesh.get(), glm::mat4(1.0f), batch.castsShadows });
+        });
+
+        auto onScreen = [&](const FrameVector<RenderItem>& items) {
+            FrameVector<RenderItem> visible;
+            for (const auto& item : items) {
+                AABB bounds = item.mesh->getLocalBounds().transformed(item.model);
+                if (frustumCulling && !frustum.intersects(bounds)) continue;
+                // same margin the node tests get from the tree, a batch can hold its own occluders
+                if (occlusionCulling && !occlusionCuller.isVisible(bounds.fattened(cullingTree.margin))) continue;
+                visible.push_back(item);
+            }
+            return visible;
+        };
+        FrameVector<RenderItem> visibleOpaqueItems = onScreen(opaqueItems);
+        FrameVector<RenderItem> visibleTransparentItems = onScreen(transparentItems);
+
+        shadowRenderer.instances.resetStats();
+        impostors.bakePending();
+
+        // 1. First render shadow map, opaque casters inside each light's frustum
+        shadowRenderer.renderShadowPass([&](const Frustum& lightFrustum, FrameVector<Node*>& casters) {
+            queryVisibleNodes(lightFrustum, [&](Node* node) {
+                if (node->visible && node->castsShadows && !node->staticBatched && !isTransparent(node)) {
+                    meshLods.select(node, cameraPos, projectionScale);
+                    casters.push_back(node);
+                }
+            });
+        }, opaqueItems);
 
         // 2. Reset viewport and render opaque objects with shadows
         glViewport(0, 0, screenWidth, screenHeight);
-        glEnable(GL_DEPTH_TEST);
-        glDepthMask(GL_TRUE);
-        glDisable(GL_BLEND);
+        GLStateCache& gl = GLStateCache::getInstance();
+        gl.enable(GL_DEPTH_TEST);
+        gl.depthMask(GL_TRUE);
+        gl.disable(GL_BLEND);
 
         if (drawObjects) {
 
             shadowRenderer.prepareMainPass(view, projection, activeCamera->cameraPos);
 
-            shadowRenderer.renderMainPass(opaqueNodes, view, projection);
+            shadowRenderer.renderMainPass(opaqueNodes, view, projection, visibleOpaqueItems);
+            impostors.render(view, projection, activeCamera->cameraPos, spotLights);
 
             // 3. Render transparent objects with special settings
-            if (!transparentNodes.empty()) {
+            if (!transparentNodes.empty() || !visibleTransparentItems.empty()) {
                 // Sort transparent objects back-to-front
                 std::sort(transparentNodes.begin(), transparentNodes.end(),
-                    [&](const std::shared_ptr<Node>& a, const std::shared_ptr<Node>& b) {
+                    [&](const Node* a, const Node* b) {
                         glm::vec3 cameraPos = activeCamera->cameraPos;
                         float distA = glm::length(cameraPos - a->getWorldPosition());
                         float distB = glm::length(cameraPos - b->getWorldPosition());
@@ -286,16 +731,16 @@ public:
                     });
 
                 // Enable blending for transparent objects
-                glEnable(GL_BLEND);
-                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-                glDepthMask(GL_FALSE);
+                gl.enable(GL_BLEND);
+                gl.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                gl.depthMask(GL_FALSE);
 
 
-                shadowRenderer.renderMainPass(transparentNodes, view, projection);
+                shadowRenderer.renderMainPass(transparentNodes, view, projection, visibleTransparentItems, false);
 
                 // Reset states
-                glDepthMask(GL_TRUE);
-                glDisable(GL_BLEND);
+                gl.depthMask(GL_TRUE);
+                gl.disable(GL_BLEND);
 
             }
         }
@@ -310,21 +755,26 @@ public:
 
         // Render skybox last for better performance
         if (skybox) {
-            glDepthFunc(GL_LEQUAL);
+            gl.depthFunc(GL_LEQUAL);
             skybox->render(view, projection);
-            glDepthFunc(GL_LESS);
+            gl.depthFunc(GL_LESS);
+        }
+
+        // particles don't write depth so they go after the skybox
+        if (drawObjects) {
+            particleSystem.render(view, projection, screenHeight);
         }
 
-        glUseProgram(shadowRenderer.getMainShaderProgram());
+        gl.useProgram(shadowRenderer.getMainShaderProgram());
     }
 
     void drawWireFrames() {
         // Save current shader program
-        GLint currentProgram;
-        glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+        GLStateCache& gl = GLStateCache::getInstance();
+        GLuint currentProgram = gl.getProgram();
 
         // Disable the main shader and switch to a basic shader for wireframes
-        glUseProgram(0);
+        gl.useProgram(0);
 
         // Save current polygon mode
         GLint previousPolygonMode[2];
@@ -353,7 +803,7 @@ public:
         glPolygonMode(GL_BACK, previousPolygonMode[1]);
 
         // Restore previous shader program
-        glUseProgram(currentProgram);
+        if (currentProgram != GLStateCache::UNKNOWN) gl.useProgram(currentProgram);
     }
 
     // Animation control methods
@@ -366,9 +816,8 @@ public:
         if (auto animatedMesh = std::dynamic_pointer_cast<AnimatedMesh>(node->mesh)) {
             for (const auto& action : animatedMesh->actions) {
                 if (action.name == actionName) {
-                    // Create a unique name for this action instance
-                    std::string uniqueName = nodeName + "_" + actionName;
-                    animationSystem.playAction(uniqueName,
+                    // Create a unique id for this action instance
+                    animationSystem.playAction(actionInstanceId(actionName, nodeName),
                         std::make_shared<Action>(action),
                         node,  
                         mode);
@@ -379,24 +828,26 @@ public:
     }
 
     void stopAction(const std::string& actionName, const std::string& nodeName) {
-        std::string uniqueName = nodeName + "_" + actionName;
-        animationSystem.stopAction(uniqueName);
+        animationSystem.stopAction(actionInstanceId(actionName, nodeName));
     }
 
     void pauseAction(const std::string& actionName, const std::string& nodeName) {
-        std::string uniqueName = nodeName + "_" + actionName;
-        animationSystem.pauseAction(uniqueName);
+        animationSystem.pauseAction(actionInstanceId(actionName, nodeName));
     }
 
     void resumeAction(const std::string& actionName, const std::string& nodeName) {
-        std::string uniqueName = nodeName + "_" + actionName;
-        animationSystem.resumeAction(uniqueName);
+        animationSystem.resumeAction(actionInstanceId(actionName, nodeName));
     }
 
     void stopAllActions() {
         animationSystem.stopAllActions();
     }
 
+    // node + action without building a "node_action" string on every call
+    static StringId actionInstanceId(const std::string& actionName, const std::string& nodeName) {
+        return StringId::combine(StringId(nodeName), StringId(actionName));
+    }
+
     // Get list of available actions for a node
     std::vector<std::string> getAvailableActions(const std::string& nodeName) {
         std::vector<std::string> actions;
@@ -413,8 +864,8 @@ public:
 
     void debugAnimations() {
         std::cout << "\n=== Scene Animations Debug ===\n";
-        for (const auto& [name, activeAction] : animationSystem.getActiveActions()) {
-            std::cout << "Action: " << name << std::endl;
+        for (const auto& [id, activeAction] : animationSystem.getActiveActions()) {
+            std::cout << "Action: " << (activeAction.action ? activeAction.action->name : id.str()) << std::endl;
             std::cout << "  Target Node: " << (activeAction.targetNode ? activeAction.targetNode->name : "none") << std::endl;
             std::cout << "  Playing: " << (activeAction.isPlaying ? "yes" : "no") << std::endl;
             std::cout << "  Weight: " << activeAction.weight << std::endl;
@@ -470,24 +921,33 @@ public:
     // selections
     // Add these new methods
     void addSelectedNode(std::shared_ptr<Node> node) {
-        if (node && std::find(selectedNodes.begin(), selectedNodes.end(), node) == selectedNodes.end()) {
+        if (node && !selectedIndex.count(node.get())) {
+            selectedIndex[node.get()] = selectedNodes.size();
             selectedNodes.push_back(node);
         }
     }
 
     void clearSelection() {
         selectedNodes.clear();
+        selectedIndex.clear();
     }
 
+    // swap-remove, so the selection order isn't kept
     void removeSelectedNode(std::shared_ptr<Node> node) {
-        auto it = std::find(selectedNodes.begin(), selectedNodes.end(), node);
-        if (it != selectedNodes.end()) {
-            selectedNodes.erase(it);
+        auto it = node ? selectedIndex.find(node.get()) : selectedIndex.end();
+        if (it == selectedIndex.end()) return;
+
+        size_t index = it->second;
+        selectedIndex.erase(it);
+        if (index != selectedNodes.size() - 1) {
+            selectedNodes[index] = std::move(selectedNodes.back());
+            selectedIndex[selectedNodes[index].get()] = index;
         }
+        selectedNodes.pop_back();
     }
 
     bool isNodeSelected(std::shared_ptr<Node> node) const {
-        return std::find(selectedNodes.begin(), selectedNodes.end(), node) != selectedNodes.end();
+        return node && selectedIndex.count(node.get()) > 0;
     }
 
 };
\ No newline at end of file
@@ -0,0 +1,106 @@
+// sceneCommands.h
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+class Node;
+class PhysXBody;
+class Scene;
+
+// scene changes recorded from any thread (loaders, gameplay jobs) and applied by the
+// main thread at the start of Scene::update. recording is a lock free push onto an
+// intrusive stack, the main thread takes the whole stack with one exchange and runs
+// it oldest first, so there's no ABA and nothing ever blocks a worker
+class SceneCommandBuffer {
+public:
+    enum class CommandType {
+        AddNode,
+        RemoveNode,
+        Reparent,
+        AddPhysicsBody,
+        Spawn
+    };
+
+    struct Command {
+        CommandType type = CommandType::Spawn;
+        std::shared_ptr<Node> node = nullptr;
+        std::shared_ptr<Node> parent = nullptr;         // Reparent, nullptr = top level
+        std::shared_ptr<PhysXBody> body = nullptr;
+        std::string name = {};
+        std::function<void(Scene&)> spawn = nullptr;    // anything else, runs on the main thread
+        Command* next = nullptr;
+    };
+
+    SceneCommandBuffer() = default;
+    SceneCommandBuffer(const SceneCommandBuffer&) = delete;
+    SceneCommandBuffer& operator=(const SceneCommandBuffer&) = delete;
+
+    ~SceneCommandBuffer() {
+        drain([](Command&) {});
+    }
+
+    void addNode(std::shared_ptr<Node> node, std::string name = "") {
+        push(new Command{ .type = CommandType::AddNode, .node = std::move(node), .name = std::move(name) });
+    }
+
+    // also drops the node's physics body if it has one. pass the name it was added
+    // under to take it out of the registry too
+    void removeNode(std::shared_ptr<Node> node, std::string name = "") {
+        push(new Command{ .type = CommandType::RemoveNode, .node = std::move(node), .name = std::move(name) });
+    }
+
+    void reparent(std::shared_ptr<Node> node, std::shared_ptr<Node> newParent) {
+        push(new Command{ .type = CommandType::Reparent, .node = std::move(node), .parent = std::move(newParent) });
+    }
+
+    void addPhysicsBody(std::shared_ptr<PhysXBody> body, std::string name = "") {
+        push(new Command{ .type = CommandType::AddPhysicsBody, .body = std::move(body), .name = std::move(name) });
+    }
+
+    void spawn(std::function<void(Scene&)> fn) {
+        push(new Command{ .type = CommandType::Spawn, .spawn = std::move(fn) });
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    // main thread only. commands pushed while this runs (a spawn recording more
+    // commands) wait for the next call
+    template<typename Fn>
+    size_t drain(Fn&& execute) {
+        Command* list = head.exchange(nullptr, std::memory_order_acquire);
+
+        // the stack is newest first
+        Command* ordered = nullptr;
+        while (list) {
+            Command* next = list->next;
+            list->next = ordered;
+            ordered = list;
+            list = next;
+        }
+
+        size_t count = 0;
+        while (ordered) {
+            Command* next = ordered->next;
+            execute(*ordered);
+            delete ordered;
+            ordered = next;
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    std::atomic<Command*> head{ nullptr };
+
+    void push(Command* command) {
+        command->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(command->next, command,
+            std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+};
@@ -0,0 +1,1054 @@
+// sceneFile.h
+#pragma once
+#include "scene.h"
+#include "light.h"
+#include "primitveNodes.h"
+#include "textureManager.h"
+#include "jobSystem.h"
+#include "mappedFile.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <type_traits>
+
+// binary level format: header, section table, then 16 byte aligned sections of fixed
+// size records. records only hold indices and offsets relative to their own file, so a
+// mapped file is read in place with no pointer fixups, and meshes/materials don't refer
+// to each other until the link step so they decode in parallel
+namespace scenefile {
+
+constexpr uint32_t MAGIC = 0x4e435347; // "GSCN"
+constexpr uint32_t VERSION = 2;          // 2: NODE_OCCLUDER
+constexpr uint32_t OLDEST_VERSION = 1;   // still readable
+constexpr uint32_t NO_INDEX = 0xffffffffu;
+constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+enum class SectionType : uint32_t {
+    Strings,        // null terminated text, string fields are byte offsets in here (0 is "")
+    Nodes,          // NodeRecord, parents always come before their children
+    Meshes,         // MeshRecord
+    UvSets,         // UvSetRecord
+    MeshMaterials,  // uint32_t material index per mesh material slot
+    Materials,      // MaterialRecord
+    Textures,       // TextureRecord
+    Lights,         // LightRecord
+    Bodies,         // BodyRecord
+    BodyParts,      // uint32_t node index per compound body part
+    Geometry,       // raw vertex/index arrays, MeshRecord/UvSetRecord offsets point in here
+    Count
+};
+
+struct FileHeader {
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t sectionCount = 0;
+    uint32_t reserved = 0;
+};
+
+struct SectionEntry {
+    uint32_t type = 0;
+    uint32_t count = 0;   // records in the section
+    uint64_t offset = 0;  // from the start of the file
+    uint64_t size = 0;    // bytes
+};
+
+enum NodeFlags : uint32_t {
+    NODE_VISIBLE = 1 << 0,
+    NODE_CASTS_SHADOWS = 1 << 1,
+    NODE_RECEIVES_SHADOWS = 1 << 2,
+    NODE_STATIC = 1 << 3,
+    NODE_IMPOSTOR = 1 << 4,
+    NODE_OCCLUDER = 1 << 5
+};
+
+struct NodeRecord {
+    uint32_t name = 0;
+    uint32_t parent = NO_INDEX;
+    uint32_t type = 0;          // NodeType
+    uint32_t flags = 0;
+    float translation[3] = {};
+    float rotation[4] = {};     // w x y z
+    float scale[3] = {};
+    float params[4] = {};       // primitive constructor args (radius, slices... or width, height, depth)
+    uint32_t mesh = NO_INDEX;
+    uint32_t light = NO_INDEX;
+};
+
+enum MeshFlags : uint32_t {
+    MESH_GENERATED = 1 << 0,    // primitive mesh, the node constructor rebuilds it. only materials are stored
+    MESH_ANIMATED = 1 << 1
+};
+
+struct MeshRecord {
+    uint64_t positions = 0;     // byte offsets into Geometry
+    uint64_t normals = 0;
+    uint64_t tangents = 0;
+    uint64_t colors = 0;
+    uint64_t indices = 0;
+    uint64_t materialIds = 0;
+    uint32_t vertexCount = 0;
+    uint32_t normalCount = 0;
+    uint32_t tangentCount = 0;
+    uint32_t colorCount = 0;
+    uint32_t indexCount = 0;
+    uint32_t materialIdCount = 0;
+    uint32_t uvSetFirst = 0;
+    uint32_t uvSetCount = 0;
+    uint32_t materialFirst = 0;
+    uint32_t materialCount = 0;
+    uint32_t flags = 0;
+    uint32_t reserved = 0;
+};
+
+struct UvSetRecord {
+    uint64_t nameHash = 0;      // StringId, the text is only stored if it was interned
+    uint32_t name = 0;
+    uint32_t count = 0;
+    uint64_t data = 0;          // byte offset into Geometry
+};
+
+struct MaterialRecord {
+    uint32_t name = 0;
+    uint32_t textureFirst = 0;
+    uint32_t textureCount = 0;
+    float baseColor[3] = {};
+    float subsurface = 0.0f;
+    float subsurfaceRadius[3] = {};
+    float subsurfaceColor[3] = {};
+    float subsurfaceIOR = 0.0f;
+    float subsurfaceAnisotropy = 0.0f;
+    float metallic = 0.0f;
+    float specular = 0.0f;
+    float specularTint = 0.0f;
+    float roughness = 0.0f;
+    float anisotropic = 0.0f;
+    float anisotropicRotation = 0.0f;
+    float sheen = 0.0f;
+    float sheenTint = 0.0f;
+    float clearcoat = 0.0f;
+    float clearcoatRoughness = 0.0f;
+    float ior = 0.0f;
+    float transmission = 0.0f;
+    float transmissionRoughness = 0.0f;
+    float emission[3] = {};
+    float emissionStrength = 0.0f;
+    float alpha = 0.0f;
+};
+
+struct TextureRecord {
+    uint64_t mapTypeHash = 0;   // key in Material::textureMaps
+    uint32_t mapType = 0;
+    uint32_t path = 0;
+    uint32_t uvSet = 0;
+    float offset[2] = {};
+    float tiling[2] = {};
+    float strength = 0.0f;
+    uint8_t interpolation = 0;
+    uint8_t projection = 0;
+    uint8_t extension = 0;
+    uint8_t colorSpace = 0;
+    uint8_t alphaMode = 0;
+    uint8_t reserved[3] = {};
+};
+
+struct LightRecord {
+    float color[3] = {};
+    float intensity = 0.0f;
+    float radius = 0.0f;
+    float constant = 0.0f;
+    float linear = 0.0f;
+    float quadratic = 0.0f;
+    float innerCutoff = 0.0f;
+    float outerCutoff = 0.0f;
+    float direction[3] = {};
+    float ambientStrength = 0.0f;
+    float shadowBias = 0.0f;
+    float ortho[6] = {};        // left right bottom top near far
+};
+
+struct BodyRecord {
+    uint32_t node = NO_INDEX;
+    uint32_t isStatic = 0;
+    uint32_t partFirst = 0;     // compound parts in BodyParts, none for a single shape body
+    uint32_t partCount = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<NodeRecord> && std::is_trivially_copyable_v<MeshRecord> &&
+    std::is_trivially_copyable_v<UvSetRecord> && std::is_trivially_copyable_v<MaterialRecord> &&
+    std::is_trivially_copyable_v<TextureRecord> && std::is_trivially_copyable_v<LightRecord> &&
+    std::is_trivially_copyable_v<BodyRecord>, "scene file records are written as raw bytes");
+
+inline void store(float* out, const glm::vec2& v) { out[0] = v.x; out[1] = v.y; }
+inline void store(float* out, const glm::vec3& v) { out[0] = v.x; out[1] = v.y; out[2] = v.z; }
+inline glm::vec2 loadVec2(const float* in) { return glm::vec2(in[0], in[1]); }
+inline glm::vec3 loadVec3(const float* in) { return glm::vec3(in[0], in[1], in[2]); }
+
+inline bool isPrimitive(NodeType type) {
+    return type == NodeType::Sphere || type == NodeType::Box || type == NodeType::Cylinder;
+}
+
+// validated view over a mapped scene file. every accessor bounds checks against
+// the mapping so a truncated or corrupt file fails instead of reading past the end
+class SceneFileView {
+public:
+    bool open(const std::string& path) {
+        if (!file.open(path)) return false;
+
+        const uint8_t* bytes = file.data();
+        size_t size = file.size();
+        if (size < sizeof(FileHeader)) return fail(path, "too small");
+
+        const FileHeader* header = reinterpret_cast<const FileHeader*>(bytes);
+        if (header->magic != MAGIC) return fail(path, "not a scene file");
+        if (header->version < OLDEST_VERSION || header->version > VERSION) return fail(path, "unsupported version");
+        version = header->version;
+        if (sizeof(FileHeader) + uint64_t(header->sectionCount) * sizeof(SectionEntry) > size) {
+            return fail(path, "truncated section table");
+        }
+
+        const SectionEntry* entries = reinterpret_cast<const SectionEntry*>(bytes + sizeof(FileHeader));
+        for (uint32_t i = 0; i < header->sectionCount; ++i) {
+            const SectionEntry& entry = entries[i];
+            // unknown sections are from a newer writer, skip them
+            if (entry.type >= static_cast<uint32_t>(SectionType::Count)) continue;
+            if (entry.offset % SECTION_ALIGNMENT != 0 || entry.offset > size || entry.size > size - entry.offset) {
+                return fail(path, "bad section bounds");
+            }
+            sections[entry.type] = &entry;
+        }
+
+        const SectionEntry* strings = sections[static_cast<uint32_t>(SectionType::Strings)];
+        if (strings && strings->size > 0 && bytes[strings->offset + strings->size - 1] != '\0') {
+            return fail(path, "unterminated string table");
+        }
+        return true;
+    }
+
+    template<typename T>
+    const T* records(SectionType type, uint32_t& count) const {
+        count = 0;
+        const SectionEntry* entry = sections[static_cast<uint32_t>(type)];
+        if (!entry || uint64_t(entry->count) * sizeof(T) > entry->size) return nullptr;
+        count = entry->count;
+        return reinterpret_cast<const T*>(file.data() + entry->offset);
+    }
+
+    uint32_t getVersion() const { return version; }
+
+    const char* string(uint32_t offset) const {
+        const SectionEntry* entry = sections[static_cast<uint32_t>(SectionType::Strings)];
+        if (!entry || offset >= entry->size) return "";
+        return reinterpret_cast<const char*>(file.data() + entry->offset + offset);
+    }
+
+    // count elements of T starting at a Geometry byte offset, empty if out of range
+    template<typename T>
+    std::vector<T> geometry(uint64_t offset, uint32_t count) const {
+        const SectionEntry* entry = sections[static_cast<uint32_t>(SectionType::Geometry)];
+        if (!entry || count == 0 || offset > entry->size || uint64_t(count) * sizeof(T) > entry->size - offset) {
+            return {};
+        }
+        std::vector<T> values(count);
+        std::memcpy(values.data(), file.data() + entry->offset + offset, size_t(count) * sizeof(T));
+        return values;
+    }
+
+private:
+    MappedFile file;
+    const SectionEntry* sections[static_cast<uint32_t>(SectionType::Count)] = {};
+    uint32_t version = 0;
+
+    bool fail(const std::string& path, const char* reason) {
+        std::cout << "Scene file " << path << ": " << reason << std::endl;
+        file.close();
+        return false;
+    }
+};
+
+} // namespace scenefile
+
+// writes the scene's nodes (with meshes, materials, texture references and lights)
+// and its physics bodies. embedded textures have no file behind them and are skipped
+class SceneWriter {
+public:
+    static bool save(Scene& scene, const std::string& path) {
+        SceneWriter writer;
+        writer.collect(scene);
+        return writer.write(path);
+    }
+
+private:
+    using NodeRecord = scenefile::NodeRecord;
+    using MeshRecord = scenefile::MeshRecord;
+    using UvSetRecord = scenefile::UvSetRecord;
+    using MaterialRecord = scenefile::MaterialRecord;
+    using TextureRecord = scenefile::TextureRecord;
+    using LightRecord = scenefile::LightRecord;
+    using BodyRecord = scenefile::BodyRecord;
+    using SectionType = scenefile::SectionType;
+
+    std::string strings = std::string(1, '\0');
+    std::unordered_map<std::string, uint32_t> stringOffsets;
+    std::vector<uint8_t> geometry;
+
+    std::vector<NodeRecord> nodes;
+    std::vector<MeshRecord> meshes;
+    std::vector<UvSetRecord> uvSets;
+    std::vector<uint32_t> meshMaterials;
+    std::vector<MaterialRecord> materials;
+    std::vector<TextureRecord> textures;
+    std::vector<LightRecord> lights;
+    std::vector<BodyRecord> bodies;
+    std::vector<uint32_t> bodyParts;
+
+    std::unordered_map<const Node*, uint32_t> nodeIndex;
+    // keyed with the node's slot 0 override too, shared primitive meshes get one record per color
+    std::map<std::pair<const Mesh*, const Material*>, uint32_t> meshIndex;
+    std::unordered_map<const Material*, uint32_t> materialIndex;
+
+    uint32_t addString(const std::string& text) {
+        if (text.empty()) return 0;
+        auto it = stringOffsets.find(text);
+        if (it != stringOffsets.end()) return it->second;
+
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(text);
+        strings.push_back('\0');
+        stringOffsets.emplace(text, offset);
+        return offset;
+    }
+
+    // interned ids keep their text so names survive a round trip, others only keep the hash
+    uint32_t addIdString(StringId id) {
+        std::string text;
+        return StringTable::getInstance().lookup(id, text) ? addString(text) : 0;
+    }
+
+    template<typename T>
+    uint64_t addArray(const std::vector<T>& values) {
+        geometry.resize((geometry.size() + 15) & ~size_t(15));
+        uint64_t offset = geometry.size();
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+        geometry.insert(geometry.end(), bytes, bytes + values.size() * sizeof(T));
+        return offset;
+    }
+
+    void collect(Scene& scene) {
+        for (const auto& node : scene.sceneNodes) {
+            bool isRoot = !node->parent || !scene.sceneNodes.contains(node->parent->sceneHandle);
+            // the live player model stays with the player, Scene::clear keeps it too
+            if (isRoot && !scene.isPlayerNode(node.get())) {
+                addNode(*node, scenefile::NO_INDEX);
+            }
+        }
+
+        for (const auto& body : scene.physicsWorld.bodies) {
+            if (!body->node) continue;
+            auto it = nodeIndex.find(body->node.get());
+            if (it == nodeIndex.end()) continue;
+
+            BodyRecord record;
+            record.node = it->second;
+            record.isStatic = body->isStatic ? 1 : 0;
+            record.partFirst = static_cast<uint32_t>(bodyParts.size());
+            for (const auto& part : body->compoundParts) {
+                auto partIt = nodeIndex.find(part.get());
+                if (partIt != nodeIndex.end()) {
+                    bodyParts.push_back(partIt->second);
+                }
+            }
+            record.partCount = static_cast<uint32_t>(bodyParts.size()) - record.partFirst;
+            bodies.push_back(record);
+        }
+    }
+
+    // depth first so a parent is always written before its children
+    void addNode(const Node& node, uint32_t parent) {
+        if (nodeIndex.count(&node)) return;
+
+        uint32_t index = static_cast<uint32_t>(nodes.size());
+        nodeIndex[&node] = index;
+
+        NodeRecord record;
+        record.name = addString(node.name);
+        record.parent = parent;
+        record.type = static_cast<uint32_t>(node.type);
+        record.flags = (node.visible ? scenefile::NODE_VISIBLE : 0) |
+            (node.castsShadows ? scenefile::NODE_CASTS_SHADOWS : 0) |
+            (node.receivesShadows ? scenefile::NODE_RECEIVES_SHADOWS : 0) |
+            (node.isStatic ? scenefile::NODE_STATIC : 0) |
+            (node.impostor ? scenefile::NODE_IMPOSTOR : 0) |
+            (node.occluder ? scenefile::NODE_OCCLUDER : 0);
+        scenefile::store(record.translation, node.localTranslation);
+        record.rotation[0] = node.localRotation.w;
+        record.rotation[1] = node.localRotation.x;
+        record.rotation[2] = node.localRotation.y;
+        record.rotation[3] = node.localRotation.z;
+        scenefile::store(record.scale, node.localScale);
+        writePrimitiveParams(node, record.params);
+
+        if (node.mesh) {
+            record.mesh = addMesh(*node.mesh, scenefile::isPrimitive(node.type), node.material.get());
+        }
+        if (const auto* light = dynamic_cast<const Light*>(&node)) {
+            record.light = addLight(*light);
+        }
+        nodes.push_back(record);
+
+        for (const auto& child : node.children) {
+            addNode(*child, index);
+        }
+    }
+
+    static void writePrimitiveParams(const Node& node, float* params) {
+        if (const auto* sphere = dynamic_cast<const SphereNode*>(&node)) {
+            params[0] = sphere->radius;
+            params[1] = static_cast<float>(sphere->slices);
+            params[2] = static_cast<float>(sphere->stacks);
+        }
+        else if (const auto* box = dynamic_cast<const BoxNode*>(&node)) {
+            params[0] = box->width;
+            params[1] = box->height;
+            params[2] = box->depth;
+        }
+        else if (const auto* cylinder = dynamic_cast<const CylinderNode*>(&node)) {
+            params[0] = cylinder->radius;
+            params[1] = cylinder->height;
+            params[2] = static_cast<float>(cylinder->slices);
+            params[3] = static_cast<float>(cylinder->stacks);
+        }
+    }
+
+    uint32_t addMesh(const Mesh& mesh, bool generated, const Material* override = nullptr) {
+        auto it = meshIndex.find({ &mesh, override });
+        if (it != meshIndex.end()) return it->second;
+
+        MeshRecord record;
+        record.flags = (generated ? scenefile::MESH_GENERATED : 0) | (mesh.isAnimated ? scenefile::MESH_ANIMATED : 0);
+
+        if (!generated) {
+            record.positions = addArray(mesh.positions);
+            record.vertexCount = static_cast<uint32_t>(mesh.positions.size());
+            record.normals = addArray(mesh.normals);
+            record.normalCount = static_cast<uint32_t>(mesh.normals.size());
+            record.tangents = addArray(mesh.tangents);
+            record.tangentCount = static_cast<uint32_t>(mesh.tangents.size());
+            record.colors = addArray(mesh.colors);
+            record.colorCount = static_cast<uint32_t>(mesh.colors.size());
+            record.indices = addArray(mesh.indices);
+            record.indexCount = static_cast<uint32_t>(mesh.indices.size());
+            record.materialIds = addArray(mesh.materialIds);
+            record.materialIdCount = static_cast<uint32_t>(mesh.materialIds.size());
+
+            record.uvSetFirst = static_cast<uint32_t>(uvSets.size());
+            for (const auto& [name, uvs] : mesh.uvSets) {
+                UvSetRecord uvSet;
+                uvSet.nameHash = name.getHash();
+                uvSet.name = addIdString(name);
+                uvSet.count = static_cast<uint32_t>(uvs.size());
+                uvSet.data = addArray(uvs);
+                uvSets.push_back(uvSet);
+            }
+            record.uvSetCount = static_cast<uint32_t>(uvSets.size()) - record.uvSetFirst;
+        }
+
+        // materials go last, addMaterial can't run in the middle of this mesh's slot range
+        std::vector<uint32_t> slots;
+        for (size_t slot = 0; slot < mesh.materials.size(); ++slot) {
+            const Material* material = slot == 0 && override ? override : mesh.materials[slot].get();
+            slots.push_back(material ? addMaterial(*material) : scenefile::NO_INDEX);
+        }
+        record.materialFirst = static_cast<uint32_t>(meshMaterials.size());
+        record.materialCount = static_cast<uint32_t>(slots.size());
+        meshMaterials.insert(meshMaterials.end(), slots.begin(), slots.end());
+
+        uint32_t index = static_cast<uint32_t>(meshes.size());
+        meshIndex[{ &mesh, override }] = index;
+        meshes.push_back(record);
+        return index;
+    }
+
+    uint32_t addMaterial(const Material& material) {
+        auto it = materialIndex.find(&material);
+        if (it != materialIndex.end()) return it->second;
+
+        MaterialRecord record;
+        record.name = addString(material.name);
+        scenefile::store(record.baseColor, material.baseColor);
+        record.subsurface = material.subsurface;
+        scenefile::store(record.subsurfaceRadius, material.subsurfaceRadius);
+        scenefile::store(record.subsurfaceColor, material.subsurfaceColor);
+        record.subsurfaceIOR = material.subsurfaceIOR;
+        record.subsurfaceAnisotropy = material.subsurfaceAnisotropy;
+        record.metallic = material.metallic;
+        record.specular = material.specular;
+        record.specularTint = material.specularTint;
+        record.roughness = material.roughness;
+        record.anisotropic = material.anisotropic;
+        record.anisotropicRotation = material.anisotropicRotation;
+        record.sheen = material.sheen;
+        record.sheenTint = material.sheenTint;
+        record.clearcoat = material.clearcoat;
+        record.clearcoatRoughness = material.clearcoatRoughness;
+        record.ior = material.ior;
+        record.transmission = material.transmission;
+        record.transmissionRoughness = material.transmissionRoughness;
+        scenefile::store(record.emission, material.emission);
+        record.emissionStrength = material.emissionStrength;
+        record.alpha = material.alpha;
+
+        record.textureFirst = static_cast<uint32_t>(textures.size());
+        for (const auto& [mapType, map] : material.textureMaps) {
+            std::string path = TextureManager::getInstance().GetTexturePath(map.textureId);
+            if (path.empty()) continue;
+
+            TextureRecord texture;
+            texture.mapTypeHash = mapType.getHash();
+            texture.mapType = addIdString(mapType);
+            texture.path = addString(path);
+            texture.uvSet = addString(map.uvSet);
+            scenefile::store(texture.offset, map.offset);
+            scenefile::store(texture.tiling, map.tiling);
+            texture.strength = map.strength;
+            texture.interpolation = static_cast<uint8_t>(map.interpolation);
+            texture.projection = static_cast<uint8_t>(map.projection);
+            texture.extension = static_cast<uint8_t>(map.extension);
+            texture.colorSpace = static_cast<uint8_t>(map.colorSpace);
+            texture.alphaMode = static_cast<uint8_t>(map.alphaMode);
+            textures.push_back(texture);
+        }
+        record.textureCount = static_cast<uint32_t>(textures.size()) - record.textureFirst;
+
+        uint32_t index = static_cast<uint32_t>(materials.size());
+        materialIndex[&material] = index;
+        materials.push_back(record);
+        return index;
+    }
+
+    uint32_t addLight(const Light& light) {
+        LightRecord record;
+        scenefile::store(record.color, light.color);
+        record.intensity = light.intensity;
+        if (const auto* point = dynamic_cast<const PointLight*>(&light)) {
+            record.radius = point->lightRadius;
+            record.constant = point->constant;
+            record.linear = point->linear;
+            record.quadratic = point->quadratic;
+        }
+        if (const auto* spot = dynamic_cast<const SpotLight*>(&light)) {
+            record.innerCutoff = spot->innerCutoff;
+            record.outerCutoff = spot->outerCutoff;
+            scenefile::store(record.direction, spot->direction);
+        }
+        if (const auto* sun = dynamic_cast<const SunLight*>(&light)) {
+            scenefile::store(record.direction, sun->direction);
+            record.ambientStrength = sun->ambientStrength;
+            record.shadowBias = sun->shadowBias;
+            const float ortho[6] = { sun->left, sun->right, sun->bottom, sun->top, sun->near, sun->far };
+            std::memcpy(record.ortho, ortho, sizeof(ortho));
+        }
+        lights.push_back(record);
+        return static_cast<uint32_t>(lights.size() - 1);
+    }
+
+    struct PendingSection {
+        SectionType type;
+        uint32_t count;
+        const void* data;
+        uint64_t size;
+    };
+
+    template<typename T>
+    static PendingSection section(SectionType type, const std::vector<T>& values) {
+        return { type, static_cast<uint32_t>(values.size()), values.data(), values.size() * sizeof(T) };
+    }
+
+    bool write(const std::string& path) const {
+        const PendingSection pending[] = {
+            { SectionType::Strings, 1, strings.data(), strings.size() },
+            section(SectionType::Nodes, nodes),
+            section(SectionType::Meshes, meshes),
+            section(SectionType::UvSets, uvSets),
+            section(SectionType::MeshMaterials, meshMaterials),
+            section(SectionType::Materials, materials),
+            section(SectionType::Textures, textures),
+            section(SectionType::Lights, lights),
+            section(SectionType::Bodies, bodies),
+            section(SectionType::BodyParts, bodyParts),
+            { SectionType::Geometry, 1, geometry.data(), geometry.size() },
+        };
+        constexpr uint32_t sectionCount = sizeof(pending) / sizeof(pending[0]);
+
+        auto align = [](uint64_t offset) {
+            return (offset + scenefile::SECTION_ALIGNMENT - 1) & ~(scenefile::SECTION_ALIGNMENT - 1);
+        };
+
+        scenefile::FileHeader header;
+        header.sectionCount = sectionCount;
+
+        scenefile::SectionEntry entries[sectionCount];
+        uint64_t offset = align(sizeof(header) + sizeof(entries));
+        for (uint32_t i = 0; i < sectionCount; ++i) {
+            entries[i].type = static_cast<uint32_t>(pending[i].type);
+            entries[i].count = pending[i].count;
+            entries[i].offset = offset;
+            entries[i].size = pending[i].size;
+            offset = align(offset + pending[i].size);
+        }
+
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(parent, error);
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cout << "SceneWriter: could not write " << path << std::endl;
+            return false;
+        }
+
+        static const char padding[scenefile::SECTION_ALIGNMENT] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries), sizeof(entries));
+        uint64_t written = sizeof(header) + sizeof(entries);
+        for (uint32_t i = 0; i < sectionCount; ++i) {
+            file.write(padding, entries[i].offset - written);
+            file.write(static_cast<const char*>(pending[i].data), pending[i].size);
+            written = entries[i].offset + pending[i].size;
+        }
+
+        std::cout << "Saved scene " << path << ": " << nodes.size() << " nodes, " << meshes.size() << " meshes, "
+            << materials.size() << " materials, " << bodies.size() << " bodies, " << written / 1024 << " KB" << std::endl;
+        return file.good();
+    }
+};
+
+// one scene file decoded off the GL thread. SceneLoader::instantiate() puts it in a
+// scene, SceneLoader::remove() takes it out again (the world streamer keeps one per cell)
+struct SceneChunk {
+    struct PendingTexture {
+        uint32_t material = 0;
+        StringId mapType;
+        std::string type;
+        Material::TextureMap map;
+        TextureManager::DecodedImage image;
+    };
+
+    std::string path;
+    std::vector<std::shared_ptr<Node>> nodes;           // file order
+    std::vector<std::shared_ptr<Node>> roots;
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    std::vector<std::shared_ptr<Material>> materials;
+    std::vector<PendingTexture> textures;               // decoded pixels waiting for upload
+    std::vector<std::shared_ptr<PhysXBody>> bodies;     // per body record, actors not in the PxScene yet
+    std::vector<std::string> texturePaths;              // TextureManager references, streamed chunks only
+    size_t memoryBytes = 0;                             // mesh + texture data, for streaming budgets
+    bool streamed = false;                              // owned by a WorldStreamer cell, not the scene
+    bool decoded = false;
+    bool instantiated = false;
+};
+
+// maps a scene file and appends its contents to a scene. decode() needs no GL context and
+// can run on a loader thread (file, meshes, materials, nodes, texture decode, collision
+// actors), instantiate() does texture uploads and scene insertion on the GL thread
+class SceneLoader {
+public:
+    static bool load(Scene& scene, const std::string& path) {
+        SceneChunk chunk;
+        if (!decode(path, chunk)) return false;
+        instantiate(scene, chunk);
+        return true;
+    }
+
+    static bool decode(const std::string& path, SceneChunk& chunk) {
+        using namespace scenefile;
+
+        SceneFileView view;
+        if (!view.open(path)) return false;
+
+        uint32_t nodeCount, meshCount, uvSetCount, meshMaterialCount, materialCount;
+        uint32_t textureCount, lightCount, bodyCount, bodyPartCount;
+        const NodeRecord* nodeRecords = view.records<NodeRecord>(SectionType::Nodes, nodeCount);
+        const MeshRecord* meshRecords = view.records<MeshRecord>(SectionType::Meshes, meshCount);
+        const UvSetRecord* uvSetRecords = view.records<UvSetRecord>(SectionType::UvSets, uvSetCount);
+        const uint32_t* meshMaterials = view.records<uint32_t>(SectionType::MeshMaterials, meshMaterialCount);
+        const MaterialRecord* materialRecords = view.records<MaterialRecord>(SectionType::Materials, materialCount);
+        const TextureRecord* textureRecords = view.records<TextureRecord>(SectionType::Textures, textureCount);
+        const LightRecord* lightRecords = view.records<LightRecord>(SectionType::Lights, lightCount);
+        const BodyRecord* bodyRecords = view.records<BodyRecord>(SectionType::Bodies, bodyCount);
+        const uint32_t* bodyParts = view.records<uint32_t>(SectionType::BodyParts, bodyPartCount);
+
+        std::vector<SceneChunk::PendingTexture> textures;
+        std::vector<const TextureRecord*> pendingRecords;
+#ifndef ENGINE_HEADLESS
+        for (uint32_t i = 0; i < materialCount; ++i) {
+            const MaterialRecord& record = materialRecords[i];
+            if (uint64_t(record.textureFirst) + record.textureCount > textureCount) continue;
+            for (uint32_t t = record.textureFirst; t < record.textureFirst + record.textureCount; ++t) {
+                if (!*view.string(textureRecords[t].path)) continue;
+                textures.push_back({ i });
+                pendingRecords.push_back(&textureRecords[t]);
+            }
+        }
+#endif
+
+        // meshes, materials and texture files are independent until linked, decode all of them in one parallel pass
+        std::vector<std::shared_ptr<Mesh>> meshes(meshCount);
+        std::vector<std::shared_ptr<Material>> materials(materialCount);
+        size_t jobCount = size_t(meshCount) + materialCount + textures.size();
+        JobSystem::getInstance().parallelFor(jobCount, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (i < meshCount) {
+                    meshes[i] = decodeMesh(view, meshRecords[i], uvSetRecords, uvSetCount);
+                }
+                else if (i < size_t(meshCount) + materialCount) {
+                    materials[i - meshCount] = decodeMaterial(view, materialRecords[i - meshCount]);
+                }
+                else {
+                    size_t t = i - meshCount - materialCount;
+                    decodeTexture(view, *pendingRecords[t], textures[t]);
+                }
+            }
+        });
+
+        for (uint32_t i = 0; i < meshCount; ++i) {
+            const MeshRecord& record = meshRecords[i];
+            chunk.memoryBytes += meshes[i]->getMemoryBytes();
+            if (record.materialCount == 0 || uint64_t(record.materialFirst) + record.materialCount > meshMaterialCount) continue;
+
+            meshes[i]->materials.clear();
+            for (uint32_t slot = 0; slot < record.materialCount; ++slot) {
+                uint32_t material = meshMaterials[record.materialFirst + slot];
+                meshes[i]->materials.push_back(material < materialCount ? materials[material] : makePooled<Material, pools::Materials>());
+            }
+        }
+        for (const auto& texture : textures) {
+            chunk.memoryBytes += size_t(texture.image.width) * texture.image.height * texture.image.channels;
+        }
+
+        // parents come first in the file, addChild builds each world transform from the parent's
+        chunk.nodes.assign(nodeCount, nullptr);
+        for (uint32_t i = 0; i < nodeCount; ++i) {
+            const NodeRecord& record = nodeRecords[i];
+            const LightRecord* light = record.light < lightCount ? &lightRecords[record.light] : nullptr;
+
+            std::shared_ptr<Node> node = isPrimitive(static_cast<NodeType>(record.type))
+                ? createPrimitive(record) : createNode(record, light);
+            applyRecord(view, record, *node);
+
+            if (record.mesh < meshCount) {
+                if (meshRecords[record.mesh].flags & MESH_GENERATED) {
+                    // constructor built (or fetched the cached) geometry, the stored material
+                    // becomes the node's own so the shared mesh stays untouched
+                    if (node->mesh && !meshes[record.mesh]->materials.empty()) {
+                        node->material = meshes[record.mesh]->materials[0];
+                    }
+                }
+                else {
+                    node->mesh = meshes[record.mesh];
+                }
+            }
+
+            if (record.parent < i) {
+                chunk.nodes[record.parent]->addChild(node);
+            }
+            else {
+                node->updateWorldTransform();
+                chunk.roots.push_back(node);
+            }
+            chunk.nodes[i] = node;
+        }
+
+        for (uint32_t i = 0; i < meshCount; ++i) {
+            if (!(meshRecords[i].flags & MESH_GENERATED)) {
+                meshes[i]->markForUpload();
+            }
+        }
+
+        // actors are built here but only join the PxScene in instantiate
+        chunk.bodies.assign(bodyCount, nullptr);
+        for (uint32_t i = 0; i < bodyCount; ++i) {
+            const BodyRecord& record = bodyRecords[i];
+            if (record.node >= nodeCount) continue;
+
+            std::vector<std::shared_ptr<Node>> parts;
+            if (uint64_t(record.partFirst) + record.partCount <= bodyPartCount) {
+                for (uint32_t p = record.partFirst; p < record.partFirst + record.partCount; ++p) {
+                    if (bodyParts[p] < nodeCount) parts.push_back(chunk.nodes[bodyParts[p]]);
+                }
+            }
+
+            if (parts.empty()) {
+                auto body = makePooled<PhysXBody, pools::Bodies>(chunk.nodes[record.node], record.isStatic != 0, false);
+                body->createGeometryFromMesh();
+                body->createActor(false);
+                chunk.bodies[i] = body;
+            }
+            else {
+                chunk.bodies[i] = makePooled<PhysXBody, pools::Bodies>(chunk.nodes[record.node], parts, record.isStatic != 0, false);
+            }
+        }
+
+        std::cout << "Decoded scene " << path << ": " << nodeCount << " nodes, " << meshCount << " meshes, "
+            << materialCount << " materials, " << bodyCount << " bodies" << std::endl;
+
+        // everything is copied out of the mapping, it closes with the view
+        chunk.path = path;
+        chunk.meshes = std::move(meshes);
+        chunk.materials = std::move(materials);
+        chunk.textures = std::move(textures);
+        chunk.decoded = true;
+        return true;
+    }
+
+    // GL thread: texture uploads and scene insertion. meshes are already in the upload queue
+    static void instantiate(Scene& scene, SceneChunk& chunk) {
+        if (!chunk.decoded || chunk.instantiated) return;
+
+        for (auto& texture : chunk.textures) {
+#ifndef ENGINE_HEADLESS
+            if (chunk.streamed) {
+                // the cell frees its textures again when it unloads
+                texture.map.textureId = TextureManager::getInstance().AcquireTexture(texture.image, texture.type, texture.map);
+                chunk.texturePaths.push_back(texture.image.path);
+            }
+            else {
+                texture.map.textureId = TextureManager::getInstance().UploadTexture(texture.image, texture.type, texture.map);
+            }
+            chunk.materials[texture.material]->textureMaps[texture.mapType] = texture.map;
+#else
+            if (texture.image.data) stbi_image_free(texture.image.data);
+#endif
+        }
+        chunk.textures.clear();
+
+        for (const auto& root : chunk.roots) {
+            scene.addNode(root);
+        }
+        for (const auto& node : chunk.nodes) {
+            if (!node->name.empty()) {
+                scene.nodeRegistry[internString(node->name)] = node;
+            }
+            if (auto spot = std::dynamic_pointer_cast<SpotLight>(node)) scene.addSpotLight(spot);
+            if (auto sun = std::dynamic_pointer_cast<SunLight>(node)) scene.addSunLight(sun);
+        }
+
+        for (const auto& body : chunk.bodies) {
+            if (!body) continue;
+            body->addActorToScene();
+            scene.addPhysicsBody(body);
+            if (chunk.streamed) scene.streamedBodies.insert(body.get());
+        }
+
+        chunk.instantiated = true;
+    }
+
+    // undoes instantiate (or throws away a decoded chunk that never got there).
+    // textures shared with other chunks or the rest of the scene stay cached
+    static void remove(Scene& scene, SceneChunk& chunk) {
+        for (const auto& body : chunk.bodies) {
+            if (!body) continue;
+            scene.physicsWorld.removeBody(body);
+            scene.streamedBodies.erase(body.get());
+            // merged static bodies have no actor of their own, only their shapes come out
+            scene.staticWorld.removeStaticBody(body.get());
+            body->releaseActor();
+        }
+
+        for (const auto& node : chunk.nodes) {
+            // the upload queue may have given it buffers even if it never got instantiated.
+            // cached primitive meshes are still drawn by nodes outside this chunk
+            if (node->mesh && !node->mesh->shared) {
+                node->mesh->releaseBuffers();
+            }
+            if (chunk.instantiated) {
+                if (auto spot = std::dynamic_pointer_cast<SpotLight>(node)) {
+                    scene.removeSpotLight(spot);
+                }
+                else if (auto sun = std::dynamic_pointer_cast<SunLight>(node)) {
+                    scene.removeSunLight(sun);
+                }
+                else {
+                    scene.removeNode(node);
+                }
+
+                auto it = scene.nodeRegistry.find(StringId(node->name));
+                if (it != scene.nodeRegistry.end() && it->second == node) {
+                    scene.nodeRegistry.erase(it);
+                }
+            }
+        }
+
+        for (auto& texture : chunk.textures) {
+            if (texture.image.data) stbi_image_free(texture.image.data);
+        }
+        for (const auto& path : chunk.texturePaths) {
+            TextureManager::getInstance().ReleaseTexture(path);
+        }
+        chunk.texturePaths.clear();
+
+        chunk.nodes.clear();
+        chunk.roots.clear();
+        chunk.meshes.clear();
+        chunk.materials.clear();
+        chunk.textures.clear();
+        chunk.bodies.clear();
+        chunk.memoryBytes = 0;
+        chunk.decoded = false;
+        chunk.instantiated = false;
+    }
+
+private:
+    static std::shared_ptr<Mesh> decodeMesh(const scenefile::SceneFileView& file, const scenefile::MeshRecord& record,
+        const scenefile::UvSetRecord* uvSetRecords, uint32_t uvSetCount) {
+        auto mesh = makePooled<Mesh, pools::Meshes>(false);
+        mesh->isAnimated = (record.flags & scenefile::MESH_ANIMATED) != 0;
+        if (record.flags & scenefile::MESH_GENERATED) return mesh;
+
+        mesh->positions = file.geometry<glm::vec3>(record.positions, record.vertexCount);
+        mesh->normals = file.geometry<glm::vec3>(record.normals, record.normalCount);
+        mesh->tangents = file.geometry<glm::vec3>(record.tangents, record.tangentCount);
+        mesh->colors = file.geometry<glm::vec4>(record.colors, record.colorCount);
+        mesh->indices = file.geometry<unsigned int>(record.indices, record.indexCount);
+        mesh->materialIds = file.geometry<int>(record.materialIds, record.materialIdCount);
+
+        if (uint64_t(record.uvSetFirst) + record.uvSetCount <= uvSetCount) {
+            for (uint32_t i = record.uvSetFirst; i < record.uvSetFirst + record.uvSetCount; ++i) {
+                const scenefile::UvSetRecord& uvSet = uvSetRecords[i];
+                mesh->uvSets[readId(file, uvSet.name, uvSet.nameHash)] = file.geometry<glm::vec2>(uvSet.data, uvSet.count);
+            }
+        }
+        return mesh;
+    }
+
+    static std::shared_ptr<Material> decodeMaterial(const scenefile::SceneFileView& file, const scenefile::MaterialRecord& record) {
+        using namespace scenefile;
+        auto material = makePooled<Material, pools::Materials>();
+        material->name = file.string(record.name);
+        material->baseColor = loadVec3(record.baseColor);
+        material->subsurface = record.subsurface;
+        material->subsurfaceRadius = loadVec3(record.subsurfaceRadius);
+        material->subsurfaceColor = loadVec3(record.subsurfaceColor);
+        material->subsurfaceIOR = record.subsurfaceIOR;
+        material->subsurfaceAnisotropy = record.subsurfaceAnisotropy;
+        material->metallic = record.metallic;
+        material->specular = record.specular;
+        material->specularTint = record.specularTint;
+        material->roughness = record.roughness;
+        material->anisotropic = record.anisotropic;
+        material->anisotropicRotation = record.anisotropicRotation;
+        material->sheen = record.sheen;
+        material->sheenTint = record.sheenTint;
+        material->clearcoat = record.clearcoat;
+        material->clearcoatRoughness = record.clearcoatRoughness;
+        material->ior = record.ior;
+        material->transmission = record.transmission;
+        material->transmissionRoughness = record.transmissionRoughness;
+        material->emission = loadVec3(record.emission);
+        material->emissionStrength = record.emissionStrength;
+        material->alpha = record.alpha;
+        return material;
+    }
+
+    static void decodeTexture(const scenefile::SceneFileView& file, const scenefile::TextureRecord& record,
+        SceneChunk::PendingTexture& texture) {
+        using TextureMap = Material::TextureMap;
+        TextureMap& map = texture.map;
+        map.uvSet = file.string(record.uvSet);
+        map.offset = scenefile::loadVec2(record.offset);
+        map.tiling = scenefile::loadVec2(record.tiling);
+        map.strength = record.strength;
+        map.interpolation = static_cast<TextureMap::Interpolation>(record.interpolation);
+        map.projection = static_cast<TextureMap::Projection>(record.projection);
+        map.extension = static_cast<TextureMap::Extension>(record.extension);
+        map.colorSpace = static_cast<TextureMap::ColorSpace>(record.colorSpace);
+        map.alphaMode = static_cast<TextureMap::AlphaMode>(record.alphaMode);
+
+        texture.mapType = readId(file, record.mapType, record.mapTypeHash);
+        texture.type = file.string(record.mapType);
+        texture.image = TextureManager::DecodeImage(file.string(record.path), map);
+    }
+
+    static void applyRecord(const scenefile::SceneFileView& file, const scenefile::NodeRecord& record, Node& node) {
+        using namespace scenefile;
+        node.name = file.string(record.name);
+        node.localTranslation = loadVec3(record.translation);
+        node.localRotation = glm::quat(record.rotation[0], record.rotation[1], record.rotation[2], record.rotation[3]);
+        node.localScale = loadVec3(record.scale);
+        node.visible = (record.flags & NODE_VISIBLE) != 0;
+        node.castsShadows = (record.flags & NODE_CASTS_SHADOWS) != 0;
+        node.receivesShadows = (record.flags & NODE_RECEIVES_SHADOWS) != 0;
+        node.isStatic = (record.flags & NODE_STATIC) != 0;
+        node.impostor = (record.flags & NODE_IMPOSTOR) != 0;
+        // version 1 files predate the flag, keep what the constructor set (boxes)
+        if (file.getVersion() >= 2) node.occluder = (record.flags & NODE_OCCLUDER) != 0;
+    }
+
+    static std::shared_ptr<Node> createPrimitive(const scenefile::NodeRecord& record) {
+        const float* p = record.params;
+        switch (static_cast<NodeType>(record.type)) {
+        case NodeType::Sphere:
+            return makePooled<SphereNode, pools::Primitives>(p[0], static_cast<int>(p[1]), static_cast<int>(p[2]));
+        case NodeType::Box:
+            return makePooled<BoxNode, pools::Primitives>(p[0], p[1], p[2]);
+        case NodeType::Cylinder:
+            return makePooled<CylinderNode, pools::Primitives>(p[0], p[1], static_cast<int>(p[2]), static_cast<int>(p[3]));
+        default:
+            return makePooled<Node, pools::Nodes>();
+        }
+    }
+
+    // lights and plain nodes, nothing here touches GL
+    static std::shared_ptr<Node> createNode(const scenefile::NodeRecord& record, const scenefile::LightRecord* light) {
+        using scenefile::loadVec3;
+
+        switch (static_cast<NodeType>(record.type)) {
+        case NodeType::PointLight:
+        case NodeType::SpotLight: {
+            auto point = record.type == static_cast<uint32_t>(NodeType::SpotLight)
+                ? std::make_shared<SpotLight>() : std::make_shared<PointLight>();
+            if (light) {
+                point->color = loadVec3(light->color);
+                point->intensity = light->intensity;
+                point->lightRadius = light->radius;
+                point->constant = light->constant;
+                point->linear = light->linear;
+                point->quadratic = light->quadratic;
+                if (auto spot = std::dynamic_pointer_cast<SpotLight>(point)) {
+                    spot->innerCutoff = light->innerCutoff;
+                    spot->outerCutoff = light->outerCutoff;
+                    spot->direction = loadVec3(light->direction);
+                }
+            }
+            return point;
+        }
+        case NodeType::SunLight: {
+            auto sun = std::make_shared<SunLight>();
+            if (light) {
+                sun->color = loadVec3(light->color);
+                sun->intensity = light->intensity;
+                sun->direction = loadVec3(light->direction);
+                sun->ambientStrength = light->ambientStrength;
+                sun->shadowBias = light->shadowBias;
+                sun->left = light->ortho[0];
+                sun->right = light->ortho[1];
+                sun->bottom = light->ortho[2];
+                sun->top = light->ortho[3];
+                sun->near = light->ortho[4];
+                sun->far = light->ortho[5];
+            }
+            return sun;
+        }
+        default:
+            return makePooled<Node, pools::Nodes>();
+        }
+    }
+
+    // interned text when the writer had it, so the id prints by name again
+    static StringId readId(const scenefile::SceneFileView& file, uint32_t name, uint64_t hash) {
+        const char* text = file.string(name);
+        return *text ? internString(text) : StringId::fromHash(hash);
+    }
+};
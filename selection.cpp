@@ -143,11 +143,11 @@ bool SelectionSystem::handleSelection(double mouseX, double mouseY, int screenWi
 void SelectionSystem::drawRay(Ray ray, float length, Scene& scene) {
     std::cout << "\n --- Drawing Ray --- \n";
     // Save current shader program
-    GLint currentProgram;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+    GLStateCache& gl = GLStateCache::getInstance();
+    GLuint currentProgram = gl.getProgram();
 
     // Disable the main shader and switch to a basic shader for lines
-    glUseProgram(0);
+    gl.useProgram(0);
 
     // Save current polygon mode
     GLint previousPolygonMode[2];
@@ -178,5 +178,5 @@ void SelectionSystem::drawRay(Ray ray, float length, Scene& scene) {
     glPolygonMode(GL_BACK, previousPolygonMode[1]);
 
     // Restore previous shader program
-    glUseProgram(currentProgram);
+    if (currentProgram != GLStateCache::UNKNOWN) gl.useProgram(currentProgram);
 }
@@ -1,6 +1,7 @@
 // shader.h
 #pragma once
 #include "GameEngine.h"
+#include "glState.h"
 
 class Shader
 {
@@ -101,7 +102,7 @@ private:
 public:
     void use()
     {
-        glUseProgram(ID);
+        GLStateCache::getInstance().useProgram(ID);
     }
     void setBool(const std::string& name, bool value) const
     {
@@ -1,10 +1,12 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 7) in mat4 aInstanceModel;  // 7-10, instanced draws only
 
 uniform mat4 lightSpaceMatrix;
 uniform mat4 model;
+uniform bool instanced;
 
 void main()
 {
-	gl_Position = lightSpaceMatrix  * model * vec4(aPos, 1.0);
+	gl_Position = lightSpaceMatrix  * (instanced ? aInstanceModel : model) * vec4(aPos, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#version 330 core
+layout(location = 0) out vec4 outColor;     // albedo, alpha = coverage
+layout(location = 1) out vec4 outNormal;    // mesh space normal * 0.5 + 0.5
+
+in vec3 Normal;
+in vec2 TexCoord;
+
+// the material table entry, same layout as the main shader's MaterialData. only the base
+// color is read, texture projection modes aren't baked, flat uvs only
+const int MATERIALS_PER_PAGE = 48;
+
+struct MaterialData {
+    vec4 baseColor;
+    vec4 subsurfaceColor;
+    vec4 subsurfaceRadius;
+    vec4 surface;
+    vec4 sheen;
+    vec4 coat;
+    vec4 emission;
+    vec4 ior;
+    ivec4 maps;
+    ivec4 projections[2];
+    vec4 uvTransforms[8];
+};
+
+layout(std140) uniform Materials {
+    MaterialData materials[MATERIALS_PER_PAGE];
+};
+
+uniform int materialIndex;
+uniform sampler2D baseColorMap;
+
+void main() {
+    MaterialData material = materials[materialIndex];
+    vec3 albedo = material.baseColor.rgb;
+    if ((material.maps.x & 1) != 0) {
+        vec4 transform = material.uvTransforms[0];
+        albedo = texture(baseColorMap, TexCoord * transform.zw + transform.xy).rgb;
+    }
+
+    vec3 N = normalize(Normal);
+    if (!gl_FrontFacing) N = -N;
+
+    outColor = vec4(albedo, 1.0);
+    outNormal = vec4(N * 0.5 + 0.5, 1.0);
+}
@@ -0,0 +1,71 @@
+#version 330 core
+out vec4 FragColor;
+
+const int MAX_SPOT_LIGHTS = 4;
+const float ambientFactor = 0.3;
+const float PI = 3.14159265359;
+
+in vec3 FragPos;
+in vec2 AtlasUV;
+flat in float Layer;
+flat in vec4 Rotation;
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    vec3 color;
+    float intensity;
+    float constant;
+    float linear;
+    float quadratic;
+    float innerCutoff;
+    float outerCutoff;
+};
+
+uniform SpotLight spotLights[MAX_SPOT_LIGHTS];
+uniform int numActiveSpotLights;
+
+uniform sampler2DArray colorAtlas;
+uniform sampler2DArray normalAtlas;
+
+vec3 rotate(vec4 q, vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+// diffuse only with the main shader's cone and attenuation, no shadows. a few pixels
+// on screen don't show the difference
+vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 albedo) {
+    vec3 lightDir = normalize(light.position - fragPos);
+    float theta = dot(lightDir, normalize(-light.direction));
+    if (theta < light.outerCutoff) return vec3(0.0);
+    float cone = clamp((theta - light.outerCutoff) / (light.innerCutoff - light.outerCutoff), 0.0, 1.0);
+
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+
+    return albedo / PI * light.color * light.intensity * attenuation * cone * max(dot(normal, lightDir), 0.0);
+}
+
+void main() {
+    vec4 albedo = texture(colorAtlas, vec3(AtlasUV, Layer));
+    if (albedo.a < 0.5) discard;
+
+    vec3 N = normalize(rotate(Rotation, texture(normalAtlas, vec3(AtlasUV, Layer)).xyz * 2.0 - 1.0));
+
+    vec3 lighting = vec3(0.0);
+    for (int i = 0; i < numActiveSpotLights && i < MAX_SPOT_LIGHTS; ++i) {
+        lighting += calcSpotLight(spotLights[i], N, FragPos, albedo.rgb);
+    }
+    vec3 color = albedo.rgb * ambientFactor + lighting;
+
+    // same tone mapping and gamma as the main shader
+    const float a = 2.51;
+    const float b = 0.03;
+    const float c = 2.43;
+    const float d = 0.59;
+    const float e = 0.14;
+    color = clamp((color * (a * color + b)) / (color * (c * color + d) + e), 0.0, 1.0);
+    color = pow(color, vec3(1.0 / 2.2));
+
+    FragColor = vec4(color, 1.0);
+}
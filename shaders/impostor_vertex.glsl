@@ -0,0 +1,60 @@
+#version 330 core
+layout(location = 0) in vec2 aCorner;           // -1..1 quad corner
+layout(location = 1) in vec4 aCenterRadius;     // world space bounding sphere
+layout(location = 2) in vec4 aRotation;         // mesh to world quaternion
+layout(location = 3) in vec4 aLayer;            // x = atlas layer
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+uniform float gridSize;
+
+out vec3 FragPos;
+out vec2 AtlasUV;
+flat out float Layer;
+flat out vec4 Rotation;
+
+vec3 rotate(vec4 q, vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+// octahedral mapping (y up), must match ImpostorRenderer::octDecode
+vec2 octEncode(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.xz;
+    if (n.y < 0.0) {
+        e = (1.0 - abs(n.zx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+    }
+    return e * 0.5 + 0.5;
+}
+
+vec3 octDecode(vec2 uv) {
+    vec2 e = uv * 2.0 - 1.0;
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    if (n.y < 0.0) {
+        n.xz = (1.0 - abs(n.zx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    vec3 center = aCenterRadius.xyz;
+    vec4 inverseRotation = vec4(-aRotation.xyz, aRotation.w);
+
+    // camera direction in mesh space picks the nearest baked view
+    vec3 toCamera = rotate(inverseRotation, normalize(viewPos - center));
+    vec2 cell = clamp(floor(octEncode(toCamera) * gridSize), vec2(0.0), vec2(gridSize - 1.0));
+    vec3 d = octDecode((cell + 0.5) / gridSize);
+
+    // same basis glm::lookAt gave the bake camera, so the quad lines up with the view
+    vec3 up = abs(d.y) > 0.99 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 right = normalize(cross(-d, up));
+    up = cross(right, -d);
+    vec3 offset = rotate(aRotation, right * aCorner.x + up * aCorner.y) * aCenterRadius.w;
+
+    FragPos = center + offset;
+    AtlasUV = (cell + aCorner * 0.5 + 0.5) / gridSize;
+    Layer = aLayer.x;
+    Rotation = aRotation;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -9,6 +9,7 @@ in vec3 Normal;
 in vec2 TexCoord;
 in vec4 FragPosLightSpace[MAX_SPOT_LIGHTS];
 in vec3 Tangent;
+flat in int MaterialIndex;
 
 // Texture projection modes
 #define PROJECTION_FLAT 0
@@ -16,6 +17,7 @@ in vec3 Tangent;
 #define PROJECTION_SPHERE 2
 #define PROJECTION_TUBE 3
 
+// this fragment's material, unpacked from the table at the top of main()
 struct Material {
     // Base Properties
     vec3 baseColor;
@@ -41,7 +43,6 @@ struct Material {
     // Clearcoat
     float clearcoat;
     float clearcoatRoughness;
-    float clearcoatIOR;
 
     // Transmission
     float transmission;
@@ -53,15 +54,6 @@ struct Material {
     float emissionStrength;
     float alpha;
 
-    // Textures
-    sampler2D baseColorMap;
-    sampler2D normalMap;
-    sampler2D metallicMap;
-    sampler2D roughnessMap;
-    sampler2D emissionMap;
-    sampler2D occlusionMap;
-    sampler2D transmissionMap;
-
     // UV Transforms
     vec2 baseColorOffset;
     vec2 baseColorTiling;
@@ -97,6 +89,36 @@ struct Material {
 
 };
 
+// MaterialTable::Entry, the table is bound one page at a time
+const int MATERIALS_PER_PAGE = 48;
+
+struct MaterialData {
+    vec4 baseColor;         // a = alpha
+    vec4 subsurfaceColor;   // a = subsurface
+    vec4 subsurfaceRadius;  // a = subsurfaceIOR
+    vec4 surface;           // metallic, specular, specularTint, roughness
+    vec4 sheen;             // anisotropic, anisotropicRotation, sheen, sheenTint
+    vec4 coat;              // clearcoat, clearcoatRoughness, transmission, transmissionRoughness
+    vec4 emission;          // a = emissionStrength
+    vec4 ior;               // ior, subsurfaceAnisotropy
+    ivec4 maps;             // x = one bit per texture unit with a map
+    ivec4 projections[2];   // per texture unit
+    vec4 uvTransforms[8];   // xy offset, zw tiling
+};
+
+layout(std140) uniform Materials {
+    MaterialData materials[MATERIALS_PER_PAGE];
+};
+
+// texture units are fixed, see Material::textureUnits
+uniform sampler2D baseColorMap;
+uniform sampler2D normalMap;
+uniform sampler2D metallicMap;
+uniform sampler2D roughnessMap;
+uniform sampler2D emissionMap;
+uniform sampler2D occlusionMap;
+uniform sampler2D transmissionMap;
+
 // Lights properties
 struct PointLight {
     vec3 position;
@@ -126,7 +148,7 @@ uniform int numActiveSpotLights;
 
 uniform vec3 viewPos;
 uniform sampler2D shadowMaps[MAX_SPOT_LIGHTS];
-uniform Material material;
+Material material;
 
 const float PI = 3.14159265359;
 const float EPSILON = 0.00001;
@@ -329,13 +351,77 @@ vec3 calcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, int
 }
 
 
+int projectionOf(MaterialData data, int unit) {
+    return data.projections[unit / 4][unit % 4];
+}
+
+Material unpackMaterial(MaterialData data) {
+    Material m;
+    m.baseColor = data.baseColor.rgb;
+    m.alpha = data.baseColor.a;
+    m.subsurfaceColor = data.subsurfaceColor.rgb;
+    m.subsurface = data.subsurfaceColor.a;
+    m.subsurfaceRadius = data.subsurfaceRadius.rgb;
+    m.subsurfaceIOR = data.subsurfaceRadius.a;
+    m.metallic = data.surface.x;
+    m.specular = data.surface.y;
+    m.specularTint = data.surface.z;
+    m.roughness = data.surface.w;
+    m.anisotropic = data.sheen.x;
+    m.anisotropicRotation = data.sheen.y;
+    m.sheen = data.sheen.z;
+    m.sheenTint = data.sheen.w;
+    m.clearcoat = data.coat.x;
+    m.clearcoatRoughness = data.coat.y;
+    m.transmission = data.coat.z;
+    m.transmissionRoughness = data.coat.w;
+    m.emission = data.emission.rgb;
+    m.emissionStrength = data.emission.a;
+    m.ior = data.ior.x;
+
+    // units 0-7: baseColor, normal, metallic, roughness, emission, occlusion, specular, transmission
+    m.hasBaseColorMap = (data.maps.x & 1) != 0;
+    m.hasNormalMap = (data.maps.x & 2) != 0;
+    m.hasMetallicMap = (data.maps.x & 4) != 0;
+    m.hasRoughnessMap = (data.maps.x & 8) != 0;
+    m.hasEmissionMap = (data.maps.x & 16) != 0;
+    m.hasOcclusionMap = (data.maps.x & 32) != 0;
+    m.hasTransmissionMap = (data.maps.x & 128) != 0;
+
+    m.baseColorProjection = projectionOf(data, 0);
+    m.normalProjection = projectionOf(data, 1);
+    m.metallicProjection = projectionOf(data, 2);
+    m.roughnessProjection = projectionOf(data, 3);
+    m.emissionProjection = projectionOf(data, 4);
+    m.occlusionProjection = projectionOf(data, 5);
+    m.transmissionProjection = projectionOf(data, 7);
+
+    m.baseColorOffset = data.uvTransforms[0].xy;
+    m.baseColorTiling = data.uvTransforms[0].zw;
+    m.normalOffset = data.uvTransforms[1].xy;
+    m.normalTiling = data.uvTransforms[1].zw;
+    m.metallicOffset = data.uvTransforms[2].xy;
+    m.metallicTiling = data.uvTransforms[2].zw;
+    m.roughnessOffset = data.uvTransforms[3].xy;
+    m.roughnessTiling = data.uvTransforms[3].zw;
+    m.emissionOffset = data.uvTransforms[4].xy;
+    m.emissionTiling = data.uvTransforms[4].zw;
+    m.occlusionOffset = data.uvTransforms[5].xy;
+    m.occlusionTiling = data.uvTransforms[5].zw;
+    m.transmissionOffset = data.uvTransforms[7].xy;
+    m.transmissionTiling = data.uvTransforms[7].zw;
+    return m;
+}
+
 void main() {
+    material = unpackMaterial(materials[MaterialIndex]);
+
     // Sample all textures with their transforms
     vec3 albedo = vec3(1.0);
     if (material.hasBaseColorMap) {
         vec2 baseColorUV = getProjectedUV(TexCoord, material.baseColorProjection, FragPos, Normal);
         baseColorUV = (baseColorUV * material.baseColorTiling) + material.baseColorOffset;
-        albedo *= texture(material.baseColorMap, baseColorUV).rgb;
+        albedo *= texture(baseColorMap, baseColorUV).rgb;
     }
     else {
         albedo = material.baseColor;
@@ -352,7 +438,7 @@ void main() {
     if (material.hasNormalMap) {
         vec2 normalUV = getProjectedUV(TexCoord, material.normalProjection, FragPos, Normal);
         normalUV = (normalUV * material.normalTiling) + material.normalOffset;
-        vec3 tangentNormal = texture(material.normalMap, normalUV).xyz * 2.0 - 1.0;
+        vec3 tangentNormal = texture(normalMap, normalUV).xyz * 2.0 - 1.0;
         N = normalize(TBN * tangentNormal);
     }
 
@@ -361,7 +447,7 @@ void main() {
     if (material.hasMetallicMap) {
         vec2 metallicUV = getProjectedUV(TexCoord, material.metallicProjection, FragPos, Normal);
         metallicUV = (metallicUV * material.metallicTiling) + material.metallicOffset;
-        metallic *= texture(material.metallicMap, metallicUV).r;
+        metallic *= texture(metallicMap, metallicUV).r;
     }
     else {
         metallic = material.metallic;
@@ -372,7 +458,7 @@ void main() {
     if (material.hasRoughnessMap) {
         vec2 roughnessUV = getProjectedUV(TexCoord, material.roughnessProjection, FragPos, Normal);
         roughnessUV = (roughnessUV * material.roughnessTiling) + material.roughnessOffset;
-        roughness *= texture(material.roughnessMap, roughnessUV).r;
+        roughness *= texture(roughnessMap, roughnessUV).r;
     }
     else {
 		roughness = material.roughness;
@@ -383,7 +469,7 @@ void main() {
     if (material.hasEmissionMap) {
         vec2 emissionUV = getProjectedUV(TexCoord, material.emissionProjection, FragPos, Normal);
         emissionUV = (emissionUV * material.emissionTiling) + material.emissionOffset;
-        emission *= texture(material.emissionMap, emissionUV).rgb;
+        emission *= texture(emissionMap, emissionUV).rgb;
     }
     else {
         emission = material.emission;
@@ -394,7 +480,7 @@ void main() {
     if (material.hasOcclusionMap) {
         vec2 occlusionUV = getProjectedUV(TexCoord, material.occlusionProjection, FragPos, Normal);
         occlusionUV = (occlusionUV * material.occlusionTiling) + material.occlusionOffset;
-        occlusion = texture(material.occlusionMap, occlusionUV).r;
+        occlusion = texture(occlusionMap, occlusionUV).r;
     }
 
     // Sample transmission with projection
@@ -402,7 +488,7 @@ void main() {
     if (material.hasTransmissionMap) {
         vec2 transmissionUV = getProjectedUV(TexCoord, material.transmissionProjection, FragPos, Normal);
         transmissionUV = (transmissionUV * material.transmissionTiling) + material.transmissionOffset;
-        transmission *= texture(material.transmissionMap, transmissionUV).r;
+        transmission *= texture(transmissionMap, transmissionUV).r;
     }
 
 
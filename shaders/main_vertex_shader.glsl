@@ -4,6 +4,8 @@ layout(location = 1) in vec3 aNormal;
 layout(location = 2) in vec4 aColor;
 layout(location = 3) in vec2 aTexCoord;
 layout(location = 4) in vec3 aTangent;
+layout(location = 7) in mat4 aInstanceModel;  // 7-10, instanced draws only
+layout(location = 11) in int aInstanceMaterial;  // material table index, instanced draws only
 
 const int MAX_SPOT_LIGHTS = 4;
 
@@ -13,8 +15,11 @@ out vec4 Color;
 out vec2 TexCoord;
 out vec4 FragPosLightSpace[MAX_SPOT_LIGHTS];
 out vec3 Tangent;
+flat out int MaterialIndex;
 
 uniform mat4 model;
+uniform bool instanced;
+uniform int materialIndex;
 uniform mat4 view;
 uniform mat4 projection;
 
@@ -23,12 +28,14 @@ uniform mat4 spotLightSpaceMatrix[MAX_SPOT_LIGHTS];
 uniform int numActiveSpotLights;
 
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    mat3 normalMatrix = transpose(inverse(mat3(model)));
+    mat4 modelMatrix = instanced ? aInstanceModel : model;
+    FragPos = vec3(modelMatrix * vec4(aPos, 1.0));
+    mat3 normalMatrix = transpose(inverse(mat3(modelMatrix)));
     Normal = normalMatrix * aNormal;
     Tangent = normalMatrix * aTangent;
     Color = aColor;
     TexCoord = aTexCoord;
+    MaterialIndex = instanced ? aInstanceMaterial : materialIndex;
 
     // Calculate light space positions for all active spot lights
     for (int i = 0; i < numActiveSpotLights && i < MAX_SPOT_LIGHTS; ++i) {
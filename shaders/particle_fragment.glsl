@@ -0,0 +1,14 @@
+#version 330 core
+in vec4 particleColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    // round soft sprite
+    vec2 coord = gl_PointCoord * 2.0 - 1.0;
+    float r2 = dot(coord, coord);
+    if (r2 > 1.0) discard;
+
+    FragColor = vec4(particleColor.rgb, particleColor.a * (1.0 - r2));
+}
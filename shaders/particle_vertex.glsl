@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec4 aPosSize;   // xyz position, w world space diameter
+layout (location = 1) in vec4 aColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float viewportHeight;
+
+out vec4 particleColor;
+
+void main()
+{
+    vec4 viewPos = view * vec4(aPosSize.xyz, 1.0);
+    gl_Position = projection * viewPos;
+
+    // projection[1][1] is 1/tan(fov/2), turns world size into pixels at this depth
+    float pixels = aPosSize.w * projection[1][1] * 0.5 * viewportHeight / max(-viewPos.z, 0.001);
+    gl_PointSize = max(pixels, 1.0);
+
+    particleColor = aColor;
+}
@@ -2,6 +2,7 @@
 #pragma once
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include "glState.h"
 
 class ShadowMap {
 public:
@@ -25,7 +26,7 @@ public:
         glGenFramebuffers(1, &depthMapFBO);
         glGenTextures(1, &depthMap);
 
-        glBindTexture(GL_TEXTURE_2D, depthMap);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, depthMap);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT,
             shadowWidth, shadowHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 
@@ -48,7 +49,7 @@ public:
         }
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, 0);
     }
 
     void bindForWriting() {
@@ -59,9 +60,10 @@ public:
 
     void bindForReading(GLuint textureUnit) {
 
+        GLStateCache& gl = GLStateCache::getInstance();
         // Bind shadow map to specified unit
-        glActiveTexture(textureUnit);
-        glBindTexture(GL_TEXTURE_2D, depthMap);
+        gl.activeTexture(textureUnit);
+        gl.bindTexture(GL_TEXTURE_2D, depthMap);
 
 
     }
@@ -7,7 +7,19 @@
 #include "misc_funcs.h"
 #include "light.h"
 #include "paths.h"
-
+#include "frameArena.h"
+#include "bounds.h"
+#include "instancedRenderer.h"
+#include <functional>
+#include <span>
+
+// a mesh drawn without a Node behind it (ECS entities)
+struct RenderItem {
+    Mesh* mesh = nullptr;
+    glm::mat4 model = glm::mat4(1.0f);
+    bool castsShadows = true;
+    Material* material = nullptr;   // slot 0, null = the mesh's own. the other slots always are
+};
 
 class ShadowRenderer {
 private:
@@ -27,6 +39,9 @@ private:
 public:
     bool shadowsEnabled = true;
 
+    // groups repeated meshes into instanced draws in both passes
+    InstancedRenderer instances;
+
     ShadowRenderer() {
         
 
@@ -41,6 +56,12 @@ public:
         Shader mainShader(Paths::Shaders::vertexShader.c_str(), Paths::Shaders::fragmentShader.c_str());
         mainShaderProgram = mainShader.getShaderProgram();
 
+        // material table locations and sampler units, once per program
+        for (GLuint program : { depthShaderProgram, mainShaderProgram }) {
+            GLStateCache::getInstance().useProgram(program);
+            MaterialTable::getInstance().setupProgram(program);
+        }
+
 
         // Initialize shadow maps for maximum number of lights
         shadowMaps.resize(MAX_SPOT_LIGHTS);
@@ -54,6 +75,16 @@ public:
         lightSpaceMatrices.push_back(glm::mat4(0.0f));
     }
 
+    void removeSpotLight(const std::shared_ptr<SpotLight>& spotlight) {
+        for (size_t i = 0; i < activeLights.size(); ++i) {
+            if (activeLights[i] == spotlight) {
+                activeLights.erase(activeLights.begin() + i);
+                lightSpaceMatrices.erase(lightSpaceMatrices.begin() + i);
+                return;
+            }
+        }
+    }
+
     void setShadowProperties(float near, float far) {
         nearPlane = near;
         farPlane = far;
@@ -63,7 +94,10 @@ public:
         shadowsEnabled = enabled;
     }
 
-    void renderShadowPass(const std::vector<std::shared_ptr<Node>>& sceneNodes) {
+    // fills casters with the nodes to draw into one light's shadow map
+    using CasterQuery = std::function<void(const Frustum& lightFrustum, FrameVector<Node*>& casters)>;
+
+    void renderShadowPass(const CasterQuery& gatherCasters, std::span<const RenderItem> items = {}) {
         if (!shadowsEnabled) return;
 
         // Update for each active light
@@ -82,26 +116,34 @@ public:
 
             lightSpaceMatrices[i] = lightProjection * lightView;
 
+            // only what this light can see, casters outside the camera view still count
+            FrameVector<Node*> casters;
+            gatherCasters(Frustum(lightSpaceMatrices[i]), casters);
+
 
             // Render shadow map for this light
             shadowMaps[i].bindForWriting();
             glClear(GL_DEPTH_BUFFER_BIT);
 
-            glUseProgram(depthShaderProgram);
+            GLStateCache::getInstance().useProgram(depthShaderProgram);
             glUniformMatrix4fv(
                 glGetUniformLocation(depthShaderProgram, "lightSpaceMatrix"),
                 1, GL_FALSE, glm::value_ptr(lightSpaceMatrices[i])
             );
 
-            for (const auto& node : sceneNodes) {
+            FrameVector<InstancedRenderer::Entry> entries;
+            entries.reserve(casters.size() + items.size());
+            for (Node* node : casters) {
                 if (node->mesh && node->castsShadows) {
-                    glUniformMatrix4fv(
-                        glGetUniformLocation(depthShaderProgram, "model"),
-                        1, GL_FALSE, glm::value_ptr(node->worldTransform)
-                    );
-                    node->mesh->drawShadow(depthShaderProgram);
+                    entries.push_back({ node->getLodMesh(), &node->worldTransform, nullptr });
+                }
+            }
+            for (const auto& item : items) {
+                if (item.castsShadows) {
+                    entries.push_back({ item.mesh, &item.model, nullptr });
                 }
             }
+            instances.drawShadow(entries, depthShaderProgram);
         }
 
         
@@ -111,7 +153,7 @@ public:
 
     void prepareMainPass(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos) {
 
-        glUseProgram(mainShaderProgram);
+        GLStateCache::getInstance().useProgram(mainShaderProgram);
 
         // Set common uniforms
         glUniformMatrix4fv(glGetUniformLocation(mainShaderProgram, "projection"),
@@ -126,40 +168,33 @@ public:
         glUniform1i(glGetUniformLocation(mainShaderProgram, "numActiveSpotLights"),
             std::min((int)activeLights.size(), MAX_SPOT_LIGHTS));
 
-        // Set light properties for all active lights
+        // Set light properties for all active lights, uniform names go on the frame arena
+        FrameArena& arena = FrameArena::getInstance();
+        auto lightUniform = [&](size_t i, const char* field) {
+            return glGetUniformLocation(mainShaderProgram, arena.format("spotLights[%zu].%s", i, field));
+        };
+
         for (size_t i = 0; i < activeLights.size() && i < MAX_SPOT_LIGHTS; ++i) {
-            std::string base = "spotLights[" + std::to_string(i) + "].";
-            std::string baseForMatrices = "spotLightSpaceMatrix[" + std::to_string(i) + "]";
             auto& light = activeLights[i];
 
-            glUniformMatrix4fv(glGetUniformLocation(mainShaderProgram, baseForMatrices.c_str()),
+            glUniformMatrix4fv(glGetUniformLocation(mainShaderProgram, arena.format("spotLightSpaceMatrix[%zu]", i)),
                 1, GL_FALSE, glm::value_ptr(lightSpaceMatrices[i]));
             
 
-            glUniform3fv(glGetUniformLocation(mainShaderProgram, (base + "position").c_str()),
-                1, glm::value_ptr(light->getWorldPosition()));
-            glUniform3fv(glGetUniformLocation(mainShaderProgram, (base + "direction").c_str()),
-                1, glm::value_ptr(light->direction));
-            glUniform3fv(glGetUniformLocation(mainShaderProgram, (base + "color").c_str()),
-                1, glm::value_ptr(light->color));
-            glUniform1f(glGetUniformLocation(mainShaderProgram, (base + "intensity").c_str()),
-                light->intensity);
-            glUniform1f(glGetUniformLocation(mainShaderProgram, (base + "constant").c_str()),
-                light->constant);
-            glUniform1f(glGetUniformLocation(mainShaderProgram, (base + "linear").c_str()),
-                light->linear);
-            glUniform1f(glGetUniformLocation(mainShaderProgram, (base + "quadratic").c_str()),
-                light->quadratic);
-            glUniform1f(glGetUniformLocation(mainShaderProgram, (base + "innerCutoff").c_str()),
-                light->innerCutoff);
-            glUniform1f(glGetUniformLocation(mainShaderProgram, (base + "outerCutoff").c_str()),
-                light->outerCutoff);
+            glUniform3fv(lightUniform(i, "position"), 1, glm::value_ptr(light->getWorldPosition()));
+            glUniform3fv(lightUniform(i, "direction"), 1, glm::value_ptr(light->direction));
+            glUniform3fv(lightUniform(i, "color"), 1, glm::value_ptr(light->color));
+            glUniform1f(lightUniform(i, "intensity"), light->intensity);
+            glUniform1f(lightUniform(i, "constant"), light->constant);
+            glUniform1f(lightUniform(i, "linear"), light->linear);
+            glUniform1f(lightUniform(i, "quadratic"), light->quadratic);
+            glUniform1f(lightUniform(i, "innerCutoff"), light->innerCutoff);
+            glUniform1f(lightUniform(i, "outerCutoff"), light->outerCutoff);
 
             // Bind shadow map for this light
             if (shadowsEnabled) {
                 shadowMaps[i].bindForReading(GL_TEXTURE0 + SHADOW_MAP_TEXTURE_UNIT + i);
-                glUniform1i(glGetUniformLocation(mainShaderProgram,
-                    ("shadowMaps[" + std::to_string(i) + "]").c_str()),
+                glUniform1i(glGetUniformLocation(mainShaderProgram, arena.format("shadowMaps[%zu]", i)),
                     SHADOW_MAP_TEXTURE_UNIT + i);
             }
 
@@ -169,31 +204,26 @@ public:
 
     }
 
-    void renderMainPass(const std::vector<std::shared_ptr<Node>>& sceneNodes, const glm::mat4& view, const glm::mat4& projection) {
-        glUseProgram(mainShaderProgram);
+    // instancing = false draws in the given order, for the sorted transparent pass
+    void renderMainPass(std::span<Node* const> sceneNodes, const glm::mat4& view, const glm::mat4& projection,
+        std::span<const RenderItem> items = {}, bool instancing = true) {
+        GLStateCache::getInstance().useProgram(mainShaderProgram);
 
-        // Draw nodes in scene
-        for (const auto& node : sceneNodes) {
+        // nodes in scene, then entities
+        FrameVector<InstancedRenderer::Entry> entries;
+        entries.reserve(sceneNodes.size() + items.size());
+        for (Node* node : sceneNodes) {
             if (node->mesh && node->visible) {
-
-                glUniformMatrix4fv(
-                    glGetUniformLocation(mainShaderProgram, "model"),
-                    1, GL_FALSE,
-                    glm::value_ptr(node->worldTransform)
-                );
-
-                //set material properties
-                // Bind the material for this mesh
-                if (!node->mesh->materials.empty() && node->mesh->materials[0]) {;
-                    //node->mesh->materials[0]->debug();
-                    node->mesh->materials[0]->bind(mainShaderProgram);
-                }
-
-                // Draw the mesh
-                node->mesh->draw(mainShaderProgram);
+                entries.push_back({ node->getLodMesh(), &node->worldTransform, node->getMaterial().get() });
             }
         }
-
+        for (const auto& item : items) {
+            // Mesh::draw binds the mesh's own material for every other slot
+            Material* material = item.material;
+            if (!material && !item.mesh->materials.empty()) material = item.mesh->materials[0].get();
+            entries.push_back({ item.mesh, &item.model, material });
+        }
+        instances.drawMain(entries, mainShaderProgram, instancing);
     }
 
     // Getter methods
@@ -0,0 +1,45 @@
+// simd.h
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// SSE is baseline on every x64 target we build for, everything else gets the scalar paths
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENGINE_SIMD_SSE 1
+#include <emmintrin.h>
+#endif
+
+// allocator for SoA arrays so _mm_load_ps/_mm_store_ps can be used directly
+template<typename T, size_t Alignment = 16>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T, 16>>;
+
+// round up to a whole number of 4-wide lanes
+inline size_t simdPadding(size_t count) {
+    return (count + 3) & ~size_t(3);
+}
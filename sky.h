@@ -1,6 +1,7 @@
 // sky.h
 #pragma once
 #include "GameEngine.h"
+#include "glState.h"
 #include "shader.h"
 #include "background.h"
 
@@ -142,7 +143,7 @@ private:
         glBindFramebuffer(GL_FRAMEBUFFER, environmentMapFBO);
 
         glGenTextures(1, &environmentMap);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, environmentMap);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_CUBE_MAP, environmentMap);
         for (unsigned int i = 0; i < 6; ++i) {
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, 512, 512, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
         }
@@ -193,8 +194,9 @@ public:
     }
 
     void render(const glm::mat4& view, const glm::mat4& projection) override {
-        glDepthFunc(GL_LEQUAL);
-        glUseProgram(skyShaderProgram);
+        GLStateCache& gl = GLStateCache::getInstance();
+        gl.depthFunc(GL_LEQUAL);
+        gl.useProgram(skyShaderProgram);
 
         // Calculate sun direction from elevation and rotation
         float elevRad = glm::radians(params.sunElevation);
@@ -220,10 +222,10 @@ public:
         glUniform1i(glGetUniformLocation(skyShaderProgram, "enableSunDisc"), params.enableSunDisc);
 
         // Render sky quad
-        glBindVertexArray(VAO);
+        gl.bindVertexArray(VAO);
         glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
+        gl.bindVertexArray(0);
 
-        glDepthFunc(GL_LESS);
+        gl.depthFunc(GL_LESS);
     }
 };
\ No newline at end of file
@@ -0,0 +1,129 @@
+// slotMap.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// index + generation. a handle to a removed element stays invalid even after its
+// slot gets reused, so stale handles fail the lookup instead of hitting a new object
+struct SlotHandle {
+    static constexpr uint32_t INVALID_INDEX = 0xffffffffu;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != INVALID_INDEX; }
+    bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+// values are kept packed in one vector (iterate it like a plain vector), slots map
+// handles to their current dense position. add, remove and lookup are all O(1),
+// remove swaps the last element into the hole so iteration order isn't stable
+template<typename T>
+class SlotMap {
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    SlotHandle insert(T value) {
+        uint32_t slotIndex;
+        if (!freeSlots.empty()) {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.push_back({});
+        }
+
+        Slot& slot = slots[slotIndex];
+        slot.denseIndex = static_cast<uint32_t>(dense.size());
+        dense.push_back(std::move(value));
+        denseToSlot.push_back(slotIndex);
+
+        return { slotIndex, slot.generation };
+    }
+
+    bool remove(SlotHandle handle) {
+        if (!contains(handle)) return false;
+
+        Slot& slot = slots[handle.index];
+        uint32_t hole = slot.denseIndex;
+        uint32_t last = static_cast<uint32_t>(dense.size() - 1);
+
+        if (hole != last) {
+            dense[hole] = std::move(dense[last]);
+            denseToSlot[hole] = denseToSlot[last];
+            slots[denseToSlot[hole]].denseIndex = hole;
+        }
+        dense.pop_back();
+        denseToSlot.pop_back();
+
+        slot.denseIndex = SlotHandle::INVALID_INDEX;
+        ++slot.generation;
+        freeSlots.push_back(handle.index);
+        return true;
+    }
+
+    bool contains(SlotHandle handle) const {
+        return handle.index < slots.size()
+            && slots[handle.index].generation == handle.generation
+            && slots[handle.index].denseIndex != SlotHandle::INVALID_INDEX;
+    }
+
+    T* get(SlotHandle handle) {
+        return contains(handle) ? &dense[slots[handle.index].denseIndex] : nullptr;
+    }
+
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &dense[slots[handle.index].denseIndex] : nullptr;
+    }
+
+    // handle of the element currently at a dense position
+    SlotHandle handleAt(size_t denseIndex) const {
+        uint32_t slotIndex = denseToSlot[denseIndex];
+        return { slotIndex, slots[slotIndex].generation };
+    }
+
+    void clear() {
+        for (uint32_t slotIndex : denseToSlot) {
+            slots[slotIndex].denseIndex = SlotHandle::INVALID_INDEX;
+            ++slots[slotIndex].generation;
+            freeSlots.push_back(slotIndex);
+        }
+        dense.clear();
+        denseToSlot.clear();
+    }
+
+    void reserve(size_t count) {
+        dense.reserve(count);
+        denseToSlot.reserve(count);
+        slots.reserve(count);
+    }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+    T& operator[](size_t denseIndex) { return dense[denseIndex]; }
+    const T& operator[](size_t denseIndex) const { return dense[denseIndex]; }
+
+    // packed values, for code that wants a plain vector
+    const std::vector<T>& values() const { return dense; }
+
+    iterator begin() { return dense.begin(); }
+    iterator end() { return dense.end(); }
+    const_iterator begin() const { return dense.begin(); }
+    const_iterator end() const { return dense.end(); }
+
+private:
+    struct Slot {
+        uint32_t denseIndex = SlotHandle::INVALID_INDEX;
+        uint32_t generation = 0;
+    };
+
+    std::vector<T> dense;
+    std::vector<uint32_t> denseToSlot;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+};
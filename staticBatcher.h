@@ -0,0 +1,288 @@
+// staticBatcher.h
+#pragma once
+#include "object3D.h"
+#include "slotMap.h"
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+// nodes flagged isStatic get their triangles merged into one mesh per material (and vertex
+// layout, shadow flag and grid cell), already in world space, so a whole batch is one
+// material bind and one draw call. the cells keep batches small enough that frustum and
+// occlusion culling still throw most of them away. a batch is only rebuilt when one of
+// its nodes was edited, moved or removed
+class StaticBatcher {
+public:
+    float cellSize = 32.0f;     // world units, changing it needs markAllDirty
+
+    struct Batch {
+        std::shared_ptr<Mesh> mesh;     // world space, draw it with an identity model matrix
+        bool castsShadows = true;
+        std::vector<Node*> sources;
+        bool dirty = true;
+    };
+
+    // node was added, moved, edited or had isStatic toggled. has to be in the scene
+    void markDirty(Node* node) {
+        dirtyNodes.insert(node);
+    }
+
+    // before the node leaves the scene, the pointer isn't kept after this
+    void remove(Node* node) {
+        dirtyNodes.erase(node);
+        detach(node);
+    }
+
+    void markAllDirty() {
+        fullRebuild = true;
+    }
+
+    // GL thread, right before drawing. rebuilds only the batches that got dirty
+    void update(const SlotMap<std::shared_ptr<Node>>& sceneNodes) {
+        if (fullRebuild) {
+            clear();
+            fullRebuild = false;
+            for (const auto& node : sceneNodes) {
+                attach(node.get());
+            }
+        }
+        else {
+            // a material turned transparent, its nodes have to go back to the sorted pass
+            for (const auto& [key, batch] : batches) {
+                if (key.material->alpha < 1.0f) {
+                    dirtyNodes.insert(batch.sources.begin(), batch.sources.end());
+                }
+            }
+
+            for (Node* node : dirtyNodes) {
+                detach(node);
+                if (sceneNodes.contains(node->sceneHandle)) {
+                    attach(node);
+                }
+            }
+        }
+        dirtyNodes.clear();
+
+        for (auto it = batches.begin(); it != batches.end();) {
+            Batch& batch = it->second;
+            if (!batch.dirty) {
+                ++it;
+                continue;
+            }
+            if (batch.sources.empty()) {
+                if (batch.mesh) batch.mesh->releaseBuffers();
+                it = batches.erase(it);
+                continue;
+            }
+            rebuild(it->first, batch);
+            ++it;
+        }
+    }
+
+    // drops every batch, the nodes go back to drawing themselves
+    void clear() {
+        for (auto& [key, batch] : batches) {
+            if (batch.mesh) batch.mesh->releaseBuffers();
+        }
+        for (auto& [node, keys] : nodeBatches) {
+            node->staticBatched = false;
+        }
+        batches.clear();
+        nodeBatches.clear();
+        dirtyNodes.clear();
+        fullRebuild = true;
+    }
+
+    template<typename Fn>
+    void forEachBatch(Fn&& fn) const {
+        for (const auto& [key, batch] : batches) {
+            if (batch.mesh) fn(batch);
+        }
+    }
+
+    size_t getBatchCount() const { return batches.size(); }
+    size_t getBatchedNodeCount() const { return nodeBatches.size(); }
+    size_t getRebuildCount() const { return rebuildCount; }
+
+private:
+    // vertex attributes every source in the batch has
+    enum Layout : uint8_t {
+        LAYOUT_NORMALS = 1 << 0,
+        LAYOUT_COLORS = 1 << 1,
+        LAYOUT_UVS = 1 << 2
+    };
+
+    struct BatchKey {
+        Material* material;     // the batch mesh holds the shared_ptr
+        uint8_t layout;
+        bool castsShadows;
+        int cellX, cellY, cellZ;
+
+        bool operator<(const BatchKey& other) const {
+            return std::tie(material, layout, castsShadows, cellX, cellY, cellZ) <
+                std::tie(other.material, other.layout, other.castsShadows, other.cellX, other.cellY, other.cellZ);
+        }
+    };
+
+    std::map<BatchKey, Batch> batches;
+    std::unordered_map<Node*, std::vector<BatchKey>> nodeBatches;
+    std::unordered_set<Node*> dirtyNodes;
+    bool fullRebuild = true;
+    size_t rebuildCount = 0;
+
+    static const std::vector<glm::vec2>* defaultUVs(const Mesh& mesh) {
+        auto it = mesh.uvSets.find(Mesh::DEFAULT_UV_SET);
+        return it != mesh.uvSets.end() ? &it->second : nullptr;
+    }
+
+    static uint8_t layoutOf(const Mesh& mesh) {
+        size_t count = mesh.positions.size();
+        const auto* uvs = defaultUVs(mesh);
+        return (mesh.normals.size() == count ? LAYOUT_NORMALS : 0) |
+            (mesh.colors.size() == count ? LAYOUT_COLORS : 0) |
+            (uvs && uvs->size() == count ? LAYOUT_UVS : 0);
+    }
+
+    // material slot used by triangle t
+    static int materialSlot(const Mesh& mesh, size_t triangle) {
+        if (mesh.materialIds.empty()) return 0;
+        return triangle < mesh.materialIds.size() ? mesh.materialIds[triangle] : -1;
+    }
+
+    static size_t triangleCount(const Mesh& mesh) {
+        return (mesh.indices.empty() ? mesh.positions.size() : mesh.indices.size()) / 3;
+    }
+
+    static bool isBatchable(const Node* node) {
+        if (!node->isStatic || !node->visible || !node->mesh) return false;
+        const Mesh& mesh = *node->mesh;
+        if (mesh.isAnimated || mesh.positions.empty() || mesh.materials.empty()) return false;
+        for (size_t slot = 0; slot < mesh.materials.size(); ++slot) {
+            auto material = node->getMaterial(slot);
+            if (!material || material->alpha < 1.0f) return false;
+        }
+        return true;
+    }
+
+    void attach(Node* node) {
+        if (!isBatchable(node)) return;
+        const Mesh& mesh = *node->mesh;
+
+        glm::vec3 center = node->getWorldBounds().getCenter();
+        BatchKey key{};
+        key.layout = layoutOf(mesh);
+        key.castsShadows = node->castsShadows;
+        key.cellX = static_cast<int>(std::floor(center.x / cellSize));
+        key.cellY = static_cast<int>(std::floor(center.y / cellSize));
+        key.cellZ = static_cast<int>(std::floor(center.z / cellSize));
+
+        // one batch per material slot the mesh actually uses
+        std::vector<bool> used(mesh.materials.size(), false);
+        for (size_t t = 0, count = triangleCount(mesh); t < count; ++t) {
+            int slot = materialSlot(mesh, t);
+            if (slot >= 0 && slot < static_cast<int>(used.size())) used[slot] = true;
+        }
+
+        // slots sharing a material share the batch, the node goes in once
+        auto& keys = nodeBatches[node];
+        for (size_t slot = 0; slot < used.size(); ++slot) {
+            if (!used[slot]) continue;
+            key.material = node->getMaterial(slot).get();
+            if (std::find_if(keys.begin(), keys.end(), [&](const BatchKey& k) { return k.material == key.material; }) != keys.end()) continue;
+            Batch& batch = batches[key];
+            batch.castsShadows = key.castsShadows;
+            batch.sources.push_back(node);
+            batch.dirty = true;
+            keys.push_back(key);
+        }
+        node->staticBatched = !keys.empty();
+        if (keys.empty()) nodeBatches.erase(node);
+    }
+
+    void detach(Node* node) {
+        auto it = nodeBatches.find(node);
+        if (it == nodeBatches.end()) return;
+
+        for (const BatchKey& key : it->second) {
+            auto batch = batches.find(key);
+            if (batch == batches.end()) continue;
+            auto& sources = batch->second.sources;
+            sources.erase(std::remove(sources.begin(), sources.end(), node), sources.end());
+            batch->second.dirty = true;
+        }
+        nodeBatches.erase(it);
+        node->staticBatched = false;
+    }
+
+    void rebuild(const BatchKey& key, Batch& batch) {
+        std::shared_ptr<Material> material;
+        Node* first = batch.sources.front();
+        for (size_t slot = 0; slot < first->mesh->materials.size(); ++slot) {
+            auto candidate = first->getMaterial(slot);
+            if (candidate.get() == key.material) material = candidate;
+        }
+
+        auto merged = makePooled<Mesh, pools::Meshes>(material);
+        auto& mergedUVs = merged->uvSets[Mesh::DEFAULT_UV_SET];
+        std::vector<uint32_t> remap;
+
+        for (Node* node : batch.sources) {
+            const Mesh& mesh = *node->mesh;
+            const glm::mat4& world = node->worldTransform;
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+            // mirrored transforms flip the winding
+            bool flip = glm::determinant(glm::mat3(world)) < 0.0f;
+            const auto* uvs = defaultUVs(mesh);
+
+            // every slot with this material, a mesh can use one material in several slots
+            std::vector<bool> slotMatches(mesh.materials.size(), false);
+            for (size_t i = 0; i < mesh.materials.size(); ++i) {
+                slotMatches[i] = node->getMaterial(i).get() == key.material;
+            }
+
+            // vertices get copied the first time a triangle of this material uses them
+            remap.assign(mesh.positions.size(), UINT32_MAX);
+            auto emit = [&](uint32_t index) {
+                if (remap[index] == UINT32_MAX) {
+                    remap[index] = static_cast<uint32_t>(merged->positions.size());
+                    merged->positions.push_back(glm::vec3(world * glm::vec4(mesh.positions[index], 1.0f)));
+                    if (key.layout & LAYOUT_NORMALS) {
+                        merged->normals.push_back(glm::normalize(normalMatrix * mesh.normals[index]));
+                    }
+                    if (key.layout & LAYOUT_COLORS) merged->colors.push_back(mesh.colors[index]);
+                    if (key.layout & LAYOUT_UVS) mergedUVs.push_back((*uvs)[index]);
+                }
+                merged->indices.push_back(remap[index]);
+            };
+
+            for (size_t t = 0, count = triangleCount(mesh); t < count; ++t) {
+                int slot = materialSlot(mesh, t);
+                if (slot < 0 || slot >= static_cast<int>(slotMatches.size()) || !slotMatches[slot]) continue;
+                uint32_t a, b, c;
+                if (mesh.indices.empty()) {
+                    a = static_cast<uint32_t>(t * 3);
+                    b = a + 1;
+                    c = a + 2;
+                }
+                else {
+                    a = mesh.indices[t * 3];
+                    b = mesh.indices[t * 3 + 1];
+                    c = mesh.indices[t * 3 + 2];
+                }
+                if (a >= remap.size() || b >= remap.size() || c >= remap.size()) continue;
+                if (flip) std::swap(b, c);
+                emit(a);
+                emit(b);
+                emit(c);
+            }
+        }
+
+        if (batch.mesh) batch.mesh->releaseBuffers();
+        batch.mesh = merged;
+        batch.dirty = false;
+        // already on the GL thread and about to draw it, the upload queue would be a frame late
+        merged->setupBuffers();
+        ++rebuildCount;
+    }
+};
@@ -0,0 +1,131 @@
+// stringId.h
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 64 bit FNV-1a
+constexpr uint64_t fnv1a64(std::string_view text) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : text) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// a name reduced to its hash, compares and hashes like an integer.
+// "map1"_sid is done at compile time, StringId(name) hashes at runtime and
+// internString(name) also keeps the text around so it can be printed
+class StringId {
+public:
+    constexpr StringId() = default;
+    constexpr explicit StringId(std::string_view name) : hash(fnv1a64(name)) {}
+
+    static constexpr StringId fromHash(uint64_t value) {
+        StringId id;
+        id.hash = value;
+        return id;
+    }
+
+    // one id for a pair of names without building the concatenated string
+    static constexpr StringId combine(StringId a, StringId b) {
+        return fromHash(a.hash ^ (b.hash + 0x9e3779b97f4a7c15ull + (a.hash << 6) + (a.hash >> 2)));
+    }
+
+    constexpr uint64_t getHash() const { return hash; }
+    constexpr bool isValid() const { return hash != 0; }
+
+    // text if it was interned, "#<hash>" otherwise
+    std::string str() const;
+
+    constexpr bool operator==(const StringId& other) const { return hash == other.hash; }
+    constexpr bool operator!=(const StringId& other) const { return hash != other.hash; }
+    constexpr bool operator<(const StringId& other) const { return hash < other.hash; }
+
+private:
+    uint64_t hash = 0;
+};
+
+constexpr StringId operator""_sid(const char* text, size_t length) {
+    return StringId(std::string_view(text, length));
+}
+
+template<>
+struct std::hash<StringId> {
+    size_t operator()(const StringId& id) const noexcept {
+        return static_cast<size_t>(id.getHash());
+    }
+};
+
+// hash -> text, only for debug output and UI. lookups never need it
+class StringTable {
+private:
+    inline static StringTable* instance;
+
+    std::unordered_map<uint64_t, std::string> names;
+    mutable std::shared_mutex mutex;
+
+    StringTable() = default;
+
+public:
+    static StringTable& getInstance() {
+        if (instance == nullptr) {
+            instance = new StringTable();
+        }
+        return *instance;
+    }
+
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    StringId intern(std::string_view name) {
+        StringId id(name);
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = names.find(id.getHash());
+            if (it != names.end()) {
+                if (it->second != name) {
+                    std::cout << "StringId collision: \"" << name << "\" and \"" << it->second << "\"" << std::endl;
+                }
+                return id;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        names.emplace(id.getHash(), std::string(name));
+        return id;
+    }
+
+    bool lookup(StringId id, std::string& out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = names.find(id.getHash());
+        if (it == names.end()) return false;
+        out = it->second;
+        return true;
+    }
+};
+
+inline StringId internString(std::string_view name) {
+    return StringTable::getInstance().intern(name);
+}
+
+inline std::string StringId::str() const {
+    std::string text;
+    if (StringTable::getInstance().lookup(*this, text)) return text;
+
+    static const char digits[] = "0123456789abcdef";
+    text = "#";
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        text += digits[(hash >> shift) & 0xf];
+    }
+    return text;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const StringId& id) {
+    return os << id.str();
+}
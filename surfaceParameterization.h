@@ -138,7 +138,7 @@ public:
 
 private:
     void generateMesh(const SurfaceParameterization& param, const SurfaceParameters& params) {
-        mesh = std::make_shared<Mesh>();
+        mesh = makePooled<Mesh, pools::Meshes>();
 
         float uStep = (param.getUEnd() - param.getUStart()) / params.uSegments;
         float vStep = (param.getVEnd() - param.getVStart()) / params.vSegments;
@@ -163,7 +163,7 @@ private:
                 if (params.generateUVs) {
                     float uCoord = static_cast<float>(i) / params.uSegments;
                     float vCoord = static_cast<float>(j) / params.vSegments;
-                    mesh->uvSets["map1"].push_back(glm::vec2(uCoord, vCoord));
+                    mesh->uvSets[Mesh::DEFAULT_UV_SET].push_back(glm::vec2(uCoord, vCoord));
                 }
             }
         }
@@ -188,7 +188,7 @@ private:
             }
         }
 
-        mesh->setupBuffers();
+        mesh->markForUpload();
     }
 
 public:
@@ -12,45 +12,58 @@ struct TextureInfo {
     int channels;
     std::string type;
     Material::TextureMap settings;  // Store texture settings with the texture
+    int chunkRefs = 0;              // streamed chunks using it, see AcquireTexture
+    bool pinned = true;             // loaded outside the chunks too, they never free it
 };
 
 class TextureManager {
 private:
     inline static TextureManager* instance;
-    std::unordered_map<std::string, TextureInfo> textureCache;
+    // keyed by hashed path
+    std::unordered_map<StringId, TextureInfo> textureCache;
+
+    static constexpr StringId DEFAULT_WHITE = "default_white"_sid;
+    static constexpr StringId DEFAULT_NORMAL = "default_normal"_sid;
+    static constexpr StringId DEFAULT_BLACK = "default_black"_sid;
+
+    static bool isDefaultTexture(StringId key) {
+        return key == DEFAULT_WHITE || key == DEFAULT_NORMAL || key == DEFAULT_BLACK;
+    }
     std::string lastError;
 
     TextureManager() {
+#ifndef ENGINE_HEADLESS
         CreateDefaultTextures();
+#endif
     }
 
     void CreateDefaultTextures() {
         // White texture (default diffuse)
         GLuint whiteTexture;
         glGenTextures(1, &whiteTexture);
-        glBindTexture(GL_TEXTURE_2D, whiteTexture);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, whiteTexture);
         unsigned char white[] = { 255, 255, 255, 255 };
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
         SetDefaultTextureParams(Material::TextureMap());
-        textureCache["default_white"] = { whiteTexture, 1, 1, 4, "diffuse" };
+        textureCache[DEFAULT_WHITE] = { whiteTexture, 1, 1, 4, "diffuse" };
 
         // Normal map (flat surface)
         GLuint normalTexture;
         glGenTextures(1, &normalTexture);
-        glBindTexture(GL_TEXTURE_2D, normalTexture);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, normalTexture);
         unsigned char normal[] = { 128, 128, 255, 255 };
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, normal);
         SetDefaultTextureParams(Material::TextureMap());
-        textureCache["default_normal"] = { normalTexture, 1, 1, 4, "normal" };
+        textureCache[DEFAULT_NORMAL] = { normalTexture, 1, 1, 4, "normal" };
 
         // Black texture (default specular)
         GLuint blackTexture;
         glGenTextures(1, &blackTexture);
-        glBindTexture(GL_TEXTURE_2D, blackTexture);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, blackTexture);
         unsigned char black[] = { 0, 0, 0, 255 };
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, black);
         SetDefaultTextureParams(Material::TextureMap());
-        textureCache["default_black"] = { blackTexture, 1, 1, 4, "specular" };
+        textureCache[DEFAULT_BLACK] = { blackTexture, 1, 1, 4, "specular" };
     }
 
     void SetDefaultTextureParams(const Material::TextureMap& settings) {
@@ -97,7 +110,7 @@ private:
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAniso);
     }
 
-    void ProcessImageData(unsigned char* data, int width, int height, int channels,
+    static void ProcessImageData(unsigned char* data, int width, int height, int channels,
         const Material::TextureMap& settings) {
         if (!data) return;
 
@@ -112,6 +125,21 @@ private:
         }
     }
 
+    // cached id for path, re-applies sampler settings if they changed
+    bool FindCached(const std::string& path, const Material::TextureMap& settings, GLuint& id) {
+        auto it = textureCache.find(StringId(path));
+        if (it == textureCache.end()) return false;
+
+        // Update settings if they've changed
+        if (memcmp(&it->second.settings, &settings, sizeof(Material::TextureMap)) != 0) {
+            GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, it->second.id);
+            SetDefaultTextureParams(settings);
+            it->second.settings = settings;
+        }
+        id = it->second.id;
+        return true;
+    }
+
 public:
     static TextureManager& getInstance() {
         if (instance == nullptr) {
@@ -122,9 +150,14 @@ public:
 
     GLuint LoadFromMemory(unsigned char* data, size_t size, const char* formatHint,
         const Material::TextureMap& settings = Material::TextureMap()) {
+#ifdef ENGINE_HEADLESS
+        // no GL context, materials keep the id but nothing samples it
+        (void)data; (void)size; (void)formatHint; (void)settings;
+        return 0;
+#else
         GLuint textureID;
         glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureID);
 
         int width, height, channels;
         unsigned char* imageData = nullptr;
@@ -169,48 +202,83 @@ public:
         stbi_image_free(imageData);
 
         // Cache texture info
-        std::string cacheKey = "embedded_" + std::to_string(size);
+        StringId cacheKey = StringId::combine("embedded"_sid, StringId::fromHash(size));
         textureCache[cacheKey] = { textureID, width, height, channels, "embedded", settings };
 
         return textureID;
+#endif
+    }
+
+    // file read + stb decode, the part of LoadTexture that doesn't need GL. safe on a loader
+    // thread, pass the result to UploadTexture on the GL thread (which frees it)
+    struct DecodedImage {
+        std::string path;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        unsigned char* data = nullptr;
+    };
+
+    static DecodedImage DecodeImage(const std::string& path, const Material::TextureMap& settings = Material::TextureMap()) {
+        DecodedImage image;
+        image.path = path;
+        if (!std::filesystem::exists(path)) return image;
+
+        stbi_set_flip_vertically_on_load_thread(true);
+        image.data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+        ProcessImageData(image.data, image.width, image.height, image.channels, settings);
+        return image;
     }
 
     GLuint LoadTexture(const std::string& path, const std::string& type = "diffuse",
         const Material::TextureMap& settings = Material::TextureMap()) {
-        // Return cached if exists
-        auto it = textureCache.find(path);
-        if (it != textureCache.end()) {
-            // Update settings if they've changed
-            if (memcmp(&it->second.settings, &settings, sizeof(Material::TextureMap)) != 0) {
-                glBindTexture(GL_TEXTURE_2D, it->second.id);
-                SetDefaultTextureParams(settings);
-                it->second.settings = settings;
-            }
-            return it->second.id;
+        GLuint cached;
+        if (FindCached(path, settings, cached)) {
+            textureCache[StringId(path)].pinned = true;
+            return cached;
         }
 
-        // Check file exists
-        if (!std::filesystem::exists(path)) {
-            std::cout << "Texture not found: " << path << std::endl;
-            return GetDefaultTexture(type);
-        }
+        DecodedImage image = DecodeImage(path, settings);
+        return UploadTexture(image, type, settings);
+    }
 
-        // Load texture data
-        int width, height, channels;
-        stbi_set_flip_vertically_on_load(true);
-        unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+    // GL half of LoadTexture. takes ownership of image.data
+    GLuint UploadTexture(DecodedImage& image, const std::string& type = "diffuse",
+        const Material::TextureMap& settings = Material::TextureMap()) {
+        // someone else may have loaded the same file since it was decoded
+        GLuint cached;
+        if (FindCached(image.path, settings, cached)) {
+            if (image.data) stbi_image_free(image.data);
+            image.data = nullptr;
+            textureCache[StringId(image.path)].pinned = true;
+            return cached;
+        }
 
-        if (!data) {
-            lastError = "Failed to load texture: " + path;
+#ifdef ENGINE_HEADLESS
+        (void)type;
+        if (image.data) stbi_image_free(image.data);
+        image.data = nullptr;
+        return 0;
+#else
+        if (!image.data) {
+            if (!std::filesystem::exists(image.path)) {
+                std::cout << "Texture not found: " << image.path << std::endl;
+            }
+            else {
+                lastError = "Failed to load texture: " + image.path;
+            }
             return GetDefaultTexture(type);
         }
 
-        ProcessImageData(data, width, height, channels, settings);
+        int width = image.width;
+        int height = image.height;
+        int channels = image.channels;
+        unsigned char* data = image.data;
 
         // Create OpenGL texture
         GLuint textureID;
         glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureID);
 
         // Determine format based on color space and channels
         GLenum format, internalFormat;
@@ -251,17 +319,19 @@ public:
         SetDefaultTextureParams(settings);
 
         // Cache texture
-        textureCache[path] = { textureID, width, height, channels, type, settings };
+        textureCache[internString(image.path)] = { textureID, width, height, channels, type, settings };
 
         stbi_image_free(data);
+        image.data = nullptr;
 
         //DebugTextureState(textureID);
 
         return textureID;
+#endif
     }
 
     void DebugTextureState(GLuint textureID) {
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, textureID);
 
         GLint wrap_s, wrap_t, min_filter, mag_filter;
         glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, &wrap_s);
@@ -284,50 +354,94 @@ public:
     }
 
     GLuint GetDefaultTexture(const std::string& type = "diffuse") {
-        if (type == "normal") return textureCache["default_normal"].id;
-        if (type == "specular") return textureCache["default_black"].id;
-        return textureCache["default_white"].id;
+        if (type == "normal") return textureCache[DEFAULT_NORMAL].id;
+        if (type == "specular") return textureCache[DEFAULT_BLACK].id;
+        return textureCache[DEFAULT_WHITE].id;
     }
 
     const TextureInfo& GetTextureInfo(const std::string& path) {
-        auto it = textureCache.find(path);
+        auto it = textureCache.find(StringId(path));
         if (it != textureCache.end()) {
             return it->second;
         }
-        return textureCache["default_white"];
+        return textureCache[DEFAULT_WHITE];
+    }
+
+    // file a texture was loaded from, empty for defaults and embedded textures
+    std::string GetTexturePath(GLuint textureId) const {
+        for (const auto& [key, info] : textureCache) {
+            if (info.id == textureId && !isDefaultTexture(key) && info.type != "embedded") {
+                return key.str();
+            }
+        }
+        return "";
+    }
+
+    // UploadTexture for streamed chunks: every call holds a reference until ReleaseTexture
+    GLuint AcquireTexture(DecodedImage& image, const std::string& type = "diffuse",
+        const Material::TextureMap& settings = Material::TextureMap()) {
+        GLuint id;
+        bool loaded = FindCached(image.path, settings, id);
+        if (loaded) {
+            if (image.data) stbi_image_free(image.data);
+            image.data = nullptr;
+        }
+        else {
+            id = UploadTexture(image, type, settings);
+        }
+
+        // nothing cached when the file was missing, that's the default texture
+        auto it = textureCache.find(StringId(image.path));
+        if (it == textureCache.end()) return id;
+        if (!loaded) it->second.pinned = false;
+        ++it->second.chunkRefs;
+        return id;
+    }
+
+    // the last chunk to let go deletes the texture, unless LoadTexture handed it out too
+    void ReleaseTexture(const std::string& path) {
+        StringId key(path);
+        auto it = textureCache.find(key);
+        if (it == textureCache.end() || isDefaultTexture(key) || it->second.chunkRefs == 0) return;
+
+        if (--it->second.chunkRefs == 0 && !it->second.pinned) {
+            GLStateCache::getInstance().deleteTextures(1, &it->second.id);
+            textureCache.erase(it);
+        }
     }
 
     void UnloadTexture(const std::string& path) {
-        auto it = textureCache.find(path);
-        if (it != textureCache.end() && !path.starts_with("default_")) {
-            glDeleteTextures(1, &it->second.id);
+        StringId key(path);
+        auto it = textureCache.find(key);
+        if (it != textureCache.end() && !isDefaultTexture(key)) {
+            GLStateCache::getInstance().deleteTextures(1, &it->second.id);
             textureCache.erase(it);
         }
     }
 
     void UnloadAll() {
-        for (const auto& [path, info] : textureCache) {
-            if (!path.starts_with("default_")) {
-                glDeleteTextures(1, &info.id);
+        for (const auto& [key, info] : textureCache) {
+            if (!isDefaultTexture(key)) {
+                GLStateCache::getInstance().deleteTextures(1, &info.id);
             }
         }
         auto defaults = {
-            textureCache["default_white"],
-            textureCache["default_normal"],
-            textureCache["default_black"]
+            textureCache[DEFAULT_WHITE],
+            textureCache[DEFAULT_NORMAL],
+            textureCache[DEFAULT_BLACK]
         };
         textureCache.clear();
-        textureCache["default_white"] = defaults.begin()[0];
-        textureCache["default_normal"] = defaults.begin()[1];
-        textureCache["default_black"] = defaults.begin()[2];
+        textureCache[DEFAULT_WHITE] = defaults.begin()[0];
+        textureCache[DEFAULT_NORMAL] = defaults.begin()[1];
+        textureCache[DEFAULT_BLACK] = defaults.begin()[2];
     }
 
     const std::string& GetLastError() const { return lastError; }
 
     ~TextureManager() {
         UnloadAll();
-        for (const auto& [path, info] : textureCache) {
-            glDeleteTextures(1, &info.id);
+        for (const auto& [key, info] : textureCache) {
+            GLStateCache::getInstance().deleteTextures(1, &info.id);
         }
     }
 };
\ No newline at end of file
@@ -0,0 +1,314 @@
+// transformHierarchy.h
+#pragma once
+#include "GameEngine.h"
+#include "object3D.h"
+#include "jobSystem.h"
+#include "simd.h"
+
+// flat, depth sorted copy of the scene graph. parents always sit before their children,
+// so a single front to back pass pushes dirty flags down the tree and every depth level
+// can be computed in parallel (whatever a level reads is finished by the level above).
+// TRS stays on the Node where everything writes it, the dirty ones get gathered into
+// 4-wide SoA lanes and turned into matrices with SSE. world matrices live in one flat array
+class TransformHierarchy {
+public:
+    // below this many dirty nodes in a level it runs on the calling thread
+    size_t minParallelBatch = 256;
+
+    TransformHierarchy() = default;
+    // nodes point at our dirty array, so we can't move
+    TransformHierarchy(const TransformHierarchy&) = delete;
+    TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+    // only registers the node itself, Scene::addNode walks the children
+    void add(const std::shared_ptr<Node>& node) {
+        if (!node || node->transformDirtyFlags) return;
+        node->transformDirtyFlags = &dirty;
+        node->transformIndex = -1;
+        registered.push_back(node);
+        structureDirty = true;
+    }
+
+    void remove(const std::shared_ptr<Node>& node) {
+        if (!node || node->transformDirtyFlags != &dirty) return;
+        node->transformDirtyFlags = nullptr;
+        node->transformIndex = -1;
+        // the entry in registered goes away on the next rebuild
+        structureDirty = true;
+    }
+
+    // a registered node got a new parent, depth order has to be redone
+    void markStructureDirty() {
+        structureDirty = true;
+    }
+
+    void clear() {
+        for (auto& node : registered) {
+            if (node->transformDirtyFlags == &dirty) {
+                node->transformDirtyFlags = nullptr;
+                node->transformIndex = -1;
+            }
+        }
+        registered.clear();
+        structureDirty = true;
+    }
+
+    // recomputes every dirty world matrix, returns how many changed
+    size_t update() {
+        if (structureDirty) {
+            rebuild();
+        }
+
+        changed.clear();
+        dirtyList.clear();
+        const size_t count = nodes.size();
+
+        // parents come first, so one pass is enough to dirty whole subtrees
+        for (size_t i = 0; i < count; ++i) {
+            int32_t p = parentIndex[i];
+            if (p == EXTERNAL_PARENT || (p >= 0 && dirty[p])) {
+                dirty[i] = 1;
+            }
+        }
+
+        // dirty indices grouped by level, same order as the array
+        for (size_t level = 0; level + 1 < levelStart.size(); ++level) {
+            dirtyLevelStart[level] = static_cast<uint32_t>(dirtyList.size());
+            for (uint32_t i = levelStart[level]; i < levelStart[level + 1]; ++i) {
+                if (dirty[i]) dirtyList.push_back(i);
+            }
+        }
+        dirtyLevelStart.back() = static_cast<uint32_t>(dirtyList.size());
+        if (dirtyList.empty()) return 0;
+
+        JobSystem& jobs = JobSystem::getInstance();
+        for (size_t level = 0; level + 1 < dirtyLevelStart.size(); ++level) {
+            const uint32_t begin = dirtyLevelStart[level];
+            const uint32_t levelCount = dirtyLevelStart[level + 1] - begin;
+            if (levelCount == 0) continue;
+
+            const uint32_t* indices = dirtyList.data() + begin;
+            size_t blockCount = (levelCount + 3) / 4;
+            jobs.parallelFor(blockCount, std::max<size_t>(minParallelBatch / 4, 1), [&](size_t b, size_t e) {
+                for (size_t block = b; block < e; ++block) {
+                    size_t first = block * 4;
+                    computeBlock(indices + first, std::min<size_t>(4, levelCount - first));
+                }
+            });
+        }
+
+        for (uint32_t i : dirtyList) {
+            dirty[i] = 0;
+            changed.push_back(nodes[i]);
+        }
+        return changed.size();
+    }
+
+    // nodes whose world matrix was rewritten by the last update()
+    const std::vector<Node*>& getChangedNodes() const { return changed; }
+
+    size_t size() const { return registered.size(); }
+    size_t getLevelCount() const { return levelStart.empty() ? 0 : levelStart.size() - 1; }
+
+private:
+    static constexpr int32_t NO_PARENT = -1;
+    static constexpr int32_t EXTERNAL_PARENT = -2;  // parent isn't registered, read its matrix directly
+    static constexpr int32_t VISITED = -3;
+
+    // keeps registered nodes alive until they've been dropped from the arrays
+    std::vector<std::shared_ptr<Node>> registered;
+    bool structureDirty = false;
+
+    // depth sorted, all indexed the same way
+    std::vector<Node*> nodes;
+    std::vector<int32_t> parentIndex;
+    std::vector<uint8_t> dirty;
+    AlignedVector<glm::mat4> world;
+
+    std::vector<uint32_t> levelStart;       // first index of each depth level, plus the end
+    std::vector<uint32_t> dirtyLevelStart;  // same thing for dirtyList
+    std::vector<uint32_t> dirtyList;
+    std::vector<Node*> changed;
+
+    void rebuild() {
+        // drop removed nodes and anything registered twice
+        std::vector<std::shared_ptr<Node>> live;
+        live.reserve(registered.size());
+        for (auto& node : registered) {
+            if (node->transformDirtyFlags != &dirty || node->transformIndex == VISITED) continue;
+            node->transformIndex = VISITED;
+            live.push_back(std::move(node));
+        }
+        registered = std::move(live);
+
+        std::vector<std::pair<uint32_t, uint32_t>> order; // depth, index into registered
+        order.reserve(registered.size());
+        uint32_t maxDepth = 0;
+        for (uint32_t i = 0; i < registered.size(); ++i) {
+            uint32_t depth = 0;
+            for (Node* p = registered[i]->parent; p && p->transformDirtyFlags == &dirty; p = p->parent) {
+                ++depth;
+            }
+            maxDepth = std::max(maxDepth, depth);
+            order.push_back({ depth, i });
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        const size_t count = order.size();
+        nodes.resize(count);
+        parentIndex.resize(count);
+        world.resize(count);
+        dirty.assign(count, 1);
+        levelStart.assign(count ? maxDepth + 2 : 1, 0);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            Node* node = registered[order[i].second].get();
+            node->transformIndex = static_cast<int32_t>(i);
+            nodes[i] = node;
+
+            // parent sits on an earlier level, so its index is already set
+            if (!node->parent) {
+                parentIndex[i] = NO_PARENT;
+            }
+            else if (node->parent->transformDirtyFlags == &dirty) {
+                parentIndex[i] = node->parent->transformIndex;
+            }
+            else {
+                parentIndex[i] = EXTERNAL_PARENT;
+            }
+            ++levelStart[order[i].first + 1];
+        }
+        for (size_t level = 1; level < levelStart.size(); ++level) {
+            levelStart[level] += levelStart[level - 1];
+        }
+        dirtyLevelStart.assign(levelStart.size(), 0);
+
+        structureDirty = false;
+    }
+
+    // up to 4 nodes from the same level
+    void computeBlock(const uint32_t* indices, size_t laneCount) {
+        alignas(16) float tx[4], ty[4], tz[4];
+        alignas(16) float qx[4], qy[4], qz[4], qw[4];
+        alignas(16) float sx[4], sy[4], sz[4];
+
+        for (size_t lane = 0; lane < 4; ++lane) {
+            if (lane < laneCount) {
+                const Node* node = nodes[indices[lane]];
+                tx[lane] = node->localTranslation.x;
+                ty[lane] = node->localTranslation.y;
+                tz[lane] = node->localTranslation.z;
+                qx[lane] = node->localRotation.x;
+                qy[lane] = node->localRotation.y;
+                qz[lane] = node->localRotation.z;
+                qw[lane] = node->localRotation.w;
+                sx[lane] = node->localScale.x;
+                sy[lane] = node->localScale.y;
+                sz[lane] = node->localScale.z;
+            }
+            else {
+                tx[lane] = ty[lane] = tz[lane] = 0.0f;
+                qx[lane] = qy[lane] = qz[lane] = 0.0f;
+                qw[lane] = 1.0f;
+                sx[lane] = sy[lane] = sz[lane] = 1.0f;
+            }
+        }
+
+        // local = T * R * S as 3 scaled rotation columns + translation, one row per lane
+        alignas(16) float local[12][4];
+        composeLocal(tx, ty, tz, qx, qy, qz, qw, sx, sy, sz, local);
+
+        for (size_t lane = 0; lane < laneCount; ++lane) {
+            uint32_t i = indices[lane];
+            int32_t p = parentIndex[i];
+            const glm::mat4* parentWorld = p >= 0 ? &world[p]
+                : p == EXTERNAL_PARENT ? &nodes[i]->parent->worldTransform
+                : nullptr;
+
+            glm::mat4& out = world[i];
+            multiplyAffine(parentWorld, local, lane, out);
+            nodes[i]->worldTransform = out;
+        }
+    }
+
+    static void composeLocal(const float* tx, const float* ty, const float* tz,
+        const float* qx, const float* qy, const float* qz, const float* qw,
+        const float* sx, const float* sy, const float* sz, float (*local)[4]) {
+#ifdef ENGINE_SIMD_SSE
+        __m128 x = _mm_load_ps(qx), y = _mm_load_ps(qy), z = _mm_load_ps(qz), w = _mm_load_ps(qw);
+        __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+
+        __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+        __m128 scaleX = _mm_load_ps(sx), scaleY = _mm_load_ps(sy), scaleZ = _mm_load_ps(sz);
+
+        // same terms as glm::mat4_cast
+        _mm_store_ps(local[0], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scaleX));
+        _mm_store_ps(local[1], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), scaleX));
+        _mm_store_ps(local[2], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), scaleX));
+
+        _mm_store_ps(local[3], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), scaleY));
+        _mm_store_ps(local[4], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scaleY));
+        _mm_store_ps(local[5], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), scaleY));
+
+        _mm_store_ps(local[6], _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), scaleZ));
+        _mm_store_ps(local[7], _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), scaleZ));
+        _mm_store_ps(local[8], _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scaleZ));
+
+        _mm_store_ps(local[9], _mm_load_ps(tx));
+        _mm_store_ps(local[10], _mm_load_ps(ty));
+        _mm_store_ps(local[11], _mm_load_ps(tz));
+#else
+        for (size_t lane = 0; lane < 4; ++lane) {
+            float x = qx[lane], y = qy[lane], z = qz[lane], w = qw[lane];
+            local[0][lane] = (1.0f - 2.0f * (y * y + z * z)) * sx[lane];
+            local[1][lane] = 2.0f * (x * y + w * z) * sx[lane];
+            local[2][lane] = 2.0f * (x * z - w * y) * sx[lane];
+            local[3][lane] = 2.0f * (x * y - w * z) * sy[lane];
+            local[4][lane] = (1.0f - 2.0f * (x * x + z * z)) * sy[lane];
+            local[5][lane] = 2.0f * (y * z + w * x) * sy[lane];
+            local[6][lane] = 2.0f * (x * z + w * y) * sz[lane];
+            local[7][lane] = 2.0f * (y * z - w * x) * sz[lane];
+            local[8][lane] = (1.0f - 2.0f * (x * x + y * y)) * sz[lane];
+            local[9][lane] = tx[lane];
+            local[10][lane] = ty[lane];
+            local[11][lane] = tz[lane];
+        }
+#endif
+    }
+
+    // out = parent * local, local's last row is always (0, 0, 0, 1)
+    static void multiplyAffine(const glm::mat4* parent, const float (*local)[4], size_t lane, glm::mat4& out) {
+        if (!parent) {
+            out = glm::mat4(
+                local[0][lane], local[1][lane], local[2][lane], 0.0f,
+                local[3][lane], local[4][lane], local[5][lane], 0.0f,
+                local[6][lane], local[7][lane], local[8][lane], 0.0f,
+                local[9][lane], local[10][lane], local[11][lane], 1.0f);
+            return;
+        }
+#ifdef ENGINE_SIMD_SSE
+        const float* p = &(*parent)[0][0];
+        __m128 p0 = _mm_loadu_ps(p), p1 = _mm_loadu_ps(p + 4), p2 = _mm_loadu_ps(p + 8), p3 = _mm_loadu_ps(p + 12);
+        float* o = &out[0][0];
+        for (int column = 0; column < 4; ++column) {
+            __m128 r = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(local[column * 3][lane])),
+                    _mm_mul_ps(p1, _mm_set1_ps(local[column * 3 + 1][lane]))),
+                _mm_mul_ps(p2, _mm_set1_ps(local[column * 3 + 2][lane])));
+            if (column == 3) r = _mm_add_ps(r, p3);
+            _mm_storeu_ps(o + column * 4, r);
+        }
+#else
+        for (int column = 0; column < 4; ++column) {
+            glm::vec4 r = (*parent)[0] * local[column * 3][lane]
+                + (*parent)[1] * local[column * 3 + 1][lane]
+                + (*parent)[2] * local[column * 3 + 2][lane];
+            out[column] = column == 3 ? r + (*parent)[3] : r;
+        }
+#endif
+    }
+};
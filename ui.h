@@ -8,18 +8,16 @@
 #include "scene.h"
 #include "fileDialog.h"
 #include "modelImporter.h"
+#include "sceneFile.h"
+#include "worldStreamer.h"
+#include "paths.h"
 #include "ImGuiFileDialog.h"
 
 
 
  // Helper function to find PhysXBody for a node
  inline std::shared_ptr<PhysXBody> findPhysicsBody(Scene& scene, std::shared_ptr<Node> node) {
-     for (const auto& body : scene.physicsWorld.bodies) {
-         if (body->node == node) {
-             return body;
-         }
-     }
-     return nullptr;
+     return scene.physicsWorld.findBody(node.get());
  }
 
 // Function and variable declarations
@@ -30,6 +28,7 @@ void cleanupImGui();
 // forward declerations
 // class Scene;
 extern Scene scene; // Declare the external scene variable that appears in GameEngine.cpp
+extern WorldStreamer worldStreamer;
 
 
 class MenuSystem {
@@ -149,16 +148,8 @@ public:
                         ImGui::SameLine();
                         ImGui::BeginDisabled(selectedNode == nullptr);
                         if (ImGui::Button("Delete Object", ImVec2(120, 25))) {
-                            // Remove from physics world if it has physics
-                            auto physBody = findPhysicsBody(scene, selectedNode);
-                            if (physBody) {
-                                auto& bodies = scene.physicsWorld.bodies;
-                                bodies.erase(std::remove(bodies.begin(), bodies.end(), physBody), bodies.end());
-                            }
-
-                            // Remove from scene nodes
-                            auto& nodes = scene.sceneNodes;
-                            nodes.erase(std::remove(nodes.begin(), nodes.end(), selectedNode), nodes.end());
+                            // node, body and its collision (merged statics only lose their own shapes)
+                            scene.deleteNode(selectedNode, selectedNode->name);
 
                             selectedNode = nullptr;
                         }
@@ -233,14 +224,14 @@ public:
                                     std::shared_ptr<Node> newNode;
                                     switch (selectedType) {
                                     case 0:
-                                        newNode = std::make_shared<SphereNode>(sphereRadius);
+                                        newNode = makePooled<SphereNode, pools::Primitives>(sphereRadius);
                                         break;
                                     case 1:
-                                        newNode = std::make_shared<BoxNode>(
+                                        newNode = makePooled<BoxNode, pools::Primitives>(
                                             boxDimensions[0], boxDimensions[1], boxDimensions[2]);
                                         break;
                                     case 2:
-                                        newNode = std::make_shared<CylinderNode>(
+                                        newNode = makePooled<CylinderNode, pools::Primitives>(
                                             cylinderRadius, cylinderHeight);
                                         break;
                                     }
@@ -248,7 +239,7 @@ public:
                                     newNode->setWorldPosition(position);
 
                                     if (isDynamic) {
-                                        auto physBody = std::make_shared<PhysXBody>(newNode, false);
+                                        auto physBody = makePooled<PhysXBody, pools::Bodies>(newNode, false);
                                         scene.addPhysicsBody(physBody);
                                     }
                                     else {
@@ -356,6 +347,17 @@ public:
                                     selectedNode->localScale.y,
                                     selectedNode->localScale.z);
                                 ImGui::Unindent();
+
+                                if (ImGui::Checkbox("Static (batched)", &selectedNode->isStatic)) {
+                                    scene.markStaticEdited(selectedNode.get());
+                                }
+                                if (ImGui::Checkbox("Impostor when far", &selectedNode->impostor)) {
+                                    scene.impostors.prepare(selectedNode.get());
+                                }
+                                // picked up by the occlusion culler next frame
+                                if (ImGui::Checkbox("Occluder", &selectedNode->occluder)) {
+                                    RedrawTracker::getInstance().markDirty();
+                                }
                             }
 
                             if (selectedNode->mesh && ImGui::CollapsingHeader("Materials", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -366,14 +368,15 @@ public:
                                     ImGui::TableHeadersRow();
 
                                     for (size_t i = 0; i < selectedNode->mesh->materials.size(); i++) {
-                                        auto& material = selectedNode->mesh->materials[i];
+                                        auto material = selectedNode->getMaterial(i);
                                         ImGui::TableNextRow();
                                         ImGui::TableNextColumn();
 
                                         char label[32];
                                         sprintf(label, "%zu", i);
                                         if (ImGui::Selectable(label, selectedMaterial == material, ImGuiSelectableFlags_SpanAllColumns)) {
-                                            selectedMaterial = material;
+                                            // cached primitive meshes are shared, edit a copy owned by this node
+                                            selectedMaterial = i == 0 && selectedNode->mesh->shared ? selectedNode->ownMaterial() : material;
                                         }
 
                                         ImGui::TableNextColumn();
@@ -442,7 +445,7 @@ public:
                                             ImGui::TableNextRow();
 
                                             ImGui::TableNextColumn();
-                                            ImGui::Text("%s", mapType.c_str());
+                                            ImGui::Text("%s", mapType.str().c_str());
 
                                             ImGui::TableNextColumn();
                                             ImGui::Text("%u", textureMap.textureId);
@@ -647,9 +650,65 @@ public:
 
                     ImGui::SameLine();
                     if (ImGui::Button("Reset", ImVec2(120, 30))) {
-                        // Add your reset logic here
+                        scene.restorePhysicsSnapshot();
                     }
 
+                    ImGui::SameLine();
+                    if (ImGui::Button("Save Snapshot", ImVec2(120, 30))) {
+                        scene.capturePhysicsSnapshot();
+                    }
+                    ImGui::Text("Snapshot: %zu bodies, %.1f KB", scene.physicsSnapshot.getEntries().size(),
+                        scene.physicsSnapshot.getSizeBytes() / 1024.0f);
+
+                    ImGui::Separator();
+                    if (ImGui::Button("Save Scene", ImVec2(120, 30))) {
+                        SceneWriter::save(scene, Paths::Scenes::defaultScene);
+                    }
+                    ImGui::SameLine();
+                    if (ImGui::Button("Load Scene", ImVec2(120, 30))) {
+                        // the file has the default lights too, replace rather than add.
+                        // decoded first so a missing file leaves the scene alone
+                        SceneChunk chunk;
+                        if (SceneLoader::decode(Paths::Scenes::defaultScene, chunk)) {
+                            // streamed cells come back on the streamer's next update
+                            worldStreamer.unloadAll(scene);
+                            scene.clear();
+                            SceneLoader::instantiate(scene, chunk);
+                        }
+                    }
+
+                    ImGui::Separator();
+                    static float explosionRadius = 5.0f;
+                    static float explosionImpulse = 10.0f;
+                    ImGui::DragFloat("Explosion Radius", &explosionRadius, 0.1f, 0.1f, 100.0f);
+                    ImGui::DragFloat("Explosion Impulse", &explosionImpulse, 0.5f, 0.0f, 1000.0f);
+                    if (ImGui::Button("Explode At Origin", ImVec2(160, 25))) {
+                        scene.forceFields.explode(glm::vec3(0.0f), explosionRadius, explosionImpulse);
+                    }
+                    ImGui::Text("Active force fields: %zu", scene.forceFields.getFieldCount());
+
+                    // particle stress test, sparks bouncing off the top of the default ground box
+                    static std::shared_ptr<ParticleEmitter> sparkFountain;
+                    bool sparksOn = sparkFountain != nullptr;
+                    if (ImGui::Checkbox("Spark fountain demo", &sparksOn)) {
+                        if (sparksOn) {
+                            ParticleEmitterSettings sparkSettings;
+                            sparkSettings.position = glm::vec3(-3.0f, -1.0f, -3.0f);
+                            sparkSettings.emissionRate = 5000.0f;
+                            sparkSettings.maxParticles = 20000;
+                            sparkSettings.minSpeed = 3.0f;
+                            sparkSettings.maxSpeed = 6.0f;
+                            sparkSettings.collisionMode = ParticleCollisionMode::Plane;
+                            sparkSettings.planeOffset = -1.25f;
+                            sparkFountain = scene.particleSystem.addEmitter(sparkSettings);
+                        }
+                        else {
+                            scene.particleSystem.removeEmitter(sparkFountain);
+                            sparkFountain = nullptr;
+                        }
+                    }
+                    ImGui::Separator();
+
                     static float gravity = -9.81f;
                     ImGui::DragFloat("Gravity", &gravity, 0.1f, -20.0f, 20.0f);
 
@@ -669,6 +728,106 @@ public:
                     extern float deltaTime_sys;
 
                     ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Delta Time: %.3f", deltaTime_sys);
+                    ImGui::Text("Particles: %zu (%zu emitters)", scene.particleSystem.getParticleCount(), scene.particleSystem.emitters.size());
+                    ImGui::Text("Entities: %zu, %zu mirroring the scene's %zu nodes", scene.entities.size(),
+                        scene.nodeEntities.getLinkedCount(), scene.sceneNodes.size());
+
+                    ImGui::Checkbox("Frustum culling", &scene.frustumCulling);
+                    ImGui::Text("Nodes drawn: %zu, culled: %zu (tree height %d)", scene.drawnNodeCount,
+                        scene.culledNodeCount, scene.cullingTree.getHeight());
+                    ImGui::Checkbox("Occlusion culling", &scene.occlusionCulling);
+                    ImGui::Text("Occluded: %zu (%zu occluders, %zu triangles)", scene.occludedNodeCount,
+                        scene.occlusionCuller.getOccluderCount(), scene.occlusionCuller.getTriangleCount());
+                    const InstancedRenderer& instances = scene.shadowRenderer.instances;
+                    ImGui::Text("Instanced draws: %zu (%zu instances), single draws: %zu", instances.getInstancedDraws(),
+                        instances.getInstanceCount(), instances.getSingleDraws());
+                    const GLStateCache& glState = GLStateCache::getInstance();
+                    ImGui::Text("GL state calls: %zu issued, %zu skipped", glState.getIssuedCount(), glState.getSkippedCount());
+                    const MaterialTable& materialTable = MaterialTable::getInstance();
+                    ImGui::Text("Material table: %zu entries in %zu pages, %zu uploads", materialTable.getEntryCount(),
+                        materialTable.getPageCount(), materialTable.getUploadCount());
+                    ImGui::Checkbox("Static batching", &scene.staticBatching);
+                    ImGui::Text("Static batches: %zu from %zu nodes (%zu rebuilds)", scene.staticBatches.getBatchCount(),
+                        scene.staticBatches.getBatchedNodeCount(), scene.staticBatches.getRebuildCount());
+                    ImGui::Checkbox("Impostors", &scene.impostors.enabled);
+                    ImGui::SliderFloat("Impostor screen size", &scene.impostors.screenSizeThreshold, 0.0f, 0.2f);
+                    ImGui::Text("Impostors: %zu (%zu atlases, %zu waiting)", scene.impostors.getImpostorCount(),
+                        scene.impostors.getAtlasCount(), scene.impostors.getPendingCount());
+                    if (ImGui::Button("Rebake impostors")) {
+                        scene.impostors.invalidateAll();
+                    }
+                    ImGui::Checkbox("Mesh LODs", &scene.meshLods.enabled);
+                    ImGui::SliderFloat("LOD hysteresis", &scene.meshLods.hysteresis, 0.0f, 0.5f);
+                    ImGui::Text("Mesh LODs: %zu meshes simplified, %zu pending", scene.meshLods.getGeneratedCount(),
+                        scene.meshLods.getPendingCount());
+                    PrimitiveMeshCache& meshCache = PrimitiveMeshCache::getInstance();
+                    ImGui::Text("Primitive mesh cache: %zu meshes (%.1f KB)", meshCache.size(), meshCache.getMemoryBytes() / 1024.0f);
+
+                    RedrawTracker& redraw = RedrawTracker::getInstance();
+                    ImGui::Checkbox("Render on demand", &redraw.enabled);
+                    ImGui::Text("Frames drawn: %zu, skipped: %zu", redraw.getRenderedFrames(), redraw.getSkippedFrames());
+
+                    FrameArena& arena = FrameArena::getInstance();
+                    ImGui::Text("Frame arena: %.1f / %.1f KB (peak %.1f KB), %zu allocations", arena.getUsedBytes() / 1024.0f,
+                        arena.getCapacity() / 1024.0f, arena.getPeakBytes() / 1024.0f, arena.getAllocationCount());
+
+                    if (ImGui::CollapsingHeader("Object Pools")) {
+                        if (ImGui::BeginTable("ObjectPools", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                            ImGui::TableSetupColumn("Type");
+                            ImGui::TableSetupColumn("Slot");
+                            ImGui::TableSetupColumn("In use");
+                            ImGui::TableSetupColumn("Peak");
+                            ImGui::TableSetupColumn("Capacity");
+                            ImGui::TableHeadersRow();
+                            for (const auto& pool : PoolRegistry::getInstance().getStats()) {
+                                ImGui::TableNextRow();
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%s", pool.category);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%zu B", pool.slotSize);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%zu", pool.slotsInUse);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%zu", pool.peakInUse);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%zu (%.0f%%)", pool.slotsTotal,
+                                    pool.slotsTotal ? 100.0f * pool.slotsInUse / pool.slotsTotal : 0.0f);
+                            }
+                            ImGui::EndTable();
+                        }
+                    }
+
+                    if (ImGui::CollapsingHeader("Physics Memory")) {
+                        PhysXPoolAllocator& pxAllocator = PhysXManager::getInstance().getAllocator();
+                        ImGui::Text("In use: %.2f KB", pxAllocator.getTotalBytes() / 1024.0f);
+                        ImGui::Text("Pool reserved: %.2f KB", pxAllocator.getReservedPoolBytes() / 1024.0f);
+                        ImGui::Text("Simulate scratch: %u KB", PhysXManager::getInstance().getScratchBlockSize() / 1024);
+
+                        auto categories = pxAllocator.getCategoryStats();
+                        std::sort(categories.begin(), categories.end(),
+                            [](const auto& a, const auto& b) { return a.currentBytes > b.currentBytes; });
+
+                        if (ImGui::BeginTable("PhysXCategories", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                            ImGui::TableSetupColumn("Type");
+                            ImGui::TableSetupColumn("KB");
+                            ImGui::TableSetupColumn("Peak KB");
+                            ImGui::TableSetupColumn("Live");
+                            ImGui::TableHeadersRow();
+                            for (const auto& category : categories) {
+                                if (category.totalAllocations == 0) continue;
+                                ImGui::TableNextRow();
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%s", category.name.c_str());
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%.1f", category.currentBytes / 1024.0f);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%.1f", category.peakBytes / 1024.0f);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%zu", category.liveAllocations);
+                            }
+                            ImGui::EndTable();
+                        }
+                    }
 
                     ImGui::EndChild();
                     ImGui::EndTabItem();
@@ -682,6 +841,12 @@ public:
         }
         ImGui::End();
 
+        // dragging a slider or typing edits materials/lights after the scene was drawn,
+        // keep drawing until the widget is let go
+        if (ImGui::IsAnyItemActive()) {
+            RedrawTracker::getInstance().markDirty();
+        }
+
         // Pop styles and font
         ImGui::PopFont();
         ImGui::PopStyleColor(2); // Pop window background and text colors
@@ -0,0 +1,241 @@
+// worldStreamer.h
+#pragma once
+#include "sceneFile.h"
+#include "jobSystem.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+// grid position of a streaming cell on the xz plane
+struct CellCoord {
+    int x = 0;
+    int z = 0;
+
+    bool operator==(const CellCoord& other) const { return x == other.x && z == other.z; }
+};
+
+template<>
+struct std::hash<CellCoord> {
+    size_t operator()(const CellCoord& c) const noexcept {
+        return std::hash<uint64_t>()((uint64_t(uint32_t(c.x)) << 32) | uint32_t(c.z));
+    }
+};
+
+// splits the world into square cells, each one its own scene file (see sceneFile.h).
+// cells around the camera decode on the job system (file, meshes, texture decode,
+// collision actors), the main thread only uploads and inserts a few per frame.
+// cells past unloadRadius are dropped, and past the memory budget the farthest
+// cells outside loadRadius go first and no new loads start. physics snapshots skip
+// streamed bodies, call unloadAll before Scene::clear
+class WorldStreamer {
+public:
+    float cellSize = 64.0f;
+    int loadRadius = 2;         // in cells, chebyshev distance around the camera's cell
+    int unloadRadius = 3;       // > loadRadius so cells on the border don't flicker in and out
+    size_t memoryBudget = size_t(512) * 1024 * 1024;
+    int maxConcurrentLoads = 2;
+    int maxInstantiatesPerFrame = 1;
+
+    WorldStreamer() = default;
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+    ~WorldStreamer() {
+        // background jobs write into the cells, wait for them before the cells go away
+        for (auto& [coord, cell] : cells) {
+            if (cell.job.valid()) cell.job.wait();
+        }
+    }
+
+    void addCell(CellCoord coord, const std::string& path) {
+        cells[coord].path = path;
+    }
+
+    // manifest is one cell per line: "x z path", paths relative to the manifest's folder
+    bool loadManifest(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            std::cout << "WorldStreamer: could not open manifest " << path << std::endl;
+            return false;
+        }
+
+        std::filesystem::path folder = std::filesystem::path(path).parent_path();
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') continue;
+
+            std::istringstream stream(line);
+            CellCoord coord;
+            std::string cellPath;
+            if (!(stream >> coord.x >> coord.z >> cellPath)) continue;
+            addCell(coord, (folder / cellPath).string());
+        }
+        return true;
+    }
+
+    CellCoord cellAt(const glm::vec3& position) const {
+        return { static_cast<int>(std::floor(position.x / cellSize)), static_cast<int>(std::floor(position.z / cellSize)) };
+    }
+
+    void update(Scene& scene, const glm::vec3& cameraPos) {
+        CellCoord center = cellAt(cameraPos);
+
+        finishLoads(scene, center);
+        unloadDistant(scene, center);
+        requestLoads(center);
+    }
+
+    void unloadAll(Scene& scene) {
+        for (auto& [coord, cell] : cells) {
+            if (cell.state == CellState::Loading) {
+                cell.job.get();
+                --activeLoads;
+            }
+            unload(scene, cell);
+        }
+    }
+
+    size_t getResidentBytes() const { return residentBytes; }
+    size_t getCellCount() const { return cells.size(); }
+
+    size_t getLoadedCellCount() const {
+        size_t count = 0;
+        for (const auto& [coord, cell] : cells) {
+            count += cell.state == CellState::Loaded;
+        }
+        return count;
+    }
+
+    size_t getPendingCellCount() const {
+        size_t count = 0;
+        for (const auto& [coord, cell] : cells) {
+            count += cell.state == CellState::Loading || cell.state == CellState::Decoded;
+        }
+        return count;
+    }
+
+private:
+    enum class CellState {
+        Unloaded,
+        Loading,    // decode job running
+        Decoded,    // waiting for the main thread
+        Loaded
+    };
+
+    struct Cell {
+        std::string path;
+        CellState state = CellState::Unloaded;
+        std::shared_ptr<SceneChunk> chunk;
+        std::future<void> job;
+        bool failed = false;    // missing or bad file, don't keep retrying
+    };
+
+    std::unordered_map<CellCoord, Cell> cells;
+    size_t residentBytes = 0;   // decoded + loaded cells
+    int activeLoads = 0;
+
+    static int distance(CellCoord a, CellCoord b) {
+        return std::max(std::abs(a.x - b.x), std::abs(a.z - b.z));
+    }
+
+    void finishLoads(Scene& scene, CellCoord center) {
+        using namespace std::chrono_literals;
+
+        // nearest decoded cells first, the rest wait for the next frames
+        std::vector<std::pair<int, Cell*>> ready;
+        for (auto& [coord, cell] : cells) {
+            if (cell.state == CellState::Loading && cell.job.wait_for(0s) == std::future_status::ready) {
+                cell.job.get();
+                --activeLoads;
+                if (cell.chunk->decoded) {
+                    cell.state = CellState::Decoded;
+                    residentBytes += cell.chunk->memoryBytes;
+                }
+                else {
+                    cell.state = CellState::Unloaded;
+                    cell.chunk.reset();
+                    cell.failed = true;
+                }
+            }
+            if (cell.state == CellState::Decoded) {
+                ready.push_back({ distance(coord, center), &cell });
+            }
+        }
+        std::sort(ready.begin(), ready.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        int instantiated = 0;
+        for (auto& [cellDistance, cell] : ready) {
+            if (cellDistance > unloadRadius) {
+                // camera moved on while it decoded
+                unload(scene, *cell);
+            }
+            else if (instantiated < maxInstantiatesPerFrame) {
+                SceneLoader::instantiate(scene, *cell->chunk);
+                cell->state = CellState::Loaded;
+                ++instantiated;
+            }
+        }
+    }
+
+    void unloadDistant(Scene& scene, CellCoord center) {
+        std::vector<std::pair<int, Cell*>> resident;
+        for (auto& [coord, cell] : cells) {
+            if (cell.state != CellState::Loaded && cell.state != CellState::Decoded) continue;
+
+            int cellDistance = distance(coord, center);
+            if (cellDistance > unloadRadius) {
+                unload(scene, cell);
+            }
+            else if (cellDistance > loadRadius) {
+                resident.push_back({ cellDistance, &cell });
+            }
+        }
+
+        // over budget: farthest cells in the keep ring go first
+        std::sort(resident.begin(), resident.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (auto& [cellDistance, cell] : resident) {
+            if (residentBytes <= memoryBudget) break;
+            unload(scene, *cell);
+        }
+    }
+
+    void requestLoads(CellCoord center) {
+        if (residentBytes > memoryBudget) return;
+
+        std::vector<std::pair<int, Cell*>> wanted;
+        for (auto& [coord, cell] : cells) {
+            if (cell.state != CellState::Unloaded || cell.failed) continue;
+            int cellDistance = distance(coord, center);
+            if (cellDistance <= loadRadius) {
+                wanted.push_back({ cellDistance, &cell });
+            }
+        }
+        std::sort(wanted.begin(), wanted.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        for (auto& [cellDistance, cell] : wanted) {
+            if (activeLoads >= maxConcurrentLoads) break;
+
+            auto chunk = std::make_shared<SceneChunk>();
+            chunk->streamed = true;
+            std::string path = cell->path;
+            cell->chunk = chunk;
+            cell->state = CellState::Loading;
+            cell->job = JobSystem::getInstance().submit([chunk, path]() {
+                SceneLoader::decode(path, *chunk);
+            });
+            ++activeLoads;
+        }
+    }
+
+    void unload(Scene& scene, Cell& cell) {
+        if (cell.chunk) {
+            if (cell.state == CellState::Decoded || cell.state == CellState::Loaded) {
+                residentBytes -= std::min(residentBytes, cell.chunk->memoryBytes);
+            }
+            SceneLoader::remove(scene, *cell.chunk);
+            cell.chunk.reset();
+        }
+        cell.state = CellState::Unloaded;
+    }
+};